@@ -5,7 +5,7 @@
 
 enum
 {
-	ANTIBOT_ABI_VERSION = 11,
+	ANTIBOT_ABI_VERSION = 12,
 
 	ANTIBOT_MSGFLAG_NONVITAL = 1,
 	ANTIBOT_MSGFLAG_FLUSH = 2,
@@ -44,6 +44,15 @@ struct CAntibotInputData
 	int m_PrevWeapon;
 };
 
+// Statistics over the inputs of the last second.
+struct CAntibotInputStatsData
+{
+	// hook, fire and jump presses
+	float m_aRate[3]; // per second
+	float m_aIntervalJitter[3]; // standard deviation of the ticks between presses
+	float m_AimSpeed; // mean change of the aim angle per tick, in radians
+};
+
 // Defined by the network protocol, unlikely to change.
 //enum
 //{
@@ -67,6 +76,7 @@ struct CAntibotCharacterData
 	int m_HookedPlayer;
 	int m_SpawnTick;
 	int m_WeaponChangeTick;
+	CAntibotInputStatsData m_InputStats;
 };
 
 struct CAntibotVersion
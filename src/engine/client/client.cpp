@@ -4134,7 +4134,7 @@ const char *CClient::DemoPlayer_Play(const char *pFilename, int StorageType)
 
 	// try to start playback
 	m_DemoPlayer.SetListener(this);
-	if(m_DemoPlayer.Load(Storage(), m_pConsole, pFilename, StorageType))
+	if(m_DemoPlayer.Load(Storage(), m_pConsole, pFilename, StorageType, Engine()))
 	{
 		DisconnectWithReason(m_DemoPlayer.ErrorMessage());
 		return m_DemoPlayer.ErrorMessage();
@@ -15,6 +15,7 @@
 #include <engine/friends.h>
 #include <engine/http.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/json.h>
 #include <engine/shared/masterserver.h>
 #include <engine/shared/network.h>
@@ -26,30 +27,341 @@
 #include <algorithm>
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
-class CSortWrap
+static void FoldSearchString(const char *pStr, std::string &Out)
 {
-	typedef bool (CServerBrowser::*SortFunc)(int, int) const;
-	SortFunc m_pfnSort;
-	CServerBrowser *m_pThis;
+	char aFolded[512];
+	str_utf8_tolower(pStr, aFolded, sizeof(aFolded));
+	Out = aFolded;
+}
 
+// Strings of a server that the filter searches, together with their casefolded
+// versions so that the search does not have to fold them for every comparison.
+// It is rebuilt when the server info changes and never modified, so a running
+// filter job can keep using it while the info is updated.
+class CServerSearchIndex
+{
 public:
-	CSortWrap(CServerBrowser *pServer, SortFunc Func) :
-		m_pfnSort(Func), m_pThis(pServer) {}
-	bool operator()(int a, int b) { return (g_Config.m_BrSortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
+	class CClient
+	{
+	public:
+		std::string m_Name;
+		std::string m_Clan;
+		std::string m_NameFolded;
+		std::string m_ClanFolded;
+		int m_Country;
+	};
+
+	std::string m_Name;
+	std::string m_Map;
+	std::string m_GameType;
+	std::string m_Address;
+	std::string m_NameFolded;
+	std::string m_MapFolded;
+	std::string m_GameTypeFolded;
+	std::vector<CClient> m_vClients;
+
+	CServerSearchIndex(const CServerInfo &Info) :
+		m_Name(Info.m_aName), m_Map(Info.m_aMap), m_GameType(Info.m_aGameType), m_Address(Info.m_aAddress)
+	{
+		FoldSearchString(Info.m_aName, m_NameFolded);
+		FoldSearchString(Info.m_aMap, m_MapFolded);
+		FoldSearchString(Info.m_aGameType, m_GameTypeFolded);
+
+		m_vClients.resize(std::clamp(Info.m_NumClients, 0, (int)MAX_CLIENTS));
+		for(size_t i = 0; i < m_vClients.size(); i++)
+		{
+			CClient &Client = m_vClients[i];
+			Client.m_Name = Info.m_aClients[i].m_aName;
+			Client.m_Clan = Info.m_aClients[i].m_aClan;
+			FoldSearchString(Info.m_aClients[i].m_aName, Client.m_NameFolded);
+			FoldSearchString(Info.m_aClients[i].m_aClan, Client.m_ClanFolded);
+			Client.m_Country = Info.m_aClients[i].m_Country;
+		}
+	}
 };
 
-static bool MatchesPart(const char *a, const char *b)
+class CSearchToken
 {
-	return str_utf8_find_nocase(a, b) != nullptr;
-}
+public:
+	std::string m_Str; // casefolded, or the quoted string for exact matches
+	bool m_Exact;
 
-static bool MatchesExactly(const char *a, const char *b)
+	bool Matches(const std::string &Str, const std::string &StrFolded) const
+	{
+		return m_Exact ? Str == m_Str : StrFolded.find(m_Str) != std::string::npos;
+	}
+};
+
+static std::vector<CSearchToken> ParseSearchTokens(const char *pStr)
 {
-	return str_comp(a, &b[1]) == 0;
+	std::vector<CSearchToken> vTokens;
+	char aToken[512];
+	char aTokenTrimmed[512];
+	while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aToken, sizeof(aToken))))
+	{
+		str_copy(aTokenTrimmed, str_utf8_skip_whitespaces(aToken));
+		str_utf8_trim_right(aTokenTrimmed);
+
+		if(aTokenTrimmed[0] == '\0')
+		{
+			continue;
+		}
+		CSearchToken Token;
+		const int TokenLen = str_length(aTokenTrimmed);
+		Token.m_Exact = aTokenTrimmed[0] == '"' && aTokenTrimmed[TokenLen - 1] == '"';
+		if(Token.m_Exact)
+			Token.m_Str.assign(aTokenTrimmed + 1, maximum(TokenLen - 2, 0));
+		else
+			FoldSearchString(aTokenTrimmed, Token.m_Str);
+		vTokens.push_back(Token);
+	}
+	return vTokens;
 }
 
+// Filters and sorts a copy of the server list. The server browser swaps in the
+// result when the job is done and the server list has not been reset meanwhile.
+class CServerBrowserFilterJob : public IJob
+{
+public:
+	class CServer
+	{
+	public:
+		std::shared_ptr<const CServerSearchIndex> m_pSearchIndex;
+		bool m_GotInfo;
+		bool m_CommunityFiltered;
+		bool m_RequiresLogin;
+		int m_Flags;
+		int m_NumFilteredPlayers;
+		int m_Players;
+		int m_MaxPlayers;
+		int m_Latency;
+		int m_HasRank;
+		int m_FriendState;
+		int m_FriendNum;
+		int m_QuickSearchHit = 0;
+	};
+
+	// input
+	const int m_Version;
+	std::vector<CServer> m_vServers;
+	bool m_FilterEmpty;
+	bool m_FilterFull;
+	bool m_FilterPw;
+	bool m_FilterGametypeStrict;
+	bool m_FilterUnfinishedMap;
+	bool m_FilterLogin;
+	bool m_FilterCountry;
+	int m_FilterCountryIndex;
+	bool m_FilterConnectingPlayers;
+	bool m_FilterFriends;
+	int m_Sort;
+	int m_SortOrder;
+	std::string m_FilterServerAddress;
+	std::string m_FilterGametype;
+	std::string m_FilterGametypeFolded;
+	bool m_QuickSearch;
+	std::vector<CSearchToken> m_vQuickSearchTokens;
+	std::vector<CSearchToken> m_vExcludeTokens;
+
+	// output, indices into the server list
+	std::vector<int> m_vSortedServers;
+	int m_NumSortedPlayers = 0;
+
+	CServerBrowserFilterJob(int Version, std::vector<int> &&vSortedServers) :
+		m_Version(Version), m_vSortedServers(std::move(vSortedServers))
+	{
+		Abortable(true);
+	}
+
+private:
+	typedef bool (CServerBrowserFilterJob::*SortFunc)(int, int) const;
+
+	class CSortWrap
+	{
+		SortFunc m_pfnSort;
+		const CServerBrowserFilterJob *m_pThis;
+
+	public:
+		CSortWrap(const CServerBrowserFilterJob *pJob, SortFunc Func) :
+			m_pfnSort(Func), m_pThis(pJob) {}
+		bool operator()(int a, int b) const { return (m_pThis->m_SortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
+	};
+
+	bool SortCompareName(int Index1, int Index2) const
+	{
+		const CServer &Server1 = m_vServers[Index1];
+		const CServer &Server2 = m_vServers[Index2];
+		//	make sure empty entries are listed last
+		if(Server1.m_GotInfo != Server2.m_GotInfo)
+			return Server1.m_GotInfo;
+		return str_comp(Server1.m_pSearchIndex->m_Name.c_str(), Server2.m_pSearchIndex->m_Name.c_str()) < 0;
+	}
+
+	bool SortCompareMap(int Index1, int Index2) const
+	{
+		return str_comp(m_vServers[Index1].m_pSearchIndex->m_Map.c_str(), m_vServers[Index2].m_pSearchIndex->m_Map.c_str()) < 0;
+	}
+
+	bool SortComparePing(int Index1, int Index2) const
+	{
+		return m_vServers[Index1].m_Latency < m_vServers[Index2].m_Latency;
+	}
+
+	bool SortCompareGametype(int Index1, int Index2) const
+	{
+		return str_comp(m_vServers[Index1].m_pSearchIndex->m_GameType.c_str(), m_vServers[Index2].m_pSearchIndex->m_GameType.c_str()) < 0;
+	}
+
+	bool SortCompareNumPlayers(int Index1, int Index2) const
+	{
+		return m_vServers[Index1].m_NumFilteredPlayers > m_vServers[Index2].m_NumFilteredPlayers;
+	}
+
+	bool SortCompareNumFriends(int Index1, int Index2) const
+	{
+		const CServer &Server1 = m_vServers[Index1];
+		const CServer &Server2 = m_vServers[Index2];
+
+		if(Server1.m_FriendNum == Server2.m_FriendNum)
+			return Server1.m_NumFilteredPlayers > Server2.m_NumFilteredPlayers;
+		else
+			return Server1.m_FriendNum > Server2.m_FriendNum;
+	}
+
+	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const
+	{
+		const CServer &Server1 = m_vServers[Index1];
+		const CServer &Server2 = m_vServers[Index2];
+
+		if(Server1.m_NumFilteredPlayers == Server2.m_NumFilteredPlayers)
+			return Server1.m_Latency > Server2.m_Latency;
+		else if(Server1.m_NumFilteredPlayers == 0 || Server2.m_NumFilteredPlayers == 0 || Server1.m_Latency / 100 == Server2.m_Latency / 100)
+			return Server1.m_NumFilteredPlayers < Server2.m_NumFilteredPlayers;
+		else
+			return Server1.m_Latency > Server2.m_Latency;
+	}
+
+	bool Filtered(CServer &Server) const
+	{
+		const CServerSearchIndex &Index = *Server.m_pSearchIndex;
+
+		if(m_FilterEmpty && Server.m_NumFilteredPlayers == 0)
+			return true;
+		else if(m_FilterFull && Server.m_Players == Server.m_MaxPlayers)
+			return true;
+		else if(m_FilterPw && Server.m_Flags & SERVER_FLAG_PASSWORD)
+			return true;
+		else if(!m_FilterServerAddress.empty() && !str_find_nocase(Index.m_Address.c_str(), m_FilterServerAddress.c_str()))
+			return true;
+		else if(m_FilterGametypeStrict && !m_FilterGametype.empty() && str_comp_nocase(Index.m_GameType.c_str(), m_FilterGametype.c_str()))
+			return true;
+		else if(!m_FilterGametypeStrict && !m_FilterGametype.empty() && Index.m_GameTypeFolded.find(m_FilterGametypeFolded) == std::string::npos)
+			return true;
+		else if(m_FilterUnfinishedMap && Server.m_HasRank == CServerInfo::RANK_RANKED)
+			return true;
+		else if(m_FilterLogin && Server.m_RequiresLogin)
+			return true;
+		else if(Server.m_CommunityFiltered)
+			return true;
+
+		// match against player country
+		if(m_FilterCountry && std::none_of(Index.m_vClients.begin(), Index.m_vClients.end(), [&](const CServerSearchIndex::CClient &Client) { return Client.m_Country == m_FilterCountryIndex; }))
+			return true;
+
+		if(m_QuickSearch)
+		{
+			Server.m_QuickSearchHit = 0;
+			for(const CSearchToken &Token : m_vQuickSearchTokens)
+			{
+				// match against server name
+				if(Token.Matches(Index.m_Name, Index.m_NameFolded))
+				{
+					Server.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+				}
+
+				// match against players
+				for(const CServerSearchIndex::CClient &Client : Index.m_vClients)
+				{
+					if(Token.Matches(Client.m_Name, Client.m_NameFolded) ||
+						Token.Matches(Client.m_Clan, Client.m_ClanFolded))
+					{
+						if(m_FilterConnectingPlayers &&
+							Client.m_Name == "(connecting)" &&
+							Client.m_Clan.empty())
+						{
+							continue;
+						}
+						Server.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+						break;
+					}
+				}
+
+				// match against map
+				if(Token.Matches(Index.m_Map, Index.m_MapFolded))
+				{
+					Server.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+				}
+			}
+
+			if(!Server.m_QuickSearchHit)
+				return true;
+		}
+
+		// match against server name, map and gametype
+		for(const CSearchToken &Token : m_vExcludeTokens)
+		{
+			if(Token.Matches(Index.m_Name, Index.m_NameFolded) ||
+				Token.Matches(Index.m_Map, Index.m_MapFolded) ||
+				Token.Matches(Index.m_GameType, Index.m_GameTypeFolded))
+			{
+				return true;
+			}
+		}
+
+		return m_FilterFriends && Server.m_FriendState == IFriends::FRIEND_NO;
+	}
+
+	void Run() override
+	{
+		m_vSortedServers.clear();
+		m_NumSortedPlayers = 0;
+		for(int i = 0; i < (int)m_vServers.size(); i++)
+		{
+			if(State() == IJob::STATE_ABORTED)
+				return;
+			if(!Filtered(m_vServers[i]))
+			{
+				m_NumSortedPlayers += m_vServers[i].m_NumFilteredPlayers;
+				m_vSortedServers.push_back(i);
+			}
+		}
+
+		if(State() == IJob::STATE_ABORTED)
+			return;
+
+		SortFunc pfnSort = nullptr;
+		if(m_SortOrder == 2 && (m_Sort == IServerBrowser::SORT_NUMPLAYERS || m_Sort == IServerBrowser::SORT_PING))
+			pfnSort = &CServerBrowserFilterJob::SortCompareNumPlayersAndPing;
+		else if(m_Sort == IServerBrowser::SORT_NAME)
+			pfnSort = &CServerBrowserFilterJob::SortCompareName;
+		else if(m_Sort == IServerBrowser::SORT_PING)
+			pfnSort = &CServerBrowserFilterJob::SortComparePing;
+		else if(m_Sort == IServerBrowser::SORT_MAP)
+			pfnSort = &CServerBrowserFilterJob::SortCompareMap;
+		else if(m_Sort == IServerBrowser::SORT_NUMFRIENDS)
+			pfnSort = &CServerBrowserFilterJob::SortCompareNumFriends;
+		else if(m_Sort == IServerBrowser::SORT_NUMPLAYERS)
+			pfnSort = &CServerBrowserFilterJob::SortCompareNumPlayers;
+		else if(m_Sort == IServerBrowser::SORT_GAMETYPE)
+			pfnSort = &CServerBrowserFilterJob::SortCompareGametype;
+		if(pfnSort)
+			std::stable_sort(m_vSortedServers.begin(), m_vSortedServers.end(), CSortWrap(this, pfnSort));
+	}
+};
+
 static NETADDR CommunityAddressKey(const NETADDR &Addr)
 {
 	NETADDR AddressKey = Addr;
@@ -63,12 +375,10 @@ CServerBrowser::CServerBrowser() :
 	m_TypesFilter(&m_CommunityCache)
 {
 	m_ppServerlist = nullptr;
-	m_pSortedServerlist = nullptr;
 
 	m_NeedResort = false;
 	m_Sorthash = 0;
 
-	m_NumSortedServersCapacity = 0;
 	m_NumServerCapacity = 0;
 
 	m_ServerlistType = 0;
@@ -80,8 +390,8 @@ CServerBrowser::CServerBrowser() :
 
 CServerBrowser::~CServerBrowser()
 {
+	AbortSort();
 	free(m_ppServerlist);
-	free(m_pSortedServerlist);
 	json_value_free(m_pDDNetInfo);
 
 	delete m_pHttp;
@@ -327,7 +637,7 @@ const CServerInfo *CServerBrowser::SortedGet(int Index) const
 {
 	if(Index < 0 || Index >= m_NumSortedServers)
 		return nullptr;
-	return &m_ppServerlist[m_pSortedServerlist[Index]]->m_Info;
+	return &m_ppServerlist[m_vSortedServerlist[Index]]->m_Info;
 }
 
 int CServerBrowser::GenerateToken(const NETADDR &Addr) const
@@ -350,301 +660,131 @@ int CServerBrowser::GetExtraToken(int Token)
 	return Token >> 8;
 }
 
-bool CServerBrowser::SortCompareName(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	//	make sure empty entries are listed last
-	return (pIndex1->m_GotInfo && pIndex2->m_GotInfo) || (!pIndex1->m_GotInfo && !pIndex2->m_GotInfo) ? str_comp(pIndex1->m_Info.m_aName, pIndex2->m_Info.m_aName) < 0 :
-													    pIndex1->m_GotInfo != 0;
-}
-
-bool CServerBrowser::SortCompareMap(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return str_comp(pIndex1->m_Info.m_aMap, pIndex2->m_Info.m_aMap) < 0;
-}
-
-bool CServerBrowser::SortComparePing(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_Latency < pIndex2->m_Info.m_Latency;
-}
-
-bool CServerBrowser::SortCompareGametype(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return str_comp(pIndex1->m_Info.m_aGameType, pIndex2->m_Info.m_aGameType) < 0;
-}
-
-bool CServerBrowser::SortCompareNumPlayers(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
-}
-
-bool CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_NumClients > pIndex2->m_Info.m_NumClients;
-}
-
-bool CServerBrowser::SortCompareNumFriends(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-
-	if(pIndex1->m_Info.m_FriendNum == pIndex2->m_Info.m_FriendNum)
-		return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
-	else
-		return pIndex1->m_Info.m_FriendNum > pIndex2->m_Info.m_FriendNum;
-}
-
-bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
+int CServerBrowser::SortHash() const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-
-	if(pIndex1->m_Info.m_NumFilteredPlayers == pIndex2->m_Info.m_NumFilteredPlayers)
-		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
-	else if(pIndex1->m_Info.m_NumFilteredPlayers == 0 || pIndex2->m_Info.m_NumFilteredPlayers == 0 || pIndex1->m_Info.m_Latency / 100 == pIndex2->m_Info.m_Latency / 100)
-		return pIndex1->m_Info.m_NumFilteredPlayers < pIndex2->m_Info.m_NumFilteredPlayers;
-	else
-		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
+	int i = g_Config.m_BrSort & 0xff;
+	i |= g_Config.m_BrFilterEmpty << 4;
+	i |= g_Config.m_BrFilterFull << 5;
+	i |= g_Config.m_BrFilterSpectators << 6;
+	i |= g_Config.m_BrFilterFriends << 7;
+	i |= g_Config.m_BrFilterPw << 8;
+	i |= g_Config.m_BrSortOrder << 9;
+	i |= g_Config.m_BrFilterGametypeStrict << 12;
+	i |= g_Config.m_BrFilterUnfinishedMap << 13;
+	i |= g_Config.m_BrFilterCountry << 14;
+	i |= g_Config.m_BrFilterConnectingPlayers << 15;
+	i |= g_Config.m_BrFilterLogin << 16;
+	return i;
 }
 
-void CServerBrowser::Filter()
+void CServerBrowser::Sort()
 {
-	m_NumSortedServers = 0;
-	m_NumSortedPlayers = 0;
+	AbortSort();
 
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
+	// the job works on a copy of everything it needs, so the
+	// server list can be updated while it is running
+	std::shared_ptr<CServerBrowserFilterJob> pJob = std::make_shared<CServerBrowserFilterJob>(m_ServerlistVersion, std::move(m_vSortedServerlistSpare));
+	pJob->m_vServers.resize(m_NumServers);
+	if(UpdateFriendsSnapshot())
 	{
-		free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
+		for(int i = 0; i < m_NumServers; i++)
+			UpdateServerFriends(&m_ppServerlist[i]->m_Info);
 	}
-
-	// filter the servers
 	for(int i = 0; i < m_NumServers; i++)
 	{
 		CServerInfo &Info = m_ppServerlist[i]->m_Info;
-		bool Filtered = false;
-
-		if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
-			Filtered = true;
-		else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
-			Filtered = true;
-		else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
-			Filtered = true;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = true;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
-			Filtered = true;
-		else if(g_Config.m_BrFilterLogin && Info.m_RequiresLogin)
-			Filtered = true;
-		else
-		{
-			if(!Communities().empty())
-			{
-				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
-				{
-					Filtered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
-				}
-				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
-					(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
-				{
-					Filtered = Filtered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
-					Filtered = Filtered || TypesFilter().Filtered(Info.m_aCommunityType);
-				}
-			}
-
-			if(!Filtered && g_Config.m_BrFilterCountry)
-			{
-				Filtered = true;
-				// match against player country
-				for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
-				{
-					if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = false;
-						break;
-					}
-				}
-			}
+		UpdateServerFilteredPlayers(&Info);
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+		bool CommunityFiltered = false;
+		if(!Communities().empty())
+		{
+			if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
 			{
-				Info.m_QuickSearchHit = 0;
-
-				const char *pStr = g_Config.m_BrFilterString;
-				char aFilterStr[sizeof(g_Config.m_BrFilterString)];
-				char aFilterStrTrimmed[sizeof(g_Config.m_BrFilterString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
-				{
-					str_copy(aFilterStrTrimmed, str_utf8_skip_whitespaces(aFilterStr));
-					str_utf8_trim_right(aFilterStrTrimmed);
-
-					if(aFilterStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = MatchesPart;
-					const int FilterLen = str_length(aFilterStrTrimmed);
-					if(aFilterStrTrimmed[0] == '"' && aFilterStrTrimmed[FilterLen - 1] == '"')
-					{
-						aFilterStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = MatchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(Info.m_aName, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-					}
-
-					// match against players
-					for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
-					{
-						if(MatchesFn(Info.m_aClients[p].m_aName, aFilterStrTrimmed) ||
-							MatchesFn(Info.m_aClients[p].m_aClan, aFilterStrTrimmed))
-						{
-							if(g_Config.m_BrFilterConnectingPlayers &&
-								str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
-								Info.m_aClients[p].m_aClan[0] == '\0')
-							{
-								continue;
-							}
-							Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-							break;
-						}
-					}
-
-					// match against map
-					if(MatchesFn(Info.m_aMap, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
-					}
-				}
-
-				if(!Info.m_QuickSearchHit)
-					Filtered = true;
+				CommunityFiltered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
 			}
-
-			if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
+			if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
+				(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
 			{
-				const char *pStr = g_Config.m_BrExcludeString;
-				char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
-				char aExcludeStrTrimmed[sizeof(g_Config.m_BrExcludeString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
-				{
-					str_copy(aExcludeStrTrimmed, str_utf8_skip_whitespaces(aExcludeStr));
-					str_utf8_trim_right(aExcludeStrTrimmed);
-
-					if(aExcludeStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = MatchesPart;
-					const int FilterLen = str_length(aExcludeStrTrimmed);
-					if(aExcludeStrTrimmed[0] == '"' && aExcludeStrTrimmed[FilterLen - 1] == '"')
-					{
-						aExcludeStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = MatchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(Info.m_aName, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-
-					// match against map
-					if(MatchesFn(Info.m_aMap, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-
-					// match against gametype
-					if(MatchesFn(Info.m_aGameType, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-				}
+				CommunityFiltered = CommunityFiltered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
+				CommunityFiltered = CommunityFiltered || TypesFilter().Filtered(Info.m_aCommunityType);
 			}
 		}
 
-		if(!Filtered)
-		{
-			UpdateServerFriends(&Info);
-
-			if(!g_Config.m_BrFilterFriends || Info.m_FriendState != IFriends::FRIEND_NO)
-			{
-				m_NumSortedPlayers += Info.m_NumFilteredPlayers;
-				m_pSortedServerlist[m_NumSortedServers++] = i;
-			}
-		}
-	}
+		CServerBrowserFilterJob::CServer &Server = pJob->m_vServers[i];
+		Server.m_pSearchIndex = SearchIndex(i);
+		Server.m_GotInfo = m_ppServerlist[i]->m_GotInfo != 0;
+		Server.m_CommunityFiltered = CommunityFiltered;
+		Server.m_RequiresLogin = Info.m_RequiresLogin;
+		Server.m_Flags = Info.m_Flags;
+		Server.m_NumFilteredPlayers = Info.m_NumFilteredPlayers;
+		Server.m_Players = Players(Info);
+		Server.m_MaxPlayers = Max(Info);
+		Server.m_Latency = Info.m_Latency;
+		Server.m_HasRank = Info.m_HasRank;
+		Server.m_FriendState = Info.m_FriendState;
+		Server.m_FriendNum = Info.m_FriendNum;
+	}
+
+	pJob->m_FilterEmpty = g_Config.m_BrFilterEmpty;
+	pJob->m_FilterFull = g_Config.m_BrFilterFull;
+	pJob->m_FilterPw = g_Config.m_BrFilterPw;
+	pJob->m_FilterGametypeStrict = g_Config.m_BrFilterGametypeStrict;
+	pJob->m_FilterUnfinishedMap = g_Config.m_BrFilterUnfinishedMap;
+	pJob->m_FilterLogin = g_Config.m_BrFilterLogin;
+	pJob->m_FilterCountry = g_Config.m_BrFilterCountry;
+	pJob->m_FilterCountryIndex = g_Config.m_BrFilterCountryIndex;
+	pJob->m_FilterConnectingPlayers = g_Config.m_BrFilterConnectingPlayers;
+	pJob->m_FilterFriends = g_Config.m_BrFilterFriends;
+	pJob->m_Sort = g_Config.m_BrSort;
+	pJob->m_SortOrder = g_Config.m_BrSortOrder;
+	pJob->m_FilterServerAddress = g_Config.m_BrFilterServerAddress;
+	pJob->m_FilterGametype = g_Config.m_BrFilterGametype;
+	FoldSearchString(g_Config.m_BrFilterGametype, pJob->m_FilterGametypeFolded);
+	pJob->m_QuickSearch = g_Config.m_BrFilterString[0] != '\0';
+	pJob->m_vQuickSearchTokens = ParseSearchTokens(g_Config.m_BrFilterString);
+	pJob->m_vExcludeTokens = ParseSearchTokens(g_Config.m_BrExcludeString);
+
+	m_pFilterJob = pJob;
+	m_pEngine->AddJob(pJob);
+	m_Sorthash = SortHash();
 }
 
-int CServerBrowser::SortHash() const
+void CServerBrowser::FinishSort()
 {
-	int i = g_Config.m_BrSort & 0xff;
-	i |= g_Config.m_BrFilterEmpty << 4;
-	i |= g_Config.m_BrFilterFull << 5;
-	i |= g_Config.m_BrFilterSpectators << 6;
-	i |= g_Config.m_BrFilterFriends << 7;
-	i |= g_Config.m_BrFilterPw << 8;
-	i |= g_Config.m_BrSortOrder << 9;
-	i |= g_Config.m_BrFilterGametypeStrict << 12;
-	i |= g_Config.m_BrFilterUnfinishedMap << 13;
-	i |= g_Config.m_BrFilterCountry << 14;
-	i |= g_Config.m_BrFilterConnectingPlayers << 15;
-	i |= g_Config.m_BrFilterLogin << 16;
-	return i;
+	if(!m_pFilterJob || m_pFilterJob->State() != IJob::STATE_DONE)
+		return;
+
+	std::shared_ptr<CServerBrowserFilterJob> pJob = std::move(m_pFilterJob);
+	m_pFilterJob = nullptr;
+	if(pJob->m_Version != m_ServerlistVersion)
+		return;
+
+	// swap the buffers, the old list is reused by the next job
+	std::swap(m_vSortedServerlist, pJob->m_vSortedServers);
+	m_vSortedServerlistSpare = std::move(pJob->m_vSortedServers);
+	m_NumSortedServers = m_vSortedServerlist.size();
+	m_NumSortedPlayers = pJob->m_NumSortedPlayers;
+	for(int Index : m_vSortedServerlist)
+	{
+		m_ppServerlist[Index]->m_Info.m_QuickSearchHit = pJob->m_vServers[Index].m_QuickSearchHit;
+	}
 }
 
-void CServerBrowser::Sort()
+void CServerBrowser::AbortSort()
 {
-	// update number of filtered players
-	for(int i = 0; i < m_NumServers; i++)
+	if(m_pFilterJob)
 	{
-		UpdateServerFilteredPlayers(&m_ppServerlist[i]->m_Info);
+		m_pFilterJob->Abort();
+		m_pFilterJob = nullptr;
 	}
+}
 
-	// create filtered list
-	Filter();
-
-	// sort
-	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayersAndPing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareName));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortComparePing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareMap));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMFRIENDS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumFriends));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayers));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareGametype));
-
-	m_Sorthash = SortHash();
+const std::shared_ptr<const CServerSearchIndex> &CServerBrowser::SearchIndex(int Index)
+{
+	std::shared_ptr<const CServerSearchIndex> &pSearchIndex = m_vpSearchIndex[Index];
+	if(!pSearchIndex)
+		pSearchIndex = std::make_shared<const CServerSearchIndex>(m_ppServerlist[Index]->m_Info);
+	return pSearchIndex;
 }
 
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
@@ -709,7 +849,7 @@ static void ServerBrowserFormatAddresses(char *pBuffer, int BufferSize, NETADDR
 	}
 }
 
-void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const
+void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 {
 	const CServerInfo TmpInfo = pEntry->m_Info;
 	pEntry->m_Info = Info;
@@ -781,7 +921,10 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) cons
 
 	std::sort(pEntry->m_Info.m_aClients, pEntry->m_Info.m_aClients + Info.m_NumReceivedClients, CPlayerScoreNameLess(pEntry->m_Info.m_ClientScoreKind));
 
+	UpdateServerFriends(&pEntry->m_Info);
+
 	pEntry->m_GotInfo = 1;
+	m_vpSearchIndex[pEntry->m_Info.m_ServerIndex] = nullptr;
 }
 
 void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
@@ -858,6 +1001,7 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR *pAddrs, int Num
 
 	// add to list
 	m_ppServerlist[m_NumServers] = pEntry;
+	m_vpSearchIndex.emplace_back();
 	pEntry->m_Info.m_ServerIndex = m_NumServers;
 	m_NumServers++;
 
@@ -888,6 +1032,7 @@ CServerBrowser::CServerEntry *CServerBrowser::ReplaceEntry(CServerEntry *pEntry,
 	{
 		m_ByAddr[pAddrs[i]] = pEntry->m_Info.m_ServerIndex;
 	}
+	m_vpSearchIndex[pEntry->m_Info.m_ServerIndex] = nullptr;
 
 	return pEntry;
 }
@@ -1198,11 +1343,15 @@ void CServerBrowser::UpdateFromHttp()
 
 	for(int i = 0; i < NumServers; i++)
 	{
-		CServerInfo Info = m_pHttp->Server(i);
-		if(!Want(Info.m_aAddresses, Info.m_NumAddresses))
+		const NETADDR *pAddresses;
+		int NumAddresses;
+		m_pHttp->ServerAddresses(i, &pAddresses, &NumAddresses);
+		if(!Want(pAddresses, NumAddresses))
 		{
 			continue;
 		}
+		CServerInfo Info;
+		m_pHttp->Server(i, &Info);
 		int Ping = m_pPingCache->GetPing(Info.m_aAddresses, Info.m_NumAddresses);
 		Info.m_LatencyIsEstimated = Ping == -1;
 		if(Info.m_LatencyIsEstimated)
@@ -1253,8 +1402,12 @@ void CServerBrowser::UpdateFromHttp()
 void CServerBrowser::CleanUp()
 {
 	// clear out everything
+	AbortSort();
+	m_ServerlistVersion++;
 	m_ServerlistHeap.Reset();
 	m_NumServers = 0;
+	m_vSortedServerlist.clear();
+	m_vpSearchIndex.clear();
 	m_NumSortedServers = 0;
 	m_NumSortedPlayers = 0;
 	m_ByAddr.clear();
@@ -1342,8 +1495,11 @@ void CServerBrowser::Update()
 		}
 	}
 
-	// check if we need to resort
-	if(m_Sorthash != SortHash() || m_NeedResort)
+	FinishSort();
+
+	// check if we need to resort, changes during a running sort
+	// are picked up by the next one
+	if(!m_pFilterJob && (m_Sorthash != SortHash() || m_NeedResort))
 	{
 		for(int i = 0; i < m_NumServers; i++)
 		{
@@ -1651,6 +1807,26 @@ void CServerBrowser::UpdateServerFriends(CServerInfo *pInfo) const
 	}
 }
 
+bool CServerBrowser::UpdateFriendsSnapshot()
+{
+	bool Changed = m_FriendsIgnoreClan != (bool)g_Config.m_ClFriendsIgnoreClan || (int)m_vFriendsSnapshot.size() != m_pFriends->NumFriends();
+	for(int i = 0; !Changed && i < m_pFriends->NumFriends(); i++)
+	{
+		const CFriendInfo &Friend = *m_pFriends->GetFriend(i);
+		const CFriendInfo &Snapshot = m_vFriendsSnapshot[i];
+		Changed = Friend.m_NameHash != Snapshot.m_NameHash || Friend.m_ClanHash != Snapshot.m_ClanHash ||
+			  str_comp(Friend.m_aName, Snapshot.m_aName) != 0 || str_comp(Friend.m_aClan, Snapshot.m_aClan) != 0;
+	}
+	if(!Changed)
+		return false;
+
+	m_FriendsIgnoreClan = g_Config.m_ClFriendsIgnoreClan;
+	m_vFriendsSnapshot.resize(m_pFriends->NumFriends());
+	for(int i = 0; i < m_pFriends->NumFriends(); i++)
+		m_vFriendsSnapshot[i] = *m_pFriends->GetFriend(i);
+	return true;
+}
+
 void CServerBrowser::UpdateServerCommunity(CServerInfo *pInfo) const
 {
 	for(int AddressIndex = 0; AddressIndex < pInfo->m_NumAddresses; AddressIndex++)
@@ -2378,10 +2554,12 @@ bool CServerBrowser::IsRegistered(const NETADDR &Addr)
 	const int NumServers = m_pHttp->NumServers();
 	for(int i = 0; i < NumServers; i++)
 	{
-		const CServerInfo &Info = m_pHttp->Server(i);
-		for(int j = 0; j < Info.m_NumAddresses; j++)
+		const NETADDR *pAddresses;
+		int NumAddresses;
+		m_pHttp->ServerAddresses(i, &pAddresses, &NumAddresses);
+		for(int j = 0; j < NumAddresses; j++)
 		{
-			if(net_addr_comp(&Info.m_aAddresses[j], &Addr) == 0)
+			if(net_addr_comp(&pAddresses[j], &Addr) == 0)
 			{
 				return true;
 			}
@@ -7,12 +7,15 @@
 #include <base/system.h>
 
 #include <engine/console.h>
+#include <engine/friends.h>
 #include <engine/serverbrowser.h>
 #include <engine/shared/memheap.h>
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 typedef struct _json_value json_value;
 class CNetClient;
@@ -25,6 +28,8 @@ class IServerBrowserHttp;
 class IServerBrowserPingCache;
 class IStorage;
 class IHttp;
+class CServerBrowserFilterJob;
+class CServerSearchIndex;
 
 class CCommunityId
 {
@@ -273,6 +278,7 @@ public:
 	void LoadDDNetServers();
 	void UpdateServerFilteredPlayers(CServerInfo *pInfo) const;
 	void UpdateServerFriends(CServerInfo *pInfo) const;
+	bool UpdateFriendsSnapshot();
 	void UpdateServerCommunity(CServerInfo *pInfo) const;
 	void UpdateServerRank(CServerInfo *pInfo) const;
 	void ValidateServerlistType();
@@ -334,7 +340,14 @@ private:
 
 	CHeap m_ServerlistHeap;
 	CServerEntry **m_ppServerlist;
-	int *m_pSortedServerlist;
+	std::vector<int> m_vSortedServerlist;
+	std::vector<int> m_vSortedServerlistSpare;
+	std::vector<std::shared_ptr<const CServerSearchIndex>> m_vpSearchIndex;
+	std::shared_ptr<CServerBrowserFilterJob> m_pFilterJob;
+	// Friend states are updated when the players of a server or this list change
+	std::vector<CFriendInfo> m_vFriendsSnapshot;
+	bool m_FriendsIgnoreClan = false;
+	int m_ServerlistVersion = 0;
 	std::unordered_map<NETADDR, int> m_ByAddr;
 
 	std::vector<CCommunity> m_vCommunities;
@@ -362,7 +375,6 @@ private:
 	int m_CurrentMaxRequests;
 
 	int m_NumSortedServers;
-	int m_NumSortedServersCapacity;
 	int m_NumSortedPlayers;
 	int m_NumServers;
 	int m_NumServerCapacity;
@@ -375,20 +387,13 @@ private:
 	static int GetBasicToken(int Token);
 	static int GetExtraToken(int Token);
 
-	// sorting criteria
-	bool SortCompareName(int Index1, int Index2) const;
-	bool SortCompareMap(int Index1, int Index2) const;
-	bool SortComparePing(int Index1, int Index2) const;
-	bool SortCompareGametype(int Index1, int Index2) const;
-	bool SortCompareNumPlayers(int Index1, int Index2) const;
-	bool SortCompareNumClients(int Index1, int Index2) const;
-	bool SortCompareNumFriends(int Index1, int Index2) const;
-	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const;
-
-	//
-	void Filter();
+	// filtering and sorting happens in a job, the results are
+	// swapped in by Update when it is done
 	void Sort();
+	void FinishSort();
+	void AbortSort();
 	int SortHash() const;
+	const std::shared_ptr<const CServerSearchIndex> &SearchIndex(int Index);
 
 	void CleanUp();
 
@@ -416,7 +421,7 @@ private:
 	bool ValidateCountryName(const char *pCountryName) const;
 	bool ValidateTypeName(const char *pTypeName) const;
 
-	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const;
+	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info);
 	void SetLatency(NETADDR Addr, int Latency);
 
 	static bool ParseCommunityFinishes(CCommunity *pCommunity, const json_value &Finishes);
@@ -16,6 +16,8 @@
 
 #include <chrono>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace std::chrono_literals;
@@ -300,6 +302,179 @@ void CChooseMaster::CJob::Run()
 	m_pData->m_BestIndex.store(BestIndex);
 }
 
+// Server list as received from the master, without the fixed size client
+// arrays of CServerInfo. Clients of all servers are stored in one array and
+// strings are only stored once, so names of maps, game types and clans that
+// are used on many servers don't take extra space.
+class CServerTable
+{
+public:
+	class CClient
+	{
+	public:
+		int m_Name;
+		int m_Clan;
+		int m_Country;
+		int m_Score;
+		bool m_IsPlayer;
+		bool m_IsAfk;
+		// skin info 0.6
+		int m_Skin;
+		bool m_CustomSkinColors;
+		int m_CustomSkinColorBody;
+		int m_CustomSkinColorFeet;
+		// skin info 0.7
+		int m_aSkin7[protocol7::NUM_SKINPARTS];
+		bool m_aUseCustomSkinColor7[protocol7::NUM_SKINPARTS];
+		int m_aCustomSkinColor7[protocol7::NUM_SKINPARTS];
+	};
+
+	class CServer
+	{
+	public:
+		int m_Name;
+		int m_GameType;
+		int m_Map;
+		int m_Version;
+		int m_MaxClients;
+		int m_NumClients;
+		int m_MaxPlayers;
+		int m_NumPlayers;
+		CServerInfo::EClientScoreKind m_ClientScoreKind;
+		bool m_Passworded;
+		bool m_RequiresLogin;
+		int m_Location;
+		int m_FirstClient;
+		int m_NumReceivedClients;
+		int m_FirstAddress;
+		int m_NumAddresses;
+	};
+
+	std::vector<CServer> m_vServers;
+	std::vector<CClient> m_vClients;
+	std::vector<NETADDR> m_vAddresses;
+	std::vector<char> m_vStrings;
+
+	const char *String(int Offset) const { return &m_vStrings[Offset]; }
+	void ToServerInfo(int Index, CServerInfo *pOut) const;
+};
+
+class CServerTableBuilder
+{
+	CServerTable *m_pTable;
+	std::unordered_map<std::string, int> m_StringOffsets;
+
+public:
+	CServerTableBuilder(CServerTable *pTable) :
+		m_pTable(pTable)
+	{
+		*m_pTable = CServerTable();
+		AddString("");
+	}
+
+	int AddString(const char *pStr)
+	{
+		auto [It, Inserted] = m_StringOffsets.emplace(pStr, m_pTable->m_vStrings.size());
+		if(Inserted)
+			m_pTable->m_vStrings.insert(m_pTable->m_vStrings.end(), pStr, pStr + str_length(pStr) + 1);
+		return It->second;
+	}
+
+	void AddServer(const CServerInfo2 &Info, int Location, const NETADDR *pAddresses, int NumAddresses)
+	{
+		CServerTable::CServer Server;
+		Server.m_Name = AddString(Info.m_aName);
+		Server.m_GameType = AddString(Info.m_aGameType);
+		Server.m_Map = AddString(Info.m_aMapName);
+		Server.m_Version = AddString(Info.m_aVersion);
+		Server.m_MaxClients = Info.m_MaxClients;
+		Server.m_NumClients = Info.m_NumClients;
+		Server.m_MaxPlayers = Info.m_MaxPlayers;
+		Server.m_NumPlayers = Info.m_NumPlayers;
+		Server.m_ClientScoreKind = Info.m_ClientScoreKind;
+		Server.m_Passworded = Info.m_Passworded;
+		Server.m_RequiresLogin = Info.m_RequiresLogin;
+		Server.m_Location = Location;
+		Server.m_FirstClient = m_pTable->m_vClients.size();
+		Server.m_NumReceivedClients = minimum(Info.m_NumClients, (int)SERVERINFO_MAX_CLIENTS);
+		Server.m_FirstAddress = m_pTable->m_vAddresses.size();
+		Server.m_NumAddresses = NumAddresses;
+
+		for(int i = 0; i < Server.m_NumReceivedClients; i++)
+		{
+			const CServerInfo2::CClient &InfoClient = Info.m_aClients[i];
+			CServerTable::CClient Client;
+			Client.m_Name = AddString(InfoClient.m_aName);
+			Client.m_Clan = AddString(InfoClient.m_aClan);
+			Client.m_Country = InfoClient.m_Country;
+			Client.m_Score = InfoClient.m_Score;
+			Client.m_IsPlayer = InfoClient.m_IsPlayer;
+			Client.m_IsAfk = InfoClient.m_IsAfk;
+			Client.m_Skin = AddString(InfoClient.m_aSkin);
+			Client.m_CustomSkinColors = InfoClient.m_CustomSkinColors;
+			Client.m_CustomSkinColorBody = InfoClient.m_CustomSkinColorBody;
+			Client.m_CustomSkinColorFeet = InfoClient.m_CustomSkinColorFeet;
+			for(int Part = 0; Part < protocol7::NUM_SKINPARTS; Part++)
+			{
+				Client.m_aSkin7[Part] = AddString(InfoClient.m_aaSkin7[Part]);
+				Client.m_aUseCustomSkinColor7[Part] = InfoClient.m_aUseCustomSkinColor7[Part];
+				Client.m_aCustomSkinColor7[Part] = InfoClient.m_aCustomSkinColor7[Part];
+			}
+			m_pTable->m_vClients.push_back(Client);
+		}
+		m_pTable->m_vAddresses.insert(m_pTable->m_vAddresses.end(), pAddresses, pAddresses + NumAddresses);
+		m_pTable->m_vServers.push_back(Server);
+	}
+};
+
+void CServerTable::ToServerInfo(int Index, CServerInfo *pOut) const
+{
+	const CServer &Server = m_vServers[Index];
+	mem_zero(pOut, sizeof(*pOut));
+	pOut->m_MaxClients = Server.m_MaxClients;
+	pOut->m_NumClients = Server.m_NumClients;
+	pOut->m_MaxPlayers = Server.m_MaxPlayers;
+	pOut->m_NumPlayers = Server.m_NumPlayers;
+	pOut->m_ClientScoreKind = Server.m_ClientScoreKind;
+	pOut->m_RequiresLogin = Server.m_RequiresLogin;
+	pOut->m_Flags = Server.m_Passworded ? SERVER_FLAG_PASSWORD : 0;
+	str_copy(pOut->m_aGameType, String(Server.m_GameType));
+	str_copy(pOut->m_aName, String(Server.m_Name));
+	str_copy(pOut->m_aMap, String(Server.m_Map));
+	str_copy(pOut->m_aVersion, String(Server.m_Version));
+
+	for(int i = 0; i < Server.m_NumReceivedClients; i++)
+	{
+		const CClient &Client = m_vClients[Server.m_FirstClient + i];
+		CServerInfo::CClient &OutClient = pOut->m_aClients[i];
+		str_copy(OutClient.m_aName, String(Client.m_Name));
+		str_copy(OutClient.m_aClan, String(Client.m_Clan));
+		OutClient.m_Country = Client.m_Country;
+		OutClient.m_Score = Client.m_Score;
+		OutClient.m_Player = Client.m_IsPlayer;
+		OutClient.m_Afk = Client.m_IsAfk;
+
+		// 0.6 skin
+		str_copy(OutClient.m_aSkin, String(Client.m_Skin));
+		OutClient.m_CustomSkinColors = Client.m_CustomSkinColors;
+		OutClient.m_CustomSkinColorBody = Client.m_CustomSkinColorBody;
+		OutClient.m_CustomSkinColorFeet = Client.m_CustomSkinColorFeet;
+		// 0.7 skin
+		for(int Part = 0; Part < protocol7::NUM_SKINPARTS; Part++)
+		{
+			str_copy(OutClient.m_aaSkin7[Part], String(Client.m_aSkin7[Part]));
+			OutClient.m_aUseCustomSkinColor7[Part] = Client.m_aUseCustomSkinColor7[Part];
+			OutClient.m_aCustomSkinColor7[Part] = Client.m_aCustomSkinColor7[Part];
+		}
+	}
+
+	pOut->m_NumReceivedClients = Server.m_NumReceivedClients;
+	pOut->m_Latency = -1;
+	pOut->m_Location = Server.m_Location;
+	pOut->m_NumAddresses = Server.m_NumAddresses;
+	mem_copy(pOut->m_aAddresses, &m_vAddresses[Server.m_FirstAddress], Server.m_NumAddresses * sizeof(NETADDR));
+}
+
 class CServerBrowserHttp : public IServerBrowserHttp
 {
 public:
@@ -313,11 +488,17 @@ public:
 
 	int NumServers() const override
 	{
-		return m_vServers.size();
+		return m_Servers.m_vServers.size();
+	}
+	void Server(int Index, CServerInfo *pOut) const override
+	{
+		m_Servers.ToServerInfo(Index, pOut);
 	}
-	const CServerInfo &Server(int Index) const override
+	void ServerAddresses(int Index, const NETADDR **ppAddresses, int *pNumAddresses) const override
 	{
-		return m_vServers[Index];
+		const CServerTable::CServer &Server = m_Servers.m_vServers[Index];
+		*ppAddresses = &m_Servers.m_vAddresses[Server.m_FirstAddress];
+		*pNumAddresses = Server.m_NumAddresses;
 	}
 
 private:
@@ -326,22 +507,42 @@ private:
 		STATE_DONE,
 		STATE_WANTREFRESH,
 		STATE_REFRESHING,
+		STATE_PARSING,
 		STATE_NO_MASTER,
 	};
 
+	// Parses the server list on a worker thread
+	class CParseJob : public IJob
+	{
+		void Run() override;
+
+	public:
+		std::shared_ptr<CHttpRequest> m_pGetServers;
+		bool m_Success = false;
+		CServerTable m_Servers;
+
+		CParseJob(std::shared_ptr<CHttpRequest> pGetServers) :
+			m_pGetServers(std::move(pGetServers))
+		{
+		}
+	};
+
 	static bool Validate(json_value *pJson);
-	static bool Parse(json_value *pJson, std::vector<CServerInfo> *pvServers);
+	static bool Parse(json_value *pJson, CServerTable *pServers);
 
+	IEngine *m_pEngine;
 	IHttp *m_pHttp;
 
 	int m_State = STATE_WANTREFRESH;
 	std::shared_ptr<CHttpRequest> m_pGetServers;
+	std::shared_ptr<CParseJob> m_pParseJob;
 	std::unique_ptr<CChooseMaster> m_pChooseMaster;
 
-	std::vector<CServerInfo> m_vServers;
+	CServerTable m_Servers;
 };
 
 CServerBrowserHttp::CServerBrowserHttp(IEngine *pEngine, IHttp *pHttp, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
+	m_pEngine(pEngine),
 	m_pHttp(pHttp),
 	m_pChooseMaster(new CChooseMaster(pEngine, pHttp, Validate, ppUrls, NumUrls, PreviousBestIndex))
 {
@@ -356,6 +557,13 @@ CServerBrowserHttp::~CServerBrowserHttp()
 	}
 }
 
+void CServerBrowserHttp::CParseJob::Run()
+{
+	json_value *pJson = m_pGetServers->State() == EHttpState::DONE ? m_pGetServers->ResultJson() : nullptr;
+	m_Success = pJson && !Parse(pJson, &m_Servers);
+	json_value_free(pJson);
+}
+
 void CServerBrowserHttp::Update()
 {
 	if(m_State == STATE_WANTREFRESH)
@@ -382,15 +590,28 @@ void CServerBrowserHttp::Update()
 		{
 			return;
 		}
-		m_State = STATE_DONE;
+		m_State = STATE_PARSING;
 		std::shared_ptr<CHttpRequest> pGetServers = nullptr;
 		std::swap(m_pGetServers, pGetServers);
+		m_pParseJob = std::make_shared<CParseJob>(std::move(pGetServers));
+		m_pEngine->AddJob(m_pParseJob);
+	}
+	else if(m_State == STATE_PARSING)
+	{
+		if(!m_pParseJob->Done())
+		{
+			return;
+		}
+		m_State = STATE_DONE;
+		std::shared_ptr<CParseJob> pParseJob = nullptr;
+		std::swap(m_pParseJob, pParseJob);
+		std::shared_ptr<CHttpRequest> &pGetServers = pParseJob->m_pGetServers;
 
-		bool Success = true;
-		json_value *pJson = pGetServers->State() == EHttpState::DONE ? pGetServers->ResultJson() : nullptr;
-		Success = Success && pJson;
-		Success = Success && !Parse(pJson, &m_vServers);
-		json_value_free(pJson);
+		const bool Success = pParseJob->m_Success;
+		if(Success)
+		{
+			m_Servers = std::move(pParseJob->m_Servers);
+		}
 		if(!Success)
 		{
 			log_error("serverbrowser_http", "failed getting serverlist, trying to find best URL");
@@ -412,7 +633,7 @@ void CServerBrowserHttp::Update()
 }
 void CServerBrowserHttp::Refresh()
 {
-	if(m_State == STATE_WANTREFRESH || m_State == STATE_REFRESHING || m_State == STATE_NO_MASTER)
+	if(m_State == STATE_WANTREFRESH || m_State == STATE_REFRESHING || m_State == STATE_PARSING || m_State == STATE_NO_MASTER)
 	{
 		if(m_State == STATE_NO_MASTER)
 			m_State = STATE_WANTREFRESH;
@@ -431,12 +652,13 @@ static bool ServerbrowserParseUrl(NETADDR *pOut, const char *pUrl)
 }
 bool CServerBrowserHttp::Validate(json_value *pJson)
 {
-	std::vector<CServerInfo> vServers;
-	return Parse(pJson, &vServers);
+	CServerTable Servers;
+	return Parse(pJson, &Servers);
 }
-bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvServers)
+bool CServerBrowserHttp::Parse(json_value *pJson, CServerTable *pServers)
 {
-	std::vector<CServerInfo> vServers;
+	CServerTable Table;
+	CServerTableBuilder Builder(&Table);
 
 	const json_value &Json = *pJson;
 	const json_value &Servers = Json["servers"];
@@ -471,9 +693,8 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvSe
 			// values.
 			continue;
 		}
-		CServerInfo SetInfo = ParsedInfo;
-		SetInfo.m_Location = ParsedLocation;
-		SetInfo.m_NumAddresses = 0;
+		NETADDR aAddresses[MAX_SERVER_ADDRESSES];
+		int NumAddresses = 0;
 		bool GotVersion6 = false;
 		for(unsigned int a = 0; a < Addresses.u.array.length; a++)
 		{
@@ -505,18 +726,18 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvSe
 				// Skip unknown addresses.
 				continue;
 			}
-			if(SetInfo.m_NumAddresses < (int)std::size(SetInfo.m_aAddresses))
+			if(NumAddresses < (int)std::size(aAddresses))
 			{
-				SetInfo.m_aAddresses[SetInfo.m_NumAddresses] = ParsedAddr;
-				SetInfo.m_NumAddresses += 1;
+				aAddresses[NumAddresses] = ParsedAddr;
+				NumAddresses += 1;
 			}
 		}
-		if(SetInfo.m_NumAddresses > 0)
+		if(NumAddresses > 0)
 		{
-			vServers.push_back(SetInfo);
+			Builder.AddServer(ParsedInfo, ParsedLocation, aAddresses, NumAddresses);
 		}
 	}
-	*pvServers = vServers;
+	*pServers = std::move(Table);
 	return false;
 }
 
@@ -21,7 +21,8 @@ public:
 	virtual bool GetBestUrl(const char **pBestUrl) const = 0;
 
 	virtual int NumServers() const = 0;
-	virtual const CServerInfo &Server(int Index) const = 0;
+	virtual void Server(int Index, CServerInfo *pOut) const = 0;
+	virtual void ServerAddresses(int Index, const NETADDR **ppAddresses, int *pNumAddresses) const = 0;
 };
 
 IServerBrowserHttp *CreateServerBrowserHttp(IEngine *pEngine, IStorage *pStorage, IHttp *pHttp, const char *pPreviousBestUrl);
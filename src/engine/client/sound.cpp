@@ -22,30 +22,128 @@ extern "C" {
 
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOUND_MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SOUND_MIX_NEON
+#include <arm_neon.h>
+#endif
+
 static constexpr int SAMPLE_INDEX_USED = -2;
 static constexpr int SAMPLE_INDEX_FULL = -1;
 
+// the vector paths multiply 16-bit samples by 16-bit volumes into 32-bit products
+static bool CanMixVectorized(int VolumeL, int VolumeR)
+{
+	return VolumeL == (short)VolumeL && VolumeR == (short)VolumeR;
+}
+
+// Adds each input sample, scaled by the volume of its output channel, to the
+// mix buffer. Leftover frames and unusual volumes use the scalar loop.
+
+static void MixMono(int *pOut, const short *pIn, unsigned Frames, int VolumeL, int VolumeR)
+{
+	unsigned s = 0;
+#if defined(SOUND_MIX_SSE2)
+	if(CanMixVectorized(VolumeL, VolumeR))
+	{
+		const __m128i Volume = _mm_set_epi16(VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL);
+		for(; s + 8 <= Frames; s += 8)
+		{
+			const __m128i In = _mm_loadu_si128((const __m128i *)&pIn[s]);
+			const __m128i aIn[2] = {_mm_unpacklo_epi16(In, In), _mm_unpackhi_epi16(In, In)};
+			for(int Half = 0; Half < 2; Half++)
+			{
+				const __m128i Low = _mm_mullo_epi16(aIn[Half], Volume);
+				const __m128i High = _mm_mulhi_epi16(aIn[Half], Volume);
+				__m128i *pDest = (__m128i *)&pOut[s * 2 + Half * 8];
+				_mm_storeu_si128(pDest, _mm_add_epi32(_mm_loadu_si128(pDest), _mm_unpacklo_epi16(Low, High)));
+				_mm_storeu_si128(pDest + 1, _mm_add_epi32(_mm_loadu_si128(pDest + 1), _mm_unpackhi_epi16(Low, High)));
+			}
+		}
+	}
+#elif defined(SOUND_MIX_NEON)
+	if(CanMixVectorized(VolumeL, VolumeR))
+	{
+		const int16_t aVolume[4] = {(int16_t)VolumeL, (int16_t)VolumeR, (int16_t)VolumeL, (int16_t)VolumeR};
+		const int16x4_t Volume = vld1_s16(aVolume);
+		for(; s + 4 <= Frames; s += 4)
+		{
+			const int16x4_t In = vld1_s16(&pIn[s]);
+			const int16x4x2_t Interleaved = vzip_s16(In, In);
+			vst1q_s32(&pOut[s * 2], vmlal_s16(vld1q_s32(&pOut[s * 2]), Interleaved.val[0], Volume));
+			vst1q_s32(&pOut[s * 2 + 4], vmlal_s16(vld1q_s32(&pOut[s * 2 + 4]), Interleaved.val[1], Volume));
+		}
+	}
+#endif
+	for(; s < Frames; s++)
+	{
+		pOut[s * 2] += pIn[s] * VolumeL;
+		pOut[s * 2 + 1] += pIn[s] * VolumeR;
+	}
+}
+
+static void MixStereo(int *pOut, const short *pIn, unsigned Frames, int VolumeL, int VolumeR)
+{
+	unsigned s = 0;
+#if defined(SOUND_MIX_SSE2)
+	if(CanMixVectorized(VolumeL, VolumeR))
+	{
+		const __m128i Volume = _mm_set_epi16(VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL);
+		for(; s + 8 <= Frames * 2; s += 8)
+		{
+			const __m128i In = _mm_loadu_si128((const __m128i *)&pIn[s]);
+			const __m128i Low = _mm_mullo_epi16(In, Volume);
+			const __m128i High = _mm_mulhi_epi16(In, Volume);
+			__m128i *pDest = (__m128i *)&pOut[s];
+			_mm_storeu_si128(pDest, _mm_add_epi32(_mm_loadu_si128(pDest), _mm_unpacklo_epi16(Low, High)));
+			_mm_storeu_si128(pDest + 1, _mm_add_epi32(_mm_loadu_si128(pDest + 1), _mm_unpackhi_epi16(Low, High)));
+		}
+	}
+#elif defined(SOUND_MIX_NEON)
+	if(CanMixVectorized(VolumeL, VolumeR))
+	{
+		const int16_t aVolume[4] = {(int16_t)VolumeL, (int16_t)VolumeR, (int16_t)VolumeL, (int16_t)VolumeR};
+		const int16x4_t Volume = vld1_s16(aVolume);
+		for(; s + 8 <= Frames * 2; s += 8)
+		{
+			const int16x8_t In = vld1q_s16(&pIn[s]);
+			vst1q_s32(&pOut[s], vmlal_s16(vld1q_s32(&pOut[s]), vget_low_s16(In), Volume));
+			vst1q_s32(&pOut[s + 4], vmlal_s16(vld1q_s32(&pOut[s + 4]), vget_high_s16(In), Volume));
+		}
+	}
+#endif
+	for(; s < Frames * 2; s += 2)
+	{
+		pOut[s] += pIn[s] * VolumeL;
+		pOut[s + 1] += pIn[s + 1] * VolumeR;
+	}
+}
+
 void CSound::Mix(short *pFinalOut, unsigned Frames)
 {
 	Frames = minimum(Frames, m_MaxFrames);
 	mem_zero(m_pMixBuffer, Frames * 2 * sizeof(int));
 
-	// acquire lock while we are mixing
+	// the mix lock keeps the sample data of this pass alive, while the sound
+	// lock is only held to collect the voices, so the game thread rarely waits
+	const CLockScope MixLockScope(m_MixLock);
+	int NumMixVoices = 0;
+
 	m_SoundLock.lock();
+	ApplyCommands();
 
 	const int MasterVol = m_SoundVolume.load(std::memory_order_relaxed);
 
-	for(auto &Voice : m_aVoices)
+	for(int VoiceId = 0; VoiceId < NUM_VOICES; VoiceId++)
 	{
+		CVoice &Voice = m_aVoices[VoiceId];
 		if(!Voice.m_pSample)
 			continue;
 
-		// mix voice
-		int *pOut = m_pMixBuffer;
-
 		const int Step = Voice.m_pSample->m_Channels; // setup input sources
-		short *pInL = &Voice.m_pSample->m_pData[Voice.m_Tick * Step];
-		short *pInR = &Voice.m_pSample->m_pData[Voice.m_Tick * Step + 1];
+		const short *pIn = &Voice.m_pSample->m_pData[Voice.m_Tick * Step];
 
 		unsigned End = Voice.m_pSample->m_NumFrames - Voice.m_Tick;
 
@@ -56,10 +154,6 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		if(Frames < End)
 			End = Frames;
 
-		// check if we have a mono sound
-		if(Voice.m_pSample->m_Channels == 1)
-			pInR = pInL;
-
 		// volume calculation
 		if(Voice.m_Flags & ISound::FLAG_POS && Voice.m_pChannel->m_Pan)
 		{
@@ -132,15 +226,17 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 			}
 		}
 
-		// process all frames
-		for(unsigned s = 0; s < End; s++)
+		// voices which can't be heard only advance
+		if(End > 0 && (VolumeL != 0 || VolumeR != 0))
 		{
-			*pOut++ += (*pInL) * VolumeL;
-			*pOut++ += (*pInR) * VolumeR;
-			pInL += Step;
-			pInR += Step;
-			Voice.m_Tick++;
+			CMixVoice &MixVoice = m_aMixVoices[NumMixVoices++];
+			MixVoice.m_pData = pIn;
+			MixVoice.m_NumFrames = End;
+			MixVoice.m_Channels = Step;
+			MixVoice.m_VolumeL = VolumeL;
+			MixVoice.m_VolumeR = VolumeR;
 		}
+		Voice.m_Tick += End;
 
 		// free voice if not used any more
 		if(Voice.m_Tick == Voice.m_pSample->m_NumFrames)
@@ -150,13 +246,22 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 			else
 			{
 				Voice.m_pSample = nullptr;
-				Voice.m_Age++;
+				m_aVoiceSlots[VoiceId].m_FinishedAge.store(Voice.m_Age, std::memory_order_release);
 			}
 		}
 	}
 
 	m_SoundLock.unlock();
 
+	for(int i = 0; i < NumMixVoices; i++)
+	{
+		const CMixVoice &MixVoice = m_aMixVoices[i];
+		if(MixVoice.m_Channels == 1)
+			MixMono(m_pMixBuffer, MixVoice.m_pData, MixVoice.m_NumFrames, MixVoice.m_VolumeL, MixVoice.m_VolumeR);
+		else
+			MixStereo(m_pMixBuffer, MixVoice.m_pData, MixVoice.m_NumFrames, MixVoice.m_VolumeL, MixVoice.m_VolumeR);
+	}
+
 	// clamp accumulated values
 	for(unsigned i = 0; i < Frames * 2; i++)
 		pFinalOut[i] = std::clamp<int>(((m_pMixBuffer[i] * MasterVol) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
@@ -166,6 +271,204 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 #endif
 }
 
+void CSound::PushCommand(const CSoundCommand &Command)
+{
+	if(m_Commands.Push(Command))
+		return;
+
+	// the mixer fell behind, apply the queued commands ourselves
+	const CLockScope LockScope(m_SoundLock);
+	ApplyCommands();
+	ApplyCommand(Command);
+}
+
+void CSound::ApplyCommands()
+{
+	CSoundCommand Command;
+	while(m_Commands.Pop(Command))
+		ApplyCommand(Command);
+}
+
+void CSound::ApplyCommand(const CSoundCommand &Command)
+{
+	switch(Command.m_Type)
+	{
+	case CSoundCommand::PLAY:
+	{
+		CVoice &Voice = m_aVoices[Command.m_Index];
+		CSample &Sample = m_aSamples[Command.m_SampleId];
+		Voice.m_pSample = &Sample;
+		Voice.m_pChannel = &m_aChannels[Command.m_ChannelId];
+		Voice.m_Age = Command.m_Age;
+		if(Command.m_Flags & FLAG_LOOP)
+		{
+			Voice.m_Tick = Sample.m_PausedAt;
+		}
+		else if(Command.m_Flags & FLAG_PREVIEW)
+		{
+			Voice.m_Tick = Sample.m_PausedAt;
+			Sample.m_PausedAt = 0;
+		}
+		else
+		{
+			Voice.m_Tick = 0;
+		}
+		Voice.m_Vol = (int)(Command.m_Value * 255.0f);
+		Voice.m_Flags = Command.m_Flags;
+		Voice.m_Position = Command.m_Vector;
+		Voice.m_Falloff = 0.0f;
+		Voice.m_Shape = ISound::SHAPE_CIRCLE;
+		Voice.m_Circle.m_Radius = 1500;
+		return;
+	}
+
+	case CSoundCommand::SET_CHANNEL:
+		m_aChannels[Command.m_Index].m_Vol = (int)(Command.m_Vector.x * 255.0f);
+		m_aChannels[Command.m_Index].m_Pan = (int)(Command.m_Vector.y * 255.0f); // TODO: this is only on and off right now
+		return;
+
+	case CSoundCommand::PAUSE_SAMPLE:
+		StopSample(Command.m_Index, true);
+		return;
+
+	case CSoundCommand::STOP_SAMPLE:
+		StopSample(Command.m_Index, false);
+		return;
+
+	case CSoundCommand::STOP_ALL:
+		for(auto &Voice : m_aVoices)
+		{
+			if(Voice.m_pSample)
+			{
+				if(Voice.m_Flags & FLAG_LOOP)
+					Voice.m_pSample->m_PausedAt = Voice.m_Tick;
+				else
+					Voice.m_pSample->m_PausedAt = 0;
+			}
+			Voice.m_pSample = nullptr;
+		}
+		return;
+
+	case CSoundCommand::SET_SAMPLE_TIME:
+	{
+		CSample *pSample = &m_aSamples[Command.m_Index];
+		if(!pSample->IsLoaded())
+			return;
+		for(auto &Voice : m_aVoices)
+		{
+			if(Voice.m_pSample == pSample)
+			{
+				Voice.m_Tick = pSample->m_NumFrames * Command.m_Value;
+				return;
+			}
+		}
+		pSample->m_PausedAt = pSample->m_NumFrames * Command.m_Value;
+		return;
+	}
+
+	default:
+		break;
+	}
+
+	// the remaining commands change a single voice, unless it was stopped in the meantime
+	CVoice &Voice = m_aVoices[Command.m_Index];
+	if(!Voice.m_pSample || Voice.m_Age != Command.m_Age)
+		return;
+
+	switch(Command.m_Type)
+	{
+	case CSoundCommand::STOP_VOICE:
+		Voice.m_pSample = nullptr;
+		break;
+
+	case CSoundCommand::SET_VOLUME:
+		Voice.m_Vol = (int)(Command.m_Value * 255.0f);
+		break;
+
+	case CSoundCommand::SET_FALLOFF:
+		Voice.m_Falloff = Command.m_Value;
+		break;
+
+	case CSoundCommand::SET_POSITION:
+		Voice.m_Position = Command.m_Vector;
+		break;
+
+	case CSoundCommand::SET_TIME_OFFSET:
+	{
+		int Tick = 0;
+		bool IsLooping = Voice.m_Flags & ISound::FLAG_LOOP;
+		uint64_t TickOffset = Voice.m_pSample->m_Rate * Command.m_Value;
+		if(Voice.m_pSample->m_NumFrames > 0 && IsLooping)
+			Tick = TickOffset % Voice.m_pSample->m_NumFrames;
+		else
+			Tick = std::clamp(TickOffset, (uint64_t)0, (uint64_t)Voice.m_pSample->m_NumFrames);
+
+		// at least 200msec off, else depend on buffer size
+		float Threshold = maximum(0.2f * Voice.m_pSample->m_Rate, (float)m_MaxFrames);
+		if(absolute(Voice.m_Tick - Tick) > Threshold)
+		{
+			// take care of looping (modulo!)
+			if(!(IsLooping && (minimum(Voice.m_Tick, Tick) + Voice.m_pSample->m_NumFrames - maximum(Voice.m_Tick, Tick)) <= Threshold))
+			{
+				Voice.m_Tick = Tick;
+			}
+		}
+		break;
+	}
+
+	case CSoundCommand::SET_CIRCLE:
+		Voice.m_Shape = ISound::SHAPE_CIRCLE;
+		Voice.m_Circle.m_Radius = Command.m_Value;
+		break;
+
+	case CSoundCommand::SET_RECTANGLE:
+		Voice.m_Shape = ISound::SHAPE_RECTANGLE;
+		Voice.m_Rectangle.m_Width = Command.m_Vector.x;
+		Voice.m_Rectangle.m_Height = Command.m_Vector.y;
+		break;
+
+	default:
+		dbg_assert_failed("Invalid sound command type %d", (int)Command.m_Type);
+	}
+}
+
+void CSound::StopSample(int SampleId, bool Pause)
+{
+	// TODO: a nice fade out
+	CSample *pSample = &m_aSamples[SampleId];
+	for(auto &Voice : m_aVoices)
+	{
+		if(Voice.m_pSample == pSample)
+		{
+			if(Pause || Voice.m_Flags & FLAG_LOOP)
+				Voice.m_pSample->m_PausedAt = Voice.m_Tick;
+			else
+				Voice.m_pSample->m_PausedAt = 0;
+			Voice.m_pSample = nullptr;
+		}
+	}
+}
+
+void CSound::AssertSampleLoaded(int SampleId)
+{
+	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
+
+	// checked here, as the command is applied on the mixer thread
+	const CLockScope LockScope(m_SoundLock);
+	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
+}
+
+CVoiceSlot *CSound::VoiceSlot(CVoiceHandle Voice)
+{
+	if(!Voice.IsValid())
+		return nullptr;
+
+	CVoiceSlot &Slot = m_aVoiceSlots[Voice.Id()];
+	if(Slot.m_Age != Voice.Age() || !Slot.IsActive())
+		return nullptr;
+	return &Slot;
+}
+
 static void SdlCallback(void *pUser, Uint8 *pStream, int Len)
 {
 	CSound *pSound = static_cast<CSound *>(pUser);
@@ -268,6 +571,7 @@ void CSound::Shutdown()
 	m_Device = 0;
 
 	const CLockScope LockScope(m_SoundLock);
+	ApplyCommands();
 	for(auto &Sample : m_aSamples)
 	{
 		free(Sample.m_pData);
@@ -640,31 +944,46 @@ void CSound::UnloadSample(int SampleId)
 		return;
 
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
-	const CLockScope LockScope(m_SoundLock);
-	CSample &Sample = m_aSamples[SampleId];
-
-	if(Sample.IsLoaded())
+	short *pData = nullptr;
 	{
-		// Stop voices using this sample
-		for(auto &Voice : m_aVoices)
+		const CLockScope LockScope(m_SoundLock);
+		ApplyCommands();
+		CSample &Sample = m_aSamples[SampleId];
+
+		if(Sample.IsLoaded())
 		{
-			if(Voice.m_pSample == &Sample)
+			// Stop voices using this sample
+			for(auto &Voice : m_aVoices)
 			{
-				Voice.m_pSample = nullptr;
+				if(Voice.m_pSample == &Sample)
+				{
+					Voice.m_pSample = nullptr;
+				}
+			}
+			for(auto &Slot : m_aVoiceSlots)
+			{
+				if(Slot.m_SampleId == SampleId)
+				{
+					Slot.m_SampleId = -1;
+					Slot.m_Age++;
+				}
 			}
+
+			pData = Sample.m_pData;
+			Sample.m_pData = nullptr;
 		}
 
-		// Free data
-		free(Sample.m_pData);
-		Sample.m_pData = nullptr;
+		// Free slot
+		if(Sample.m_NextFreeSampleIndex == SAMPLE_INDEX_USED)
+		{
+			Sample.m_NextFreeSampleIndex = m_FirstFreeSampleIndex;
+			m_FirstFreeSampleIndex = Sample.m_Index;
+		}
 	}
 
-	// Free slot
-	if(Sample.m_NextFreeSampleIndex == SAMPLE_INDEX_USED)
-	{
-		Sample.m_NextFreeSampleIndex = m_FirstFreeSampleIndex;
-		m_FirstFreeSampleIndex = Sample.m_Index;
-	}
+	// Free data once a mixing pass which collected the voices before may no longer read it
+	const CLockScope MixLockScope(m_MixLock);
+	free(pData);
 }
 
 float CSound::GetSampleTotalTime(int SampleId)
@@ -681,6 +1000,7 @@ float CSound::GetSampleCurrentTime(int SampleId)
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
 
 	const CLockScope LockScope(m_SoundLock);
+	ApplyCommands();
 	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
 	CSample *pSample = &m_aSamples[SampleId];
 	for(auto &Voice : m_aVoices)
@@ -696,30 +1016,20 @@ float CSound::GetSampleCurrentTime(int SampleId)
 
 void CSound::SetSampleCurrentTime(int SampleId, float Time)
 {
-	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
-
-	const CLockScope LockScope(m_SoundLock);
-	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
-	CSample *pSample = &m_aSamples[SampleId];
-	for(auto &Voice : m_aVoices)
-	{
-		if(Voice.m_pSample == pSample)
-		{
-			Voice.m_Tick = pSample->m_NumFrames * Time;
-			return;
-		}
-	}
+	AssertSampleLoaded(SampleId);
 
-	pSample->m_PausedAt = pSample->m_NumFrames * Time;
+	CSoundCommand Command(CSoundCommand::SET_SAMPLE_TIME, SampleId);
+	Command.m_Value = Time;
+	PushCommand(Command);
 }
 
 void CSound::SetChannel(int ChannelId, float Vol, float Pan)
 {
 	dbg_assert(ChannelId >= 0 && ChannelId < NUM_CHANNELS, "ChannelId invalid");
 
-	const CLockScope LockScope(m_SoundLock);
-	m_aChannels[ChannelId].m_Vol = (int)(Vol * 255.0f);
-	m_aChannels[ChannelId].m_Pan = (int)(Pan * 255.0f); // TODO: this is only on and off right now
+	CSoundCommand Command(CSoundCommand::SET_CHANNEL, ChannelId);
+	Command.m_Vector = vec2(Vol, Pan);
+	PushCommand(Command);
 }
 
 void CSound::SetListenerPosition(vec2 Position)
@@ -730,123 +1040,72 @@ void CSound::SetListenerPosition(vec2 Position)
 
 void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
 {
-	if(!Voice.IsValid())
+	if(!VoiceSlot(Voice))
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	Volume = std::clamp(Volume, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Vol = (int)(Volume * 255.0f);
+	CSoundCommand Command(CSoundCommand::SET_VOLUME, Voice.Id(), Voice.Age());
+	Command.m_Value = std::clamp(Volume, 0.0f, 1.0f);
+	PushCommand(Command);
 }
 
 void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
 {
-	if(!Voice.IsValid())
-		return;
-
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	if(!VoiceSlot(Voice))
 		return;
 
-	Falloff = std::clamp(Falloff, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Falloff = Falloff;
+	CSoundCommand Command(CSoundCommand::SET_FALLOFF, Voice.Id(), Voice.Age());
+	Command.m_Value = std::clamp(Falloff, 0.0f, 1.0f);
+	PushCommand(Command);
 }
 
 void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
 {
-	if(!Voice.IsValid())
+	if(!VoiceSlot(Voice))
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceId].m_Position = Position;
+	CSoundCommand Command(CSoundCommand::SET_POSITION, Voice.Id(), Voice.Age());
+	Command.m_Vector = Position;
+	PushCommand(Command);
 }
 
 void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
 {
-	if(!Voice.IsValid())
+	if(!VoiceSlot(Voice))
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	if(!m_aVoices[VoiceId].m_pSample)
-		return;
-
-	int Tick = 0;
-	bool IsLooping = m_aVoices[VoiceId].m_Flags & ISound::FLAG_LOOP;
-	uint64_t TickOffset = m_aVoices[VoiceId].m_pSample->m_Rate * TimeOffset;
-	if(m_aVoices[VoiceId].m_pSample->m_NumFrames > 0 && IsLooping)
-		Tick = TickOffset % m_aVoices[VoiceId].m_pSample->m_NumFrames;
-	else
-		Tick = std::clamp(TickOffset, (uint64_t)0, (uint64_t)m_aVoices[VoiceId].m_pSample->m_NumFrames);
-
-	// at least 200msec off, else depend on buffer size
-	float Threshold = maximum(0.2f * m_aVoices[VoiceId].m_pSample->m_Rate, (float)m_MaxFrames);
-	if(absolute(m_aVoices[VoiceId].m_Tick - Tick) > Threshold)
-	{
-		// take care of looping (modulo!)
-		if(!(IsLooping && (minimum(m_aVoices[VoiceId].m_Tick, Tick) + m_aVoices[VoiceId].m_pSample->m_NumFrames - maximum(m_aVoices[VoiceId].m_Tick, Tick)) <= Threshold))
-		{
-			m_aVoices[VoiceId].m_Tick = Tick;
-		}
-	}
+	CSoundCommand Command(CSoundCommand::SET_TIME_OFFSET, Voice.Id(), Voice.Age());
+	Command.m_Value = TimeOffset;
+	PushCommand(Command);
 }
 
 void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
 {
-	if(!Voice.IsValid())
-		return;
-
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	if(!VoiceSlot(Voice))
 		return;
 
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceId].m_Circle.m_Radius = maximum(0.0f, Radius);
+	CSoundCommand Command(CSoundCommand::SET_CIRCLE, Voice.Id(), Voice.Age());
+	Command.m_Value = maximum(0.0f, Radius);
+	PushCommand(Command);
 }
 
 void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
 {
-	if(!Voice.IsValid())
+	if(!VoiceSlot(Voice))
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_RECTANGLE;
-	m_aVoices[VoiceId].m_Rectangle.m_Width = maximum(0.0f, Width);
-	m_aVoices[VoiceId].m_Rectangle.m_Height = maximum(0.0f, Height);
+	CSoundCommand Command(CSoundCommand::SET_RECTANGLE, Voice.Id(), Voice.Age());
+	Command.m_Vector = vec2(maximum(0.0f, Width), maximum(0.0f, Height));
+	PushCommand(Command);
 }
 
 ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position)
 {
-	const CLockScope LockScope(m_SoundLock);
-
 	// search for voice
 	int VoiceId = -1;
 	for(int i = 0; i < NUM_VOICES; i++)
 	{
 		int NextId = (m_NextVoice + i) % NUM_VOICES;
-		if(!m_aVoices[NextId].m_pSample)
+		if(!m_aVoiceSlots[NextId].IsActive())
 		{
 			VoiceId = NextId;
 			m_NextVoice = NextId + 1;
@@ -859,28 +1118,19 @@ ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float
 	}
 
 	// voice found, use it
-	m_aVoices[VoiceId].m_pSample = &m_aSamples[SampleId];
-	m_aVoices[VoiceId].m_pChannel = &m_aChannels[ChannelId];
-	if(Flags & FLAG_LOOP)
-	{
-		m_aVoices[VoiceId].m_Tick = m_aSamples[SampleId].m_PausedAt;
-	}
-	else if(Flags & FLAG_PREVIEW)
-	{
-		m_aVoices[VoiceId].m_Tick = m_aSamples[SampleId].m_PausedAt;
-		m_aSamples[SampleId].m_PausedAt = 0;
-	}
-	else
-	{
-		m_aVoices[VoiceId].m_Tick = 0;
-	}
-	m_aVoices[VoiceId].m_Vol = (int)(std::clamp(Volume, 0.0f, 1.0f) * 255.0f);
-	m_aVoices[VoiceId].m_Flags = Flags;
-	m_aVoices[VoiceId].m_Position = Position;
-	m_aVoices[VoiceId].m_Falloff = 0.0f;
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceId].m_Circle.m_Radius = 1500;
-	return CreateVoiceHandle(VoiceId, m_aVoices[VoiceId].m_Age);
+	CVoiceSlot &Slot = m_aVoiceSlots[VoiceId];
+	if(Slot.m_SampleId != -1)
+		Slot.m_Age++; // finished on its own
+	Slot.m_SampleId = SampleId;
+
+	CSoundCommand Command(CSoundCommand::PLAY, VoiceId, Slot.m_Age);
+	Command.m_SampleId = SampleId;
+	Command.m_ChannelId = ChannelId;
+	Command.m_Flags = Flags;
+	Command.m_Value = std::clamp(Volume, 0.0f, 1.0f);
+	Command.m_Vector = Position;
+	PushCommand(Command);
+	return CreateVoiceHandle(VoiceId, Slot.m_Age);
 }
 
 ISound::CVoiceHandle CSound::PlayAt(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position)
@@ -895,82 +1145,62 @@ ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float
 
 void CSound::Pause(int SampleId)
 {
-	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
+	AssertSampleLoaded(SampleId);
 
-	// TODO: a nice fade out
-	const CLockScope LockScope(m_SoundLock);
-	CSample *pSample = &m_aSamples[SampleId];
-	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
-	for(auto &Voice : m_aVoices)
+	for(auto &Slot : m_aVoiceSlots)
 	{
-		if(Voice.m_pSample == pSample)
+		if(Slot.m_SampleId == SampleId && Slot.IsActive())
 		{
-			Voice.m_pSample->m_PausedAt = Voice.m_Tick;
-			Voice.m_pSample = nullptr;
+			Slot.m_SampleId = -1;
+			Slot.m_Age++;
 		}
 	}
+	PushCommand(CSoundCommand(CSoundCommand::PAUSE_SAMPLE, SampleId));
 }
 
 void CSound::Stop(int SampleId)
 {
-	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
+	AssertSampleLoaded(SampleId);
 
-	// TODO: a nice fade out
-	const CLockScope LockScope(m_SoundLock);
-	CSample *pSample = &m_aSamples[SampleId];
-	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
-	for(auto &Voice : m_aVoices)
+	for(auto &Slot : m_aVoiceSlots)
 	{
-		if(Voice.m_pSample == pSample)
+		if(Slot.m_SampleId == SampleId && Slot.IsActive())
 		{
-			if(Voice.m_Flags & FLAG_LOOP)
-				Voice.m_pSample->m_PausedAt = Voice.m_Tick;
-			else
-				Voice.m_pSample->m_PausedAt = 0;
-			Voice.m_pSample = nullptr;
+			Slot.m_SampleId = -1;
+			Slot.m_Age++;
 		}
 	}
+	PushCommand(CSoundCommand(CSoundCommand::STOP_SAMPLE, SampleId));
 }
 
 void CSound::StopAll()
 {
-	// TODO: a nice fade out
-	const CLockScope LockScope(m_SoundLock);
-	for(auto &Voice : m_aVoices)
+	for(auto &Slot : m_aVoiceSlots)
 	{
-		if(Voice.m_pSample)
+		if(Slot.IsActive())
 		{
-			if(Voice.m_Flags & FLAG_LOOP)
-				Voice.m_pSample->m_PausedAt = Voice.m_Tick;
-			else
-				Voice.m_pSample->m_PausedAt = 0;
+			Slot.m_SampleId = -1;
+			Slot.m_Age++;
 		}
-		Voice.m_pSample = nullptr;
 	}
+	PushCommand(CSoundCommand(CSoundCommand::STOP_ALL, -1));
 }
 
 void CSound::StopVoice(CVoiceHandle Voice)
 {
-	if(!Voice.IsValid())
+	CVoiceSlot *pSlot = VoiceSlot(Voice);
+	if(!pSlot)
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceId].m_pSample = nullptr;
-	m_aVoices[VoiceId].m_Age++;
+	pSlot->m_SampleId = -1;
+	pSlot->m_Age++;
+	PushCommand(CSoundCommand(CSoundCommand::STOP_VOICE, Voice.Id(), Voice.Age()));
 }
 
 bool CSound::IsPlaying(int SampleId)
 {
 	dbg_assert(SampleId >= 0 && SampleId < NUM_SAMPLES, "SampleId invalid");
-	const CLockScope LockScope(m_SoundLock);
-	const CSample *pSample = &m_aSamples[SampleId];
-	dbg_assert(m_aSamples[SampleId].IsLoaded(), "Sample not loaded");
-	return std::any_of(std::begin(m_aVoices), std::end(m_aVoices), [pSample](const auto &Voice) { return Voice.m_pSample == pSample; });
+	return std::any_of(std::begin(m_aVoiceSlots), std::end(m_aVoiceSlots), [SampleId](const auto &Slot) { return Slot.m_SampleId == SampleId && Slot.IsActive(); });
 }
 
 void CSound::PauseAudioDevice()
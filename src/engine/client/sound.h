@@ -60,6 +60,87 @@ struct CVoice
 	};
 };
 
+// State of a voice as seen by the game thread, which can be ahead of the mixer
+struct CVoiceSlot
+{
+	int m_SampleId = -1; // -1 when the voice is free
+	int m_Age = 0;
+	// set by the mixer to the age of the voice when it finished playing on its own
+	std::atomic<int> m_FinishedAge = -1;
+
+	bool IsActive() const { return m_SampleId != -1 && m_FinishedAge.load(std::memory_order_acquire) != m_Age; }
+};
+
+// Changes of the voice state which are applied by the mixer before mixing
+struct CSoundCommand
+{
+	enum EType
+	{
+		PLAY,
+		STOP_VOICE,
+		SET_VOLUME,
+		SET_FALLOFF,
+		SET_POSITION,
+		SET_TIME_OFFSET,
+		SET_CIRCLE,
+		SET_RECTANGLE,
+		SET_CHANNEL,
+		PAUSE_SAMPLE,
+		STOP_SAMPLE,
+		STOP_ALL,
+		SET_SAMPLE_TIME,
+	};
+
+	EType m_Type = PLAY;
+	int m_Index = -1; // voice, channel or sample index
+	int m_Age = -1; // age of the voice
+	int m_SampleId = -1;
+	int m_ChannelId = -1;
+	int m_Flags = 0;
+	float m_Value = 0.0f; // volume, falloff, time or radius
+	vec2 m_Vector = vec2(0.0f, 0.0f); // position, rectangle size or channel volume and pan
+
+	CSoundCommand() = default;
+	CSoundCommand(EType Type, int Index, int Age = -1) :
+		m_Type(Type), m_Index(Index), m_Age(Age)
+	{
+	}
+};
+
+// Lock-free ring buffer with one producer (the game thread) and one consumer (the mixer)
+class CSoundCommandQueue
+{
+	enum
+	{
+		SIZE = 4096,
+	};
+
+	CSoundCommand m_aCommands[SIZE];
+	std::atomic<unsigned> m_Read = 0;
+	std::atomic<unsigned> m_Write = 0;
+
+public:
+	bool Push(const CSoundCommand &Command)
+	{
+		const unsigned Write = m_Write.load(std::memory_order_relaxed);
+		if(Write - m_Read.load(std::memory_order_acquire) == SIZE)
+			return false;
+		m_aCommands[Write % SIZE] = Command;
+		m_Write.store(Write + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(CSoundCommand &Command)
+	{
+		const unsigned Read = m_Read.load(std::memory_order_relaxed);
+		if(Read == m_Write.load(std::memory_order_acquire))
+			return false;
+		Command = m_aCommands[Read % SIZE];
+		m_Read.store(Read + 1, std::memory_order_release);
+		return true;
+	}
+};
+
 class CSound : public IEngineSound
 {
 	enum
@@ -69,18 +150,42 @@ class CSound : public IEngineSound
 		NUM_CHANNELS = 16,
 	};
 
+	struct CMixVoice
+	{
+		const short *m_pData;
+		unsigned m_NumFrames;
+		int m_Channels;
+		int m_VolumeL;
+		int m_VolumeR;
+	};
+
 	bool m_SoundEnabled = false;
 	SDL_AudioDeviceID m_Device = 0;
+	CLock m_MixLock ACQUIRED_BEFORE(m_SoundLock);
 	CLock m_SoundLock;
 
+	// voices of the current pass, mixed after the sound lock is released
+	CMixVoice m_aMixVoices[NUM_VOICES] GUARDED_BY(m_MixLock);
+
 	CSample m_aSamples[NUM_SAMPLES] GUARDED_BY(m_SoundLock) = {{0}};
 	int m_FirstFreeSampleIndex GUARDED_BY(m_SoundLock) = 0;
 
 	CVoice m_aVoices[NUM_VOICES] GUARDED_BY(m_SoundLock) = {{nullptr}};
 	CChannel m_aChannels[NUM_CHANNELS] GUARDED_BY(m_SoundLock) = {{255, 0}};
-	int m_NextVoice GUARDED_BY(m_SoundLock) = 0;
 	uint32_t m_MaxFrames = 0;
 
+	// Voice changes from the game thread don't wait for the mixer, which
+	// applies them while holding the lock at the start of the next mix
+	CVoiceSlot m_aVoiceSlots[NUM_VOICES];
+	int m_NextVoice = 0;
+	CSoundCommandQueue m_Commands;
+	void PushCommand(const CSoundCommand &Command) REQUIRES(!m_SoundLock);
+	void ApplyCommands() REQUIRES(m_SoundLock);
+	void ApplyCommand(const CSoundCommand &Command) REQUIRES(m_SoundLock);
+	void StopSample(int SampleId, bool Pause) REQUIRES(m_SoundLock);
+	void AssertSampleLoaded(int SampleId) REQUIRES(!m_SoundLock);
+	CVoiceSlot *VoiceSlot(CVoiceHandle Voice);
+
 	// This is not an std::atomic<vec2> as this would require linking with
 	// libatomic with clang x86 as there is no native support for this.
 	std::atomic<float> m_ListenerPositionX = 0.0f;
@@ -113,7 +218,7 @@ public:
 	int LoadWV(const char *pFilename, int StorageType = IStorage::TYPE_ALL) override REQUIRES(!m_SoundLock);
 	int LoadOpusFromMem(const void *pData, unsigned DataSize, bool ForceLoad, const char *pContextName) override REQUIRES(!m_SoundLock);
 	int LoadWVFromMem(const void *pData, unsigned DataSize, bool ForceLoad, const char *pContextName) override REQUIRES(!m_SoundLock);
-	void UnloadSample(int SampleId) override REQUIRES(!m_SoundLock);
+	void UnloadSample(int SampleId) override REQUIRES(!m_SoundLock, !m_MixLock);
 
 	float GetSampleTotalTime(int SampleId) override REQUIRES(!m_SoundLock); // in s
 	float GetSampleCurrentTime(int SampleId) override REQUIRES(!m_SoundLock); // in s
@@ -140,7 +245,7 @@ public:
 	bool IsPlaying(int SampleId) override REQUIRES(!m_SoundLock);
 
 	int MixingRate() const override { return m_MixingRate; }
-	void Mix(short *pFinalOut, unsigned Frames) override REQUIRES(!m_SoundLock);
+	void Mix(short *pFinalOut, unsigned Frames) override REQUIRES(!m_SoundLock, !m_MixLock);
 
 	void PauseAudioDevice() override;
 	void UnpauseAudioDevice() override;
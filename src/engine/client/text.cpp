@@ -1,11 +1,16 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/hash.h>
+#include <base/lock.h>
 #include <base/log.h>
 #include <base/math.h>
 #include <base/system.h>
 
 #include <engine/console.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/json.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -19,6 +24,7 @@
 #include <limits>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using namespace std::chrono_literals;
@@ -284,6 +290,478 @@ public:
 	}
 };
 
+static void GrowGlyph(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount)
+{
+	for(int y = 0; y < h; y++)
+	{
+		for(int x = 0; x < w; x++)
+		{
+			int c = pIn[y * w + x];
+
+			for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
+			{
+				for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
+				{
+					int GetX = x + sx;
+					int GetY = y + sy;
+					if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
+					{
+						int Index = GetY * w + GetX;
+						float Mask = 1.f - std::clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
+						c = maximum(c, int(pIn[Index] * Mask));
+					}
+				}
+			}
+
+			pOut[y * w + x] = c;
+		}
+	}
+}
+
+static int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize)
+{
+	if(FontSize > 48)
+		OutlineThickness *= 4;
+	else if(FontSize >= 18)
+		OutlineThickness *= 2;
+	return OutlineThickness;
+}
+
+/**
+ * Bitmaps and metrics of a glyph which has been rendered,
+ * but not yet been placed in the atlas.
+ */
+struct SRasterizedGlyph
+{
+	// index into the faces of the glyph map
+	int m_FaceId;
+	int m_Chr;
+	FT_UInt m_GlyphIndex;
+	int m_FontSize;
+
+	int m_Width;
+	int m_Height;
+	int m_CharWidth;
+	int m_CharHeight;
+	int m_OffsetX;
+	int m_OffsetY;
+	int m_AdvanceX;
+
+	std::vector<uint8_t> m_vFill;
+	std::vector<uint8_t> m_vOutline;
+
+	void GrowOutline()
+	{
+		m_vOutline.resize(m_vFill.size());
+		if(!m_vFill.empty())
+			GrowGlyph(m_vFill.data(), m_vOutline.data(), m_Width, m_Height, AdjustOutlineThicknessToFontSize(1, m_FontSize));
+	}
+};
+
+static bool RasterizeGlyph(FT_Face Face, FT_UInt GlyphIndex, int Chr, int FontSize, SRasterizedGlyph &Glyph)
+{
+	FT_Set_Pixel_Sizes(Face, 0, FontSize);
+
+	if(FT_Load_Glyph(Face, GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+	{
+		log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Chr, GlyphIndex);
+		return false;
+	}
+
+	const FT_Bitmap *pBitmap = &Face->glyph->bitmap;
+	if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+	{
+		log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Chr, GlyphIndex, pBitmap->pixel_mode);
+		return false;
+	}
+
+	const unsigned RealWidth = pBitmap->width;
+	const unsigned RealHeight = pBitmap->rows;
+
+	// adjust spacing
+	int x = 0;
+	int y = 0;
+	if(RealWidth > 0)
+	{
+		x += (AdjustOutlineThicknessToFontSize(1, FontSize) + 1);
+		y += (AdjustOutlineThicknessToFontSize(1, FontSize) + 1);
+	}
+
+	Glyph.m_Chr = Chr;
+	Glyph.m_GlyphIndex = GlyphIndex;
+	Glyph.m_FontSize = FontSize;
+	Glyph.m_Width = RealWidth + x * 2;
+	Glyph.m_Height = RealHeight + y * 2;
+	Glyph.m_CharWidth = RealWidth;
+	Glyph.m_CharHeight = RealHeight;
+	Glyph.m_OffsetX = (Face->glyph->metrics.horiBearingX >> 6);
+	Glyph.m_OffsetY = -((Face->glyph->metrics.height >> 6) - (Face->glyph->metrics.horiBearingY >> 6));
+	Glyph.m_AdvanceX = (Face->glyph->advance.x >> 6);
+
+	Glyph.m_vFill.clear();
+	Glyph.m_vOutline.clear();
+	if(Glyph.m_Width > 0 && Glyph.m_Height > 0)
+	{
+		Glyph.m_vFill.resize((size_t)Glyph.m_Width * Glyph.m_Height);
+		for(unsigned py = 0; py < pBitmap->rows; ++py)
+		{
+			mem_copy(&Glyph.m_vFill[(py + y) * Glyph.m_Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+		}
+		Glyph.GrowOutline();
+	}
+	return true;
+}
+
+/**
+ * Where a font face was loaded from, so it can be opened again
+ * by a different FreeType library instance.
+ */
+struct SFontFaceSource
+{
+	const FT_Byte *m_pFontData;
+	FT_Long m_FontDataSize;
+	FT_Long m_FaceIndex;
+	// index of the font file, faces loaded from the same memory share it
+	int m_FontFile;
+};
+
+static std::vector<SHA256_DIGEST> HashFontFiles(const std::vector<SFontFaceSource> &vFaceSources)
+{
+	std::vector<SHA256_DIGEST> vHashes;
+	for(const SFontFaceSource &Source : vFaceSources)
+	{
+		if(Source.m_FontFile == (int)vHashes.size())
+			vHashes.push_back(sha256(Source.m_pFontData, Source.m_FontDataSize));
+	}
+	return vHashes;
+}
+
+/**
+ * The glyph cache file stores the fill bitmaps of rendered glyphs,
+ * the outlines are regenerated when loading. Entries are identified
+ * by the hash of their font file, so changed fonts are ignored.
+ */
+static constexpr const char *GLYPH_CACHE_FILENAME = "glyph_cache.dat";
+static constexpr unsigned char GLYPH_CACHE_MAGIC[4] = {'D', 'D', 'G', 'C'};
+static constexpr unsigned GLYPH_CACHE_VERSION = 1;
+static constexpr size_t GLYPH_CACHE_MAX_SIZE = 32 * 1024 * 1024;
+
+class CGlyphCacheWriter
+{
+	std::vector<uint8_t> &m_vData;
+
+public:
+	CGlyphCacheWriter(std::vector<uint8_t> &vData) :
+		m_vData(vData) {}
+
+	void Write(unsigned Value, int Bytes)
+	{
+		for(int i = 0; i < Bytes; i++)
+			m_vData.push_back((Value >> (i * 8)) & 0xff);
+	}
+
+	void WriteRaw(const void *pData, size_t Size)
+	{
+		const uint8_t *pBytes = static_cast<const uint8_t *>(pData);
+		m_vData.insert(m_vData.end(), pBytes, pBytes + Size);
+	}
+};
+
+class CGlyphCacheReader
+{
+	const uint8_t *m_pData;
+	size_t m_Size;
+	size_t m_Offset = 0;
+	bool m_Error = false;
+
+public:
+	CGlyphCacheReader(const void *pData, size_t Size) :
+		m_pData(static_cast<const uint8_t *>(pData)), m_Size(Size) {}
+
+	bool Error() const { return m_Error; }
+
+	unsigned Read(int Bytes)
+	{
+		if(m_Error || m_Size - m_Offset < (size_t)Bytes)
+		{
+			m_Error = true;
+			return 0;
+		}
+		unsigned Value = 0;
+		for(int i = 0; i < Bytes; i++)
+			Value |= (unsigned)m_pData[m_Offset++] << (i * 8);
+		return Value;
+	}
+
+	int ReadSigned16() { return (int16_t)Read(2); }
+
+	const uint8_t *ReadRaw(size_t Size)
+	{
+		if(m_Error || m_Size - m_Offset < Size)
+		{
+			m_Error = true;
+			return nullptr;
+		}
+		const uint8_t *pData = m_pData + m_Offset;
+		m_Offset += Size;
+		return pData;
+	}
+};
+
+/**
+ * Loads the glyph cache and renders the glyphs of the most used font sizes
+ * for the characters of the current language in the background, so they
+ * only need to be placed in the atlas when they are first used.
+ */
+class CGlyphPrewarmJob : public IJob
+{
+	/**
+	 * Upper limit for the number of glyphs prepared by one job.
+	 */
+	static constexpr size_t MAX_GLYPHS = 8192;
+
+	/**
+	 * Number of font sizes to prewarm.
+	 */
+	static constexpr size_t NUM_FONT_SIZES = 3;
+
+	CLock m_Lock;
+	bool m_Detached = false;
+
+	std::unordered_set<uint64_t> m_PreparedKeys;
+
+	static uint64_t GlyphKey(int FaceId, int Chr, int FontSize)
+	{
+		return ((uint64_t)FaceId << 40) | ((uint64_t)(unsigned)Chr << 8) | (uint64_t)(FontSize & 0xff);
+	}
+
+	bool Aborted() const
+	{
+		return State() == IJob::STATE_ABORTED;
+	}
+
+	void AddGlyph(SRasterizedGlyph &&Glyph)
+	{
+		if(m_PreparedKeys.insert(GlyphKey(Glyph.m_FaceId, Glyph.m_Chr, Glyph.m_FontSize)).second)
+			m_vGlyphs.push_back(std::move(Glyph));
+	}
+
+	int FindFaceId(int FontFile, int FaceIndex) const
+	{
+		for(size_t FaceId = 0; FaceId < m_vFaceSources.size(); FaceId++)
+		{
+			if(m_vFaceSources[FaceId].m_FontFile == FontFile && m_vFaceSources[FaceId].m_FaceIndex == FaceIndex)
+				return FaceId;
+		}
+		return -1;
+	}
+
+	void LoadCache(std::vector<int> &vCachedSizeUsage)
+	{
+		void *pFileData;
+		unsigned FileSize;
+		if(!m_pStorage->ReadFile(GLYPH_CACHE_FILENAME, IStorage::TYPE_SAVE, &pFileData, &FileSize))
+			return;
+
+		CGlyphCacheReader Reader(pFileData, FileSize);
+		const uint8_t *pMagic = Reader.ReadRaw(sizeof(GLYPH_CACHE_MAGIC));
+		if(pMagic == nullptr || mem_comp(pMagic, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC)) != 0 || Reader.Read(4) != GLYPH_CACHE_VERSION)
+		{
+			log_debug("textrender", "Ignoring glyph cache with unknown format");
+			free(pFileData);
+			return;
+		}
+
+		// map the font files of the cache to the currently loaded ones
+		std::vector<int> vFontFiles(Reader.Read(2), -1);
+		for(int &FontFile : vFontFiles)
+		{
+			const uint8_t *pHash = Reader.ReadRaw(sizeof(SHA256_DIGEST));
+			if(pHash == nullptr)
+				break;
+			for(size_t i = 0; i < m_vFontHashes.size(); i++)
+			{
+				if(mem_comp(pHash, m_vFontHashes[i].data, sizeof(m_vFontHashes[i].data)) == 0)
+					FontFile = i;
+			}
+		}
+
+		const unsigned NumEntries = Reader.Read(4);
+		for(unsigned Entry = 0; Entry < NumEntries && !Reader.Error() && !Aborted() && m_vGlyphs.size() < MAX_GLYPHS; Entry++)
+		{
+			const unsigned FontFile = Reader.Read(2);
+			const int FaceIndex = Reader.Read(2);
+			SRasterizedGlyph Glyph;
+			Glyph.m_Chr = Reader.Read(4);
+			Glyph.m_GlyphIndex = Reader.Read(4);
+			Glyph.m_FontSize = Reader.Read(1);
+			Glyph.m_Width = Reader.ReadSigned16();
+			Glyph.m_Height = Reader.ReadSigned16();
+			Glyph.m_CharWidth = Reader.ReadSigned16();
+			Glyph.m_CharHeight = Reader.ReadSigned16();
+			Glyph.m_OffsetX = Reader.ReadSigned16();
+			Glyph.m_OffsetY = Reader.ReadSigned16();
+			Glyph.m_AdvanceX = Reader.ReadSigned16();
+			if(Glyph.m_Width < 0 || Glyph.m_Height < 0)
+				break;
+			const size_t PixelCount = (size_t)Glyph.m_Width * Glyph.m_Height;
+			const uint8_t *pFill = Reader.ReadRaw(PixelCount);
+			if(pFill == nullptr)
+				break;
+
+			Glyph.m_FaceId = FontFile < vFontFiles.size() && vFontFiles[FontFile] >= 0 ? FindFaceId(vFontFiles[FontFile], FaceIndex) : -1;
+			if(Glyph.m_FaceId < 0)
+				continue;
+
+			vCachedSizeUsage[Glyph.m_FontSize]++;
+			if(PixelCount > 0)
+			{
+				Glyph.m_vFill.assign(pFill, pFill + PixelCount);
+				Glyph.GrowOutline();
+			}
+			AddGlyph(std::move(Glyph));
+		}
+
+		log_debug("textrender", "Loaded %" PRIzu " glyphs from glyph cache", m_vGlyphs.size());
+		free(pFileData);
+	}
+
+	void CollectCharacters(std::vector<int> &vCharacters) const
+	{
+		// Basic Latin and Latin-1 Supplement
+		for(int Chr = 0x20; Chr < 0x7f; Chr++)
+			vCharacters.push_back(Chr);
+		for(int Chr = 0xa0; Chr <= 0xff; Chr++)
+			vCharacters.push_back(Chr);
+
+		if(m_aLanguageFile[0] == '\0')
+			return;
+		char *pLanguage = m_pStorage->ReadFileStr(m_aLanguageFile, IStorage::TYPE_ALL);
+		if(pLanguage == nullptr)
+			return;
+		std::unordered_set<int> Seen(vCharacters.begin(), vCharacters.end());
+		const char *pCursor = pLanguage;
+		while(int Chr = str_utf8_decode(&pCursor))
+		{
+			if(Chr > 0x20 && Seen.insert(Chr).second)
+				vCharacters.push_back(Chr);
+		}
+		free(pLanguage);
+	}
+
+	void Prewarm(const std::vector<FT_Face> &vFaces, const std::vector<int> &vFontSizes)
+	{
+		std::vector<int> vCharacters;
+		CollectCharacters(vCharacters);
+
+		for(int FontSize : vFontSizes)
+		{
+			for(int Chr : vCharacters)
+			{
+				if(Aborted() || m_vGlyphs.size() >= MAX_GLYPHS)
+					return;
+
+				// same lookup order as the glyph map, the replacement character is not prewarmed
+				for(int FaceId : m_vLookupFaces)
+				{
+					FT_Face Face = vFaces[FaceId];
+					if(!Face || !Face->charmap)
+						continue;
+					const FT_UInt GlyphIndex = FT_Get_Char_Index(Face, (FT_ULong)Chr);
+					if(GlyphIndex == 0)
+						continue;
+					if(m_PreparedKeys.count(GlyphKey(FaceId, Chr, FontSize)) == 0)
+					{
+						SRasterizedGlyph Glyph;
+						if(RasterizeGlyph(Face, GlyphIndex, Chr, FontSize, Glyph))
+						{
+							Glyph.m_FaceId = FaceId;
+							AddGlyph(std::move(Glyph));
+						}
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	void Run() override
+	{
+		const CLockScope LockScope(m_Lock);
+		if(m_Detached)
+			return;
+
+		if(m_vFontHashes.empty())
+			m_vFontHashes = HashFontFiles(m_vFaceSources);
+
+		// the font sizes which were used the most this session, otherwise the ones used the most last time
+		std::vector<int> vCachedSizeUsage(256, 0);
+		if(m_LoadCache)
+			LoadCache(vCachedSizeUsage);
+		std::vector<int> vFontSizes = m_vFontSizes;
+		while(vFontSizes.size() < NUM_FONT_SIZES)
+		{
+			const auto MostUsed = std::max_element(vCachedSizeUsage.begin(), vCachedSizeUsage.end());
+			if(*MostUsed == 0)
+				break;
+			*MostUsed = 0;
+			const int FontSize = MostUsed - vCachedSizeUsage.begin();
+			if(std::find(vFontSizes.begin(), vFontSizes.end(), FontSize) == vFontSizes.end())
+				vFontSizes.push_back(FontSize);
+		}
+
+		// FreeType faces must not be used by multiple threads, so the job opens its own
+		FT_Library Library;
+		if(FT_Init_FreeType(&Library))
+			return;
+		std::vector<FT_Face> vFaces(m_vFaceSources.size(), nullptr);
+		for(size_t FaceId = 0; FaceId < m_vFaceSources.size(); FaceId++)
+		{
+			const SFontFaceSource &Source = m_vFaceSources[FaceId];
+			if(FT_New_Memory_Face(Library, Source.m_pFontData, Source.m_FontDataSize, Source.m_FaceIndex, &vFaces[FaceId]))
+				vFaces[FaceId] = nullptr;
+		}
+
+		Prewarm(vFaces, vFontSizes);
+
+		for(FT_Face Face : vFaces)
+		{
+			if(Face)
+				FT_Done_Face(Face);
+		}
+		FT_Done_FreeType(Library);
+	}
+
+public:
+	// Input, must not be changed after the job was added
+	IStorage *m_pStorage = nullptr;
+	std::vector<SFontFaceSource> m_vFaceSources;
+	// faces in the order they are looked up for a character, the selected face is skipped
+	std::vector<int> m_vLookupFaces;
+	std::vector<int> m_vFontSizes;
+	char m_aLanguageFile[IO_MAX_PATH_LENGTH] = "";
+	bool m_LoadCache = false;
+
+	// Output, only valid when the job is done, the hashes are computed if they are not set
+	std::vector<SHA256_DIGEST> m_vFontHashes;
+	std::vector<SRasterizedGlyph> m_vGlyphs;
+
+	CGlyphPrewarmJob()
+	{
+		Abortable(true);
+	}
+
+	/**
+	 * Aborts the job and waits until it no longer accesses the font data.
+	 */
+	void Detach()
+	{
+		Abort();
+		const CLockScope LockScope(m_Lock);
+		m_Detached = true;
+	}
+};
+
 class CGlyphMap
 {
 public:
@@ -342,6 +820,18 @@ private:
 	std::vector<FT_Face> m_vFallbackFaces;
 	std::vector<FT_Face> m_vFtFaces;
 
+	// Glyphs prepared in the background, placed in the atlas on first use
+	IEngine *m_pEngine;
+	IStorage *m_pStorage;
+	std::vector<SFontFaceSource> m_vFaceSources;
+	std::vector<SHA256_DIGEST> m_vFontHashes;
+	std::shared_ptr<CGlyphPrewarmJob> m_pPrewarmJob;
+	std::unordered_map<std::tuple<FT_Face, int, int>, SRasterizedGlyph, SGlyphKeyHash, SGlyphKeyEquals> m_PreparedGlyphs;
+	int m_aFontSizeUsage[MAX_FONT_SIZE + 1] = {0};
+	bool m_CacheLoaded = false;
+	bool m_PrewarmPending = false;
+	char m_aPendingLanguageFile[IO_MAX_PATH_LENGTH];
+
 	FT_Face GetFaceByName(const char *pFamilyName)
 	{
 		if(pFamilyName == nullptr || pFamilyName[0] == '\0')
@@ -468,43 +958,6 @@ private:
 		return GlyphIndex;
 	}
 
-	void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount) const
-	{
-		for(int y = 0; y < h; y++)
-		{
-			for(int x = 0; x < w; x++)
-			{
-				int c = pIn[y * w + x];
-
-				for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
-				{
-					for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
-					{
-						int GetX = x + sx;
-						int GetY = y + sy;
-						if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
-						{
-							int Index = GetY * w + GetX;
-							float Mask = 1.f - std::clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
-							c = maximum(c, int(pIn[Index] * Mask));
-						}
-					}
-				}
-
-				pOut[y * w + x] = c;
-			}
-		}
-	}
-
-	int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize) const
-	{
-		if(FontSize > 48)
-			OutlineThickness *= 4;
-		else if(FontSize >= 18)
-			OutlineThickness *= 2;
-		return OutlineThickness;
-	}
-
 	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, uint8_t *pData)
 	{
 		for(size_t y = 0; y < Height; ++y)
@@ -519,39 +972,10 @@ private:
 		return m_TextureAtlas.Add(Width, Height, PosX, PosY);
 	}
 
-	bool RenderGlyph(SGlyph &Glyph)
+	bool PlaceGlyph(SGlyph &Glyph, const SRasterizedGlyph &Rasterized)
 	{
-		FT_Set_Pixel_Sizes(Glyph.m_Face, 0, Glyph.m_FontSize);
-
-		if(FT_Load_Glyph(Glyph.m_Face, Glyph.m_GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
-		{
-			log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
-			return false;
-		}
-
-		const FT_Bitmap *pBitmap = &Glyph.m_Face->glyph->bitmap;
-		if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
-		{
-			log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Glyph.m_Chr, Glyph.m_GlyphIndex, pBitmap->pixel_mode);
-			return false;
-		}
-
-		const unsigned RealWidth = pBitmap->width;
-		const unsigned RealHeight = pBitmap->rows;
-
-		// adjust spacing
-		int OutlineThickness = 0;
-		int x = 0;
-		int y = 0;
-		if(RealWidth > 0)
-		{
-			OutlineThickness = AdjustOutlineThicknessToFontSize(1, Glyph.m_FontSize);
-			x += (OutlineThickness + 1);
-			y += (OutlineThickness + 1);
-		}
-
-		const unsigned Width = RealWidth + x * 2;
-		const unsigned Height = RealHeight + y * 2;
+		const size_t Width = Rasterized.m_Width;
+		const size_t Height = Rasterized.m_Height;
 
 		int X = 0;
 		int Y = 0;
@@ -569,15 +993,11 @@ private:
 			}
 
 			// prepare glyph data
-			const size_t GlyphDataSize = (size_t)Width * Height * sizeof(uint8_t);
+			const size_t GlyphDataSize = Width * Height * sizeof(uint8_t);
 			uint8_t *pGlyphDataFill = static_cast<uint8_t *>(malloc(GlyphDataSize));
 			uint8_t *pGlyphDataOutline = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			mem_zero(pGlyphDataFill, GlyphDataSize);
-			for(unsigned py = 0; py < pBitmap->rows; ++py)
-			{
-				mem_copy(&pGlyphDataFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
-			}
-			Grow(pGlyphDataFill, pGlyphDataOutline, Width, Height, OutlineThickness);
+			mem_copy(pGlyphDataFill, Rasterized.m_vFill.data(), GlyphDataSize);
+			mem_copy(pGlyphDataOutline, Rasterized.m_vOutline.data(), GlyphDataSize);
 
 			// upload the glyph
 			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, pGlyphDataFill);
@@ -588,11 +1008,11 @@ private:
 		{
 			Glyph.m_Height = Height;
 			Glyph.m_Width = Width;
-			Glyph.m_CharHeight = RealHeight;
-			Glyph.m_CharWidth = RealWidth;
-			Glyph.m_OffsetX = (Glyph.m_Face->glyph->metrics.horiBearingX >> 6);
-			Glyph.m_OffsetY = -((Glyph.m_Face->glyph->metrics.height >> 6) - (Glyph.m_Face->glyph->metrics.horiBearingY >> 6));
-			Glyph.m_AdvanceX = (Glyph.m_Face->glyph->advance.x >> 6);
+			Glyph.m_CharHeight = Rasterized.m_CharHeight;
+			Glyph.m_CharWidth = Rasterized.m_CharWidth;
+			Glyph.m_OffsetX = Rasterized.m_OffsetX;
+			Glyph.m_OffsetY = Rasterized.m_OffsetY;
+			Glyph.m_AdvanceX = Rasterized.m_AdvanceX;
 
 			Glyph.m_aUVs[0] = X;
 			Glyph.m_aUVs[1] = Y;
@@ -604,10 +1024,148 @@ private:
 		return true;
 	}
 
+	bool RenderGlyph(SGlyph &Glyph)
+	{
+		SRasterizedGlyph Rasterized;
+		if(!RasterizeGlyph(Glyph.m_Face, Glyph.m_GlyphIndex, Glyph.m_Chr, Glyph.m_FontSize, Rasterized))
+			return false;
+		return PlaceGlyph(Glyph, Rasterized);
+	}
+
+	int FaceId(FT_Face Face) const
+	{
+		const auto It = std::find(m_vFtFaces.begin(), m_vFtFaces.end(), Face);
+		return Face == nullptr || It == m_vFtFaces.end() ? -1 : It - m_vFtFaces.begin();
+	}
+
+	void UpdatePrewarm()
+	{
+		if(!m_pPrewarmJob || !m_pPrewarmJob->Done())
+			return;
+
+		if(m_pPrewarmJob->State() == IJob::STATE_DONE)
+		{
+			m_vFontHashes = std::move(m_pPrewarmJob->m_vFontHashes);
+			m_PreparedGlyphs.clear();
+			for(SRasterizedGlyph &Prepared : m_pPrewarmJob->m_vGlyphs)
+			{
+				const auto Key = std::make_tuple(m_vFtFaces[Prepared.m_FaceId], Prepared.m_Chr, Prepared.m_FontSize);
+				const auto GlyphIt = m_Glyphs.find(Key);
+				if(GlyphIt == m_Glyphs.end() || GlyphIt->second.m_State == SGlyph::EState::UNINITIALIZED)
+					m_PreparedGlyphs.emplace(Key, std::move(Prepared));
+			}
+			log_debug("textrender", "Prepared %" PRIzu " glyphs in the background", m_PreparedGlyphs.size());
+		}
+		m_pPrewarmJob = nullptr;
+
+		if(m_PrewarmPending)
+		{
+			m_PrewarmPending = false;
+			StartPrewarm(m_aPendingLanguageFile);
+		}
+	}
+
+	bool PlacePreparedGlyph(SGlyph &Glyph)
+	{
+		m_aFontSizeUsage[Glyph.m_FontSize]++;
+		UpdatePrewarm();
+
+		const auto It = m_PreparedGlyphs.find(std::make_tuple(Glyph.m_Face, Glyph.m_Chr, Glyph.m_FontSize));
+		if(It == m_PreparedGlyphs.end())
+			return false;
+		const bool Placed = It->second.m_GlyphIndex == Glyph.m_GlyphIndex && PlaceGlyph(Glyph, It->second);
+		m_PreparedGlyphs.erase(It);
+		return Placed;
+	}
+
+	void SaveCache()
+	{
+		if(m_vFaceSources.empty())
+			return;
+		if(m_vFontHashes.size() != (size_t)m_vFaceSources.back().m_FontFile + 1)
+			m_vFontHashes = HashFontFiles(m_vFaceSources);
+
+		std::vector<uint8_t> vData;
+		CGlyphCacheWriter Writer(vData);
+		Writer.WriteRaw(GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC));
+		Writer.Write(GLYPH_CACHE_VERSION, 4);
+		Writer.Write(m_vFontHashes.size(), 2);
+		for(const SHA256_DIGEST &Hash : m_vFontHashes)
+			Writer.WriteRaw(Hash.data, sizeof(Hash.data));
+		const size_t NumEntriesOffset = vData.size();
+		Writer.Write(0, 4);
+
+		unsigned NumEntries = 0;
+		auto &&WriteEntry = [&](int Id, int Chr, FT_UInt GlyphIndex, int FontSize, const int (&aMetrics)[7], const uint8_t *pFill, size_t Stride) {
+			const size_t Width = aMetrics[0];
+			const size_t Height = aMetrics[1];
+			if(vData.size() + Width * Height > GLYPH_CACHE_MAX_SIZE)
+				return;
+			Writer.Write(m_vFaceSources[Id].m_FontFile, 2);
+			Writer.Write(m_vFaceSources[Id].m_FaceIndex, 2);
+			Writer.Write(Chr, 4);
+			Writer.Write(GlyphIndex, 4);
+			Writer.Write(FontSize, 1);
+			for(int Metric : aMetrics)
+				Writer.Write(Metric, 2);
+			for(size_t y = 0; y < Height; ++y)
+				Writer.WriteRaw(&pFill[y * Stride], Width);
+			NumEntries++;
+		};
+
+		// glyphs used this session first, then prepared ones which were not used yet
+		for(const auto &[Key, Glyph] : m_Glyphs)
+		{
+			// skip copies of the replacement character
+			if(Glyph.m_State != SGlyph::EState::RENDERED || Glyph.m_Face != std::get<0>(Key) || Glyph.m_Chr != std::get<1>(Key))
+				continue;
+			const int Id = FaceId(Glyph.m_Face);
+			if(Id < 0)
+				continue;
+			const int aMetrics[] = {(int)Glyph.m_Width, (int)Glyph.m_Height, (int)Glyph.m_CharWidth, (int)Glyph.m_CharHeight, (int)Glyph.m_OffsetX, (int)Glyph.m_OffsetY, (int)Glyph.m_AdvanceX};
+			const size_t Offset = (size_t)Glyph.m_aUVs[1] * m_TextureDimension + (size_t)Glyph.m_aUVs[0];
+			WriteEntry(Id, Glyph.m_Chr, Glyph.m_GlyphIndex, Glyph.m_FontSize, aMetrics, &m_apTextureData[FONT_TEXTURE_FILL][Offset], m_TextureDimension);
+		}
+		for(const auto &[Key, Prepared] : m_PreparedGlyphs)
+		{
+			const int aMetrics[] = {Prepared.m_Width, Prepared.m_Height, Prepared.m_CharWidth, Prepared.m_CharHeight, Prepared.m_OffsetX, Prepared.m_OffsetY, Prepared.m_AdvanceX};
+			WriteEntry(Prepared.m_FaceId, Prepared.m_Chr, Prepared.m_GlyphIndex, Prepared.m_FontSize, aMetrics, Prepared.m_vFill.data(), Prepared.m_Width);
+		}
+		for(int i = 0; i < 4; i++)
+			vData[NumEntriesOffset + i] = (NumEntries >> (i * 8)) & 0xff;
+
+		char aTempFilename[IO_MAX_PATH_LENGTH];
+		IStorage::FormatTmpPath(aTempFilename, sizeof(aTempFilename), GLYPH_CACHE_FILENAME);
+		IOHANDLE File = m_pStorage->OpenFile(aTempFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(!File)
+		{
+			log_error("textrender", "Failed to open '%s' for writing", aTempFilename);
+			return;
+		}
+		const bool Written = io_write(File, vData.data(), vData.size()) == vData.size();
+		io_close(File);
+		if(!Written)
+		{
+			log_error("textrender", "Failed to write '%s'", aTempFilename);
+			m_pStorage->RemoveFile(aTempFilename, IStorage::TYPE_SAVE);
+			return;
+		}
+		// Replaces the old cache, which stays intact if this fails
+		if(!m_pStorage->RenameFile(aTempFilename, GLYPH_CACHE_FILENAME, IStorage::TYPE_SAVE))
+		{
+			log_error("textrender", "Failed to rename '%s' to '%s'", aTempFilename, GLYPH_CACHE_FILENAME);
+			m_pStorage->RemoveFile(aTempFilename, IStorage::TYPE_SAVE);
+			return;
+		}
+		log_debug("textrender", "Saved %u glyphs to glyph cache", NumEntries);
+	}
+
 public:
-	CGlyphMap(IGraphics *pGraphics)
+	CGlyphMap(IGraphics *pGraphics, IEngine *pEngine, IStorage *pStorage)
 	{
 		m_pGraphics = pGraphics;
+		m_pEngine = pEngine;
+		m_pStorage = pStorage;
 		for(auto &pTextureData : m_apTextureData)
 		{
 			pTextureData = new uint8_t[m_TextureDimension * m_TextureDimension];
@@ -639,11 +1197,76 @@ public:
 		return m_IconFace;
 	}
 
-	void AddFace(FT_Face Face)
+	void AddFace(FT_Face Face, const FT_Byte *pFontData, FT_Long FontDataSize)
 	{
+		SFontFaceSource Source;
+		Source.m_pFontData = pFontData;
+		Source.m_FontDataSize = FontDataSize;
+		Source.m_FaceIndex = Face->face_index;
+		Source.m_FontFile = m_vFaceSources.empty() ? 0 : m_vFaceSources.back().m_FontFile + (m_vFaceSources.back().m_pFontData != pFontData ? 1 : 0);
+		m_vFaceSources.push_back(Source);
 		m_vFtFaces.push_back(Face);
 	}
 
+	void StartPrewarm(const char *pLanguageFile)
+	{
+		if(m_pEngine == nullptr || m_vFaceSources.empty())
+			return;
+		if(m_pPrewarmJob)
+		{
+			// only one job at a time, it has to be done before the next can start
+			str_copy(m_aPendingLanguageFile, pLanguageFile);
+			m_PrewarmPending = true;
+			return;
+		}
+
+		m_pPrewarmJob = std::make_shared<CGlyphPrewarmJob>();
+		m_pPrewarmJob->m_pStorage = m_pStorage;
+		m_pPrewarmJob->m_vFaceSources = m_vFaceSources;
+		for(FT_Face Face : {m_DefaultFace, m_VariantFace})
+		{
+			if(FaceId(Face) >= 0)
+				m_pPrewarmJob->m_vLookupFaces.push_back(FaceId(Face));
+		}
+		for(FT_Face Face : m_vFallbackFaces)
+		{
+			if(FaceId(Face) >= 0)
+				m_pPrewarmJob->m_vLookupFaces.push_back(FaceId(Face));
+		}
+
+		std::vector<int> vUsedFontSizes;
+		for(int FontSize = MIN_FONT_SIZE; FontSize <= MAX_FONT_SIZE; FontSize++)
+		{
+			if(m_aFontSizeUsage[FontSize] > 0)
+				vUsedFontSizes.push_back(FontSize);
+		}
+		std::sort(vUsedFontSizes.begin(), vUsedFontSizes.end(), [&](int Lhs, int Rhs) { return m_aFontSizeUsage[Lhs] > m_aFontSizeUsage[Rhs]; });
+		vUsedFontSizes.resize(minimum<size_t>(vUsedFontSizes.size(), 3));
+		m_pPrewarmJob->m_vFontSizes = vUsedFontSizes;
+
+		str_copy(m_pPrewarmJob->m_aLanguageFile, pLanguageFile);
+		// the cache only needs to be loaded once
+		m_pPrewarmJob->m_LoadCache = g_Config.m_TcGlyphCache && !m_CacheLoaded;
+		m_CacheLoaded = true;
+		if(m_vFontHashes.size() == (size_t)m_vFaceSources.back().m_FontFile + 1)
+			m_pPrewarmJob->m_vFontHashes = m_vFontHashes;
+		m_pEngine->AddJob(m_pPrewarmJob);
+	}
+
+	void Shutdown()
+	{
+		m_PrewarmPending = false;
+		UpdatePrewarm();
+		if(m_pPrewarmJob)
+		{
+			m_pPrewarmJob->Detach();
+			m_pPrewarmJob = nullptr;
+		}
+
+		if(g_Config.m_TcGlyphCache)
+			SaveCache();
+	}
+
 	bool SetDefaultFaceByName(const char *pFamilyName)
 	{
 		m_DefaultFace = GetFaceByName(pFamilyName);
@@ -749,12 +1372,12 @@ public:
 		else if(Glyph.m_State == SGlyph::EState::ERROR)
 			return nullptr;
 
-		// Else, render it.
+		// Else, use the glyph prepared in the background or render it.
 		Glyph.m_FontSize = FontSize;
 		Glyph.m_Face = Face;
 		Glyph.m_Chr = Chr;
 		Glyph.m_GlyphIndex = GlyphIndex;
-		if(RenderGlyph(Glyph))
+		if(PlacePreparedGlyph(Glyph) || RenderGlyph(Glyph))
 			return &Glyph;
 
 		// Use replacement character if the glyph could not be rendered,
@@ -1089,7 +1712,7 @@ class CTextRender : public IEngineTextRender
 				continue;
 			}
 
-			m_pGlyphMap->AddFace(FtFace);
+			m_pGlyphMap->AddFace(FtFace, pFontData, FontDataSize);
 
 			log_debug("textrender", "Loaded font face %ld '%s %s' from font file '%s'", FaceIndex, FtFace->family_name, FtFace->style_name, pFontName);
 			LoadedAny = true;
@@ -1138,7 +1761,7 @@ public:
 		m_pGraphics = Kernel()->RequestInterface<IGraphics>();
 		m_pStorage = Kernel()->RequestInterface<IStorage>();
 		FT_Init_FreeType(&m_FTLibrary);
-		m_pGlyphMap = new CGlyphMap(m_pGraphics);
+		m_pGlyphMap = new CGlyphMap(m_pGraphics, Kernel()->RequestInterface<IEngine>(), m_pStorage);
 
 		// print freetype version
 		{
@@ -1183,6 +1806,7 @@ public:
 			delete pTextCont;
 		m_vpTextContainers.clear();
 
+		m_pGlyphMap->Shutdown();
 		delete m_pGlyphMap;
 		m_pGlyphMap = nullptr;
 
@@ -1452,10 +2076,12 @@ public:
 			if(str_comp(pLanguageFile, Variant.m_aLanguageFile) == 0)
 			{
 				m_pGlyphMap->SetVariantFaceByName(Variant.m_aFamilyName);
+				m_pGlyphMap->StartPrewarm(pLanguageFile);
 				return;
 			}
 		}
 		m_pGlyphMap->SetVariantFaceByName(nullptr);
+		m_pGlyphMap->StartPrewarm(pLanguageFile);
 	}
 
 	void Text(float x, float y, float FontSize, const char *pText, float LineWidth = -1.0f) override
@@ -50,10 +50,15 @@
 #include <chrono>
 #include <vector>
 
-static std::unique_ptr<CHttpRequest> CreateWebhookFileRequest(const char *pUrl, const char *pJsonPayload, const char *pFilename, const unsigned char *pFileData, size_t FileSize);
+static std::unique_ptr<CHttpRequest> CreateWebhookFileRequest(const char *pUrl, const char *pJsonPayload, const char *pFilename, IOHANDLE File, size_t FileSize);
 
 using namespace std::chrono_literals;
 
+static constexpr int HOOK_DEMO_UPLOAD_MAX_RUNNING = 2;
+static constexpr int HOOK_DEMO_UPLOAD_MAX_ATTEMPTS = 3;
+static constexpr int HOOK_DEMO_UPLOAD_MAX_QUEUED = 16;
+static constexpr int64_t HOOK_DEMO_UPLOAD_MAX_SIZE = 25LL * 1024 * 1024;
+
 #if defined(CONF_PLATFORM_ANDROID)
 extern std::vector<std::string> FetchAndroidServerCommandQueue();
 #endif
@@ -306,6 +311,8 @@ bool CServer::StartHookSpamDemoRecord(int ClientId, float HooksPerSecond)
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", "Failed to start hook demo recorder.");
 		return false;
 	}
+	// include what happened before the trigger
+	m_HookDemoBuffer.Write(*pRecorder);
 
 	CHookDemoSession Session;
 	Session.m_Type = CHookDemoSession::EType::HOOK_SPAM;
@@ -388,6 +395,7 @@ bool CServer::StartReportDemoRecord(int ReporterId, int TargetId, const char *pR
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "report_demo", "Failed to start report demo recorder.");
 		return false;
 	}
+	m_HookDemoBuffer.Write(*pRecorder);
 
 	CHookDemoSession Session;
 	Session.m_Type = CHookDemoSession::EType::REPORT;
@@ -431,34 +439,38 @@ bool CServer::StartReportDemoRecord(int ReporterId, int TargetId, const char *pR
 
 bool CServer::HookDemoRecordingActive() const
 {
-	for(const auto &Session : m_vHookDemoSessions)
-	{
-		if(Session.m_pRecorder && Session.m_pRecorder->IsRecording())
-			return true;
-	}
-	return false;
+	// the buffer runs whenever a session could be started, so it already holds the time before the trigger
+	return g_Config.m_SvAntiHookWebhookUrl[0] != '\0' || g_Config.m_SvReportWebhookUrl[0] != '\0' || !m_vHookDemoSessions.empty();
 }
 
 void CServer::RecordHookDemoSnapshot(int Tick, const char *pData, int Size)
 {
+	// encoded once, the sessions only copy the chunks
+	m_HookDemoBuffer.RecordSnapshot(Tick, pData, Size, g_Config.m_SvHookDemoPreTrigger * TickSpeed());
 	for(auto &Session : m_vHookDemoSessions)
 	{
 		if(Session.m_pRecorder && Session.m_pRecorder->IsRecording())
-			Session.m_pRecorder->RecordSnapshot(Tick, pData, Size);
+			m_HookDemoBuffer.WriteLast(*Session.m_pRecorder);
 	}
 }
 
 void CServer::RecordHookDemoMessage(const void *pData, int Size)
 {
+	if(!HookDemoRecordingActive())
+		return;
+
+	m_HookDemoBuffer.RecordMessage(pData, Size);
 	for(auto &Session : m_vHookDemoSessions)
 	{
 		if(Session.m_pRecorder && Session.m_pRecorder->IsRecording())
-			Session.m_pRecorder->RecordMessage(pData, Size);
+			m_HookDemoBuffer.WriteLast(*Session.m_pRecorder);
 	}
 }
 
 void CServer::ProcessHookDemoSessions()
 {
+	if(!HookDemoRecordingActive())
+		m_HookDemoBuffer.Reset();
 	if(m_vHookDemoSessions.empty())
 		return;
 
@@ -478,6 +490,7 @@ void CServer::ProcessHookDemoSessions()
 
 void CServer::AbortHookDemoSessions()
 {
+	m_HookDemoBuffer.Reset();
 	if(m_vHookDemoSessions.empty())
 		return;
 
@@ -514,31 +527,9 @@ bool CServer::QueueHookDemoUpload(const CHookDemoSession &Session)
 		pWebhookUrl = g_Config.m_SvReportWebhookUrl;
 	}
 
-	IOHANDLE File = Storage()->OpenFile(Session.m_aFilename, IOFLAG_READ, IStorage::TYPE_SAVE);
-	if(!File)
-	{
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", "Failed to open hook demo for upload.");
-		Storage()->RemoveFile(Session.m_aFilename, IStorage::TYPE_SAVE);
-		return false;
-	}
-
-	const int64_t FileSize = io_length(File);
-	if(FileSize <= 0 || FileSize > 25LL * 1024 * 1024)
-	{
-		char aBuf[160];
-		str_format(aBuf, sizeof(aBuf), "Skipping hook demo upload, invalid size (%lld bytes).", (long long)FileSize);
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", aBuf);
-		io_close(File);
-		Storage()->RemoveFile(Session.m_aFilename, IStorage::TYPE_SAVE);
-		return false;
-	}
-
-	std::vector<unsigned char> vData(static_cast<size_t>(FileSize));
-	const int BytesRead = io_read(File, vData.data(), static_cast<unsigned>(vData.size()));
-	io_close(File);
-	if(BytesRead != (int)vData.size())
+	if(m_vHookDemoUploads.size() >= (size_t)HOOK_DEMO_UPLOAD_MAX_QUEUED)
 	{
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", "Failed to read hook demo for upload.");
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", "Skipping hook demo upload, too many uploads pending.");
 		Storage()->RemoveFile(Session.m_aFilename, IStorage::TYPE_SAVE);
 		return false;
 	}
@@ -546,13 +537,13 @@ bool CServer::QueueHookDemoUpload(const CHookDemoSession &Session)
 	const char *pServerName = g_Config.m_SvName[0] ? g_Config.m_SvName : "DDNet Server";
 	const char *pAddr = Session.m_aPlayerAddr[0] ? Session.m_aPlayerAddr : "알 수 없음";
 
-	char aJson[1472];
+	CHookDemoUpload &Upload = m_vHookDemoUploads.emplace_back();
 	if(Session.m_Type == CHookDemoSession::EType::HOOK_SPAM)
 	{
 		char aEscName[192];
 		EscapeJson(aEscName, sizeof(aEscName), Session.m_aPlayerName[0] ? Session.m_aPlayerName : "알 수 없음");
 
-		str_format(aJson, sizeof(aJson),
+		str_format(Upload.m_aPayloadJson, sizeof(Upload.m_aPayloadJson),
 			"{\"content\":\"%s님의 비정상적인 갈고리 사용에 대한 서버 데모가 도착했어요. 관리자분들은 확인 후 처리 부탁드립니다.\",\"username\":\"안티치트 로그\",\"allowed_mentions\":{\"parse\":[]}}",
 			aEscName[0] ? aEscName : "알 수 없음");
 	}
@@ -574,33 +565,190 @@ bool CServer::QueueHookDemoUpload(const CHookDemoSession &Session)
 		char aEscMessage[1024];
 		EscapeJson(aEscMessage, sizeof(aEscMessage), aMessage);
 
-		str_format(aJson, sizeof(aJson),
+		str_format(Upload.m_aPayloadJson, sizeof(Upload.m_aPayloadJson),
 			"{\"content\":\"신고 데모가 도착했어요!\\n%s\",\"allowed_mentions\":{\"parse\":[]}}",
 			aEscMessage);
 	}
 
-	const char *pUploadName = Session.m_aUploadName[0] ? Session.m_aUploadName : "hook-demo.demo";
-	auto pUniqueReq = CreateWebhookFileRequest(pWebhookUrl, aJson, pUploadName, vData.data(), vData.size());
-	if(!pUniqueReq)
+	str_copy(Upload.m_aUrl, pWebhookUrl);
+	str_copy(Upload.m_aFilename, Session.m_aFilename);
+	str_copy(Upload.m_aUploadName, Session.m_aUploadName[0] ? Session.m_aUploadName : "hook-demo.demo");
+	return true;
+}
+
+// reads the demo and posts it to the webhook, may block on the request for a while
+class CHookDemoUploadJob : public IJob
+{
+public:
+	enum class EResult
+	{
+		FAILED,
+		RETRY,
+		SUCCESS,
+	};
+
+private:
+	IStorage *m_pStorage;
+	IHttp *m_pHttp;
+	const CServer::CHookDemoUpload m_Upload;
+	CLock m_Lock;
+	bool m_Aborted GUARDED_BY(m_Lock) = false;
+	std::shared_ptr<CHttpRequest> m_pRequest GUARDED_BY(m_Lock);
+	EResult m_Result = EResult::FAILED;
+	float m_RetryAfter = 0.0f;
+
+	void Run() override REQUIRES(!m_Lock);
+
+public:
+	CHookDemoUploadJob(IStorage *pStorage, IHttp *pHttp, const CServer::CHookDemoUpload &Upload) :
+		m_pStorage(pStorage),
+		m_pHttp(pHttp),
+		m_Upload(Upload)
 	{
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", "Failed to create webhook request for hook demo upload.");
-		Storage()->RemoveFile(Session.m_aFilename, IStorage::TYPE_SAVE);
-		return false;
 	}
 
-	std::shared_ptr<IHttpRequest> pReq(
-		pUniqueReq.release(),
-		[](IHttpRequest *p) { delete static_cast<CHttpRequest *>(p); });
-	m_Http.Run(pReq);
+	// the job isn't marked as aborted, so Done() still waits until it stopped using the server
+	bool Abort() override REQUIRES(!m_Lock)
+	{
+		const CLockScope LockScope(m_Lock);
+		m_Aborted = true;
+		if(m_pRequest)
+			m_pRequest->Abort();
+		return true;
+	}
 
-	Storage()->RemoveFile(Session.m_aFilename, IStorage::TYPE_SAVE);
-	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "hook_demo", "Queued hook demo upload.");
-	return true;
+	EResult Result() const { return m_Result; }
+	float RetryAfter() const { return m_RetryAfter; }
+};
+
+void CHookDemoUploadJob::Run()
+{
+	IOHANDLE File = m_pStorage->OpenFile(m_Upload.m_aFilename, IOFLAG_READ, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		log_error("hook_demo", "failed to open '%s' for upload", m_Upload.m_aFilename);
+		return;
+	}
+
+	const int64_t FileSize = io_length(File);
+	if(FileSize <= 0 || FileSize > HOOK_DEMO_UPLOAD_MAX_SIZE)
+	{
+		log_error("hook_demo", "skipping upload of '%s', invalid size (%lld bytes)", m_Upload.m_aFilename, (long long)FileSize);
+		io_close(File);
+		return;
+	}
+
+	std::shared_ptr<CHttpRequest> pRequest = CreateWebhookFileRequest(m_Upload.m_aUrl, m_Upload.m_aPayloadJson, m_Upload.m_aUploadName, File, FileSize);
+	io_close(File);
+	if(!pRequest)
+	{
+		log_error("hook_demo", "failed to create webhook request for '%s'", m_Upload.m_aFilename);
+		return;
+	}
+	// keep the status code of failed requests to decide whether to try again
+	pRequest->FailOnErrorStatus(false);
+
+	{
+		const CLockScope LockScope(m_Lock);
+		if(m_Aborted)
+			return;
+		m_pRequest = pRequest;
+	}
+	m_pHttp->Run(pRequest);
+	pRequest->Wait();
+
+	if(pRequest->State() == EHttpState::ABORTED)
+		return;
+	if(pRequest->State() != EHttpState::DONE)
+	{
+		m_Result = EResult::RETRY;
+		return;
+	}
+	const int StatusCode = pRequest->StatusCode();
+	if(StatusCode >= 200 && StatusCode < 300)
+		m_Result = EResult::SUCCESS;
+	else if(StatusCode == 429 || StatusCode >= 500)
+	{
+		// rate limits and server errors may go away, anything else fails again
+		m_Result = EResult::RETRY;
+		m_RetryAfter = pRequest->ResultRetryAfter().value_or(0.0f);
+	}
+	else
+		log_error("hook_demo", "webhook rejected '%s' with status %d", m_Upload.m_aFilename, StatusCode);
+}
+
+void CServer::ProcessHookDemoUploads()
+{
+	const int64_t Now = time_get();
+	int NumRunning = 0;
+	for(auto It = m_vHookDemoUploads.begin(); It != m_vHookDemoUploads.end();)
+	{
+		CHookDemoUpload &Upload = *It;
+		if(!Upload.m_pJob)
+		{
+			++It;
+			continue;
+		}
+		if(!Upload.m_pJob->Done())
+		{
+			NumRunning++;
+			++It;
+			continue;
+		}
+
+		const CHookDemoUploadJob::EResult Result = Upload.m_pJob->Result();
+		const float RetryAfter = Upload.m_pJob->RetryAfter();
+		Upload.m_pJob = nullptr;
+		if(Result == CHookDemoUploadJob::EResult::RETRY && Upload.m_Attempts < HOOK_DEMO_UPLOAD_MAX_ATTEMPTS)
+		{
+			// back off exponentially unless the webhook says how long to wait
+			const int64_t Delay = RetryAfter > 0.0f ? (int64_t)(RetryAfter * time_freq()) : (time_freq() * 5) << (Upload.m_Attempts - 1);
+			Upload.m_NextAttempt = Now + Delay;
+			log_info("hook_demo", "upload of '%s' failed, trying again in %d seconds", Upload.m_aFilename, (int)(Delay / time_freq()));
+			++It;
+			continue;
+		}
+
+		if(Result == CHookDemoUploadJob::EResult::SUCCESS)
+			log_info("hook_demo", "uploaded '%s'", Upload.m_aFilename);
+		else
+			log_error("hook_demo", "giving up on uploading '%s'", Upload.m_aFilename);
+		Storage()->RemoveFile(Upload.m_aFilename, IStorage::TYPE_SAVE);
+		It = m_vHookDemoUploads.erase(It);
+	}
+
+	// start the oldest waiting uploads first
+	for(CHookDemoUpload &Upload : m_vHookDemoUploads)
+	{
+		if(NumRunning >= HOOK_DEMO_UPLOAD_MAX_RUNNING)
+			break;
+		if(Upload.m_pJob || Upload.m_NextAttempt > Now)
+			continue;
+		Upload.m_Attempts++;
+		Upload.m_pJob = std::make_shared<CHookDemoUploadJob>(Storage(), &m_Http, Upload);
+		Engine()->AddJob(Upload.m_pJob);
+		NumRunning++;
+	}
+}
+
+void CServer::AbortHookDemoUploads()
+{
+	for(CHookDemoUpload &Upload : m_vHookDemoUploads)
+	{
+		if(Upload.m_pJob)
+		{
+			Upload.m_pJob->Abort();
+			while(!Upload.m_pJob->Done())
+				thread_yield();
+		}
+		Storage()->RemoveFile(Upload.m_aFilename, IStorage::TYPE_SAVE);
+	}
+	m_vHookDemoUploads.clear();
 }
 
-static std::unique_ptr<CHttpRequest> CreateWebhookFileRequest(const char *pUrl, const char *pJsonPayload, const char *pFilename, const unsigned char *pFileData, size_t FileSize)
+static std::unique_ptr<CHttpRequest> CreateWebhookFileRequest(const char *pUrl, const char *pJsonPayload, const char *pFilename, IOHANDLE File, size_t FileSize)
 {
-	if(!pUrl || !pJsonPayload || !pFilename || !pFileData || FileSize == 0)
+	if(!pUrl || !pJsonPayload || !pFilename || !File || FileSize == 0)
 	{
 		return nullptr;
 	}
@@ -621,8 +769,11 @@ static std::unique_ptr<CHttpRequest> CreateWebhookFileRequest(const char *pUrl,
 			vBody.emplace_back(static_cast<unsigned char>(*p));
 		}
 	};
-	const auto AppendData = [&vBody](const unsigned char *pData, size_t Size) {
-		vBody.insert(vBody.end(), pData, pData + Size);
+	// read the file straight into the body
+	const auto AppendFile = [&vBody, File](size_t Size) {
+		const size_t Offset = vBody.size();
+		vBody.resize(Offset + Size);
+		return io_read(File, vBody.data() + Offset, Size) == Size;
 	};
 
 	AppendString("--");
@@ -634,8 +785,10 @@ static std::unique_ptr<CHttpRequest> CreateWebhookFileRequest(const char *pUrl,
 	AppendString("\r\nContent-Disposition: form-data; name=\"files[0]\"; filename=\"");
 	AppendString(pFilename);
 	AppendString("\"\r\nContent-Type: application/octet-stream\r\n\r\n");
-	if(pFileData && FileSize > 0)
-		AppendData(pFileData, FileSize);
+	if(!AppendFile(FileSize))
+	{
+		return nullptr;
+	}
 	AppendString("\r\n--");
 	AppendString(aBoundary);
 	AppendString("--\r\n");
@@ -1534,6 +1687,38 @@ void CServer::SendMsgRaw(int ClientId, const void *pData, int Size, int Flags)
 	m_NetServer.Send(&Packet);
 }
 
+// only touches the work items and the stored snapshots, which stay untouched until all deltas are done
+static void CreateSnapshotDeltas(CServer::CSnapshotWork *pWork, int Num)
+{
+	char aDeltaData[CSnapshot::MAX_SIZE];
+	for(int i = 0; i < Num; i++)
+	{
+		CServer::CSnapshotWork &Work = pWork[i];
+		Work.m_Crc = Work.m_pSnapshot->Crc();
+		const int DeltaSize = Work.m_pDelta->CreateDelta(Work.m_pDeltashot, Work.m_pSnapshot, aDeltaData);
+		Work.m_CompressedSize = DeltaSize ? (int)CVariableInt::Compress(aDeltaData, DeltaSize, Work.m_aCompData, sizeof(Work.m_aCompData)) : 0;
+	}
+}
+
+class CSnapshotDeltaJob : public IJob
+{
+	CServer::CSnapshotWork *m_pWork;
+	int m_Num;
+	CSemaphore *m_pDone;
+
+	void Run() override
+	{
+		CreateSnapshotDeltas(m_pWork, m_Num);
+		m_pDone->Signal();
+	}
+
+public:
+	CSnapshotDeltaJob(CServer::CSnapshotWork *pWork, int Num, CSemaphore *pDone) :
+		m_pWork(pWork), m_Num(Num), m_pDone(pDone)
+	{
+	}
+};
+
 void CServer::DoSnapshot()
 {
 	bool IsGlobalSnap = Config()->m_SvHighBandwidth || (m_CurrentGameTick % 2) == 0;
@@ -1557,6 +1742,10 @@ void CServer::DoSnapshot()
 			RecordHookDemoSnapshot(Tick(), aData, SnapshotSize);
 	}
 
+	if(m_vSnapshotWork.size() < (size_t)MaxClients())
+		m_vSnapshotWork.resize(MaxClients());
+	int NumWork = 0;
+
 	// create snapshots for all clients
 	for(int i = 0; i < MaxClients(); i++)
 	{
@@ -1593,8 +1782,6 @@ void CServer::DoSnapshot()
 				m_aDemoRecorder[i].RecordSnapshot(Tick(), aData, SnapshotSize);
 			}
 
-			int Crc = pData->Crc();
-
 			// remove old snapshots
 			// keep 3 seconds worth of snapshots
 			m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - TickSpeed() * 3);
@@ -1602,13 +1789,19 @@ void CServer::DoSnapshot()
 			// save the snapshot
 			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0, nullptr);
 
+			CSnapshotWork &Work = m_vSnapshotWork[NumWork++];
+			Work.m_ClientId = i;
+			Work.m_pDelta = m_aClients[i].m_Sixup ? &m_SnapshotDeltaSixup : &m_SnapshotDelta;
+			// the stored copy stays valid until the next purge, unlike aData
+			Work.m_pSnapshot = m_aClients[i].m_Snapshots.m_pLast->m_pSnap;
+
 			// find snapshot that we can perform delta against
-			int DeltaTick = -1;
-			const CSnapshot *pDeltashot = CSnapshot::EmptySnapshot();
+			Work.m_DeltaTick = -1;
+			Work.m_pDeltashot = CSnapshot::EmptySnapshot();
 			{
-				int DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, nullptr, &pDeltashot, nullptr);
+				int DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, nullptr, &Work.m_pDeltashot, nullptr);
 				if(DeltashotSize >= 0)
-					DeltaTick = m_aClients[i].m_LastAckedSnapshot;
+					Work.m_DeltaTick = m_aClients[i].m_LastAckedSnapshot;
 				else
 				{
 					// no acked package found, force client to recover rate
@@ -1616,64 +1809,90 @@ void CServer::DoSnapshot()
 						m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
 				}
 			}
+		}
+	}
 
-			// create delta
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
-			char aDeltaData[CSnapshot::MAX_SIZE];
-			int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+	// the event sizes differ between the protocols, keep one delta configuration for each.
+	// Set them after all demos of this tick are recorded, which use the 0.7 sizes
+	m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, false);
+	m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, false);
+	m_SnapshotDeltaSixup.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
+	m_SnapshotDeltaSixup.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
 
-			if(DeltaSize)
-			{
-				// compress it
-				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+	// create and compress the deltas, on the snapshot threads if there are enough clients to make it worth it
+	const int NumJobs = NumWork >= 8 ? std::min(m_NumSnapshotThreads, NumWork / 4) : 0;
+	if(NumJobs > 0)
+	{
+		// the main thread takes the first share itself
+		const int PerJob = (NumWork + NumJobs) / (NumJobs + 1);
+		std::vector<std::shared_ptr<CSnapshotDeltaJob>> vpJobs;
+		for(int First = PerJob; First < NumWork; First += PerJob)
+		{
+			vpJobs.push_back(std::make_shared<CSnapshotDeltaJob>(&m_vSnapshotWork[First], std::min(PerJob, NumWork - First), &m_SnapshotJobsDone));
+			m_SnapshotJobPool.Add(vpJobs.back());
+		}
+		CreateSnapshotDeltas(m_vSnapshotWork.data(), std::min(PerJob, NumWork));
+		for(size_t i = 0; i < vpJobs.size(); i++)
+			m_SnapshotJobsDone.Wait();
+	}
+	else
+	{
+		CreateSnapshotDeltas(m_vSnapshotWork.data(), NumWork);
+	}
 
-				char aCompData[CSnapshot::MAX_SIZE];
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
-				int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+	// send in client order from the main thread
+	for(int i = 0; i < NumWork; i++)
+		SendSnapshot(m_vSnapshotWork[i]);
 
-				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
-				{
-					int Chunk = Left < MaxSize ? Left : MaxSize;
-					Left -= Chunk;
+	if(IsGlobalSnap)
+	{
+		GameServer()->OnPostGlobalSnap();
+	}
+}
 
-					if(NumPackets == 1)
-					{
-						CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i);
-					}
-					else
-					{
-						CMsgPacker Msg(NETMSG_SNAP, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(NumPackets);
-						Msg.AddInt(n);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i);
-					}
-				}
+void CServer::SendSnapshot(const CSnapshotWork &Work)
+{
+	const int ClientId = Work.m_ClientId;
+	if(Work.m_CompressedSize)
+	{
+		const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+		int NumPackets = (Work.m_CompressedSize + MaxSize - 1) / MaxSize;
+
+		for(int n = 0, Left = Work.m_CompressedSize; Left > 0; n++)
+		{
+			int Chunk = Left < MaxSize ? Left : MaxSize;
+			Left -= Chunk;
+
+			if(NumPackets == 1)
+			{
+				CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
+				Msg.AddInt(m_CurrentGameTick);
+				Msg.AddInt(m_CurrentGameTick - Work.m_DeltaTick);
+				Msg.AddInt(Work.m_Crc);
+				Msg.AddInt(Chunk);
+				Msg.AddRaw(&Work.m_aCompData[n * MaxSize], Chunk);
+				SendMsg(&Msg, MSGFLAG_FLUSH, ClientId);
 			}
 			else
 			{
-				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+				CMsgPacker Msg(NETMSG_SNAP, true);
 				Msg.AddInt(m_CurrentGameTick);
-				Msg.AddInt(m_CurrentGameTick - DeltaTick);
-				SendMsg(&Msg, MSGFLAG_FLUSH, i);
+				Msg.AddInt(m_CurrentGameTick - Work.m_DeltaTick);
+				Msg.AddInt(NumPackets);
+				Msg.AddInt(n);
+				Msg.AddInt(Work.m_Crc);
+				Msg.AddInt(Chunk);
+				Msg.AddRaw(&Work.m_aCompData[n * MaxSize], Chunk);
+				SendMsg(&Msg, MSGFLAG_FLUSH, ClientId);
 			}
 		}
 	}
-
-	if(IsGlobalSnap)
+	else
 	{
-		GameServer()->OnPostGlobalSnap();
+		CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+		Msg.AddInt(m_CurrentGameTick);
+		Msg.AddInt(m_CurrentGameTick - Work.m_DeltaTick);
+		SendMsg(&Msg, MSGFLAG_FLUSH, ClientId);
 	}
 }
 
@@ -3578,6 +3797,10 @@ int CServer::Run()
 		g_UuidManager.DebugDump();
 	}
 
+	m_NumSnapshotThreads = Config()->m_SvSnapshotThreads;
+	if(m_NumSnapshotThreads > 0)
+		m_SnapshotJobPool.Init(m_NumSnapshotThreads);
+
 	{
 		int Size = GameServer()->PersistentClientDataSize();
 		for(auto &Client : m_aClients)
@@ -3847,6 +4070,7 @@ int CServer::Run()
 
 				m_Fifo.Update();
 				ProcessHookDemoSessions();
+				ProcessHookDemoUploads();
 
 #if defined(CONF_PLATFORM_ANDROID)
 				std::vector<std::string> vAndroidCommandQueue = FetchAndroidServerCommandQueue();
@@ -3991,6 +4215,7 @@ int CServer::Run()
 		}
 	}
 	AbortHookDemoSessions();
+	AbortHookDemoUploads();
 	const char *pDisconnectReason = "Server shutdown";
 	if(m_aShutdownReason[0])
 		pDisconnectReason = m_aShutdownReason;
@@ -4996,6 +5221,7 @@ void *CServer::SnapNewItem(int Type, int Id, int Size)
 void CServer::SnapSetStaticsize(int ItemType, int Size)
 {
 	m_SnapshotDelta.SetStaticsize(ItemType, Size);
+	m_SnapshotDeltaSixup.SetStaticsize(ItemType, Size);
 }
 
 CServer *CreateServer() { return new CServer(); }
@@ -9,6 +9,7 @@
 #include "snap_id_pool.h"
 
 #include <base/hash.h>
+#include <base/tl/threading.h>
 
 #include <engine/console.h>
 #include <engine/server.h>
@@ -16,6 +17,7 @@
 #include <engine/shared/econ.h>
 #include <engine/shared/fifo.h>
 #include <engine/shared/http.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/network.h>
 #include <engine/shared/protocol.h>
@@ -213,8 +215,27 @@ public:
 	CClient m_aClients[MAX_CLIENTS];
 	int m_aIdMap[MAX_CLIENTS * VANILLA_MAX_CLIENTS];
 
+	// delta and compression input and output of one client's snapshot, filled by the snapshot workers
+	class CSnapshotWork
+	{
+	public:
+		int m_ClientId;
+		int m_DeltaTick;
+		const CSnapshotDelta *m_pDelta;
+		const CSnapshot *m_pSnapshot;
+		const CSnapshot *m_pDeltashot;
+		int m_Crc;
+		int m_CompressedSize; // 0 if nothing changed
+		char m_aCompData[CSnapshot::MAX_SIZE];
+	};
+
 	CSnapshotDelta m_SnapshotDelta;
+	CSnapshotDelta m_SnapshotDeltaSixup;
 	CSnapshotBuilder m_SnapshotBuilder;
+	CJobPool m_SnapshotJobPool;
+	CSemaphore m_SnapshotJobsDone; // signaled once per finished delta job
+	int m_NumSnapshotThreads = 0;
+	std::vector<CSnapshotWork> m_vSnapshotWork;
 	CSnapIdPool m_IdPool;
 	CNetServer m_NetServer;
 	CEcon m_Econ;
@@ -300,6 +321,21 @@ public:
 		char m_aReportReason[256];
 	};
 	std::vector<CHookDemoSession> m_vHookDemoSessions;
+	// shared by all sessions, holds the ticks before they were started
+	CDemoRingBuffer m_HookDemoBuffer{&m_SnapshotDelta};
+	// a finished demo waiting to be uploaded, the tick thread only queues these
+	class CHookDemoUpload
+	{
+	public:
+		char m_aUrl[256];
+		char m_aPayloadJson[1472];
+		char m_aFilename[IO_MAX_PATH_LENGTH];
+		char m_aUploadName[IO_MAX_PATH_LENGTH];
+		int m_Attempts = 0;
+		int64_t m_NextAttempt = 0;
+		std::shared_ptr<class CHookDemoUploadJob> m_pJob;
+	};
+	std::vector<CHookDemoUpload> m_vHookDemoUploads;
 
 	std::shared_ptr<ILogger> m_pFileLogger = nullptr;
 	std::shared_ptr<ILogger> m_pStdoutLogger = nullptr;
@@ -361,6 +397,7 @@ public:
 	int SendMsg(CMsgPacker *pMsg, int Flags, int ClientId) override;
 
 	void DoSnapshot();
+	void SendSnapshot(const CSnapshotWork &Work);
 
 	static int NewClientCallback(int ClientId, void *pUser, bool Sixup);
 	static int NewClientNoAuthCallback(int ClientId, void *pUser);
@@ -558,6 +595,8 @@ public:
 	void ProcessHookDemoSessions();
 	void AbortHookDemoSessions();
 	bool QueueHookDemoUpload(const CHookDemoSession &Session);
+	void ProcessHookDemoUploads();
+	void AbortHookDemoUploads();
 
 #ifdef CONF_FAMILY_UNIX
 	enum CONN_LOGGING_CMD
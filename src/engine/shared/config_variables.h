@@ -427,6 +427,7 @@ MACRO_CONFIG_INT(GfxColorDepth, gfx_color_depth, 24, 16, 24, CFGFLAG_SAVE | CFGF
 MACRO_CONFIG_INT(GfxVsync, gfx_vsync, 0, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT, "Vertical sync (may cause delay)")
 MACRO_CONFIG_INT(GfxDisplayAllVideoModes, gfx_display_all_video_modes, 0, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT, "Show all video modes")
 MACRO_CONFIG_INT(GfxHighDetail, gfx_high_detail, 1, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT, "High detail")
+MACRO_CONFIG_INT(GfxMapRenderCache, gfx_map_render_cache, 1, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT, "Cache the prepared map render data on disk to load maps faster the next time")
 MACRO_CONFIG_INT(GfxFsaaSamples, gfx_fsaa_samples, 0, 0, 64, CFGFLAG_SAVE | CFGFLAG_CLIENT, "FSAA samples (may cause delay)")
 MACRO_CONFIG_INT(GfxRefreshRate, gfx_refresh_rate, 0, 0, 10000, CFGFLAG_SAVE | CFGFLAG_CLIENT, "Screen refresh rate")
 MACRO_CONFIG_INT(GfxBackgroundRender, gfx_backgroundrender, 1, 0, 1, CFGFLAG_SAVE | CFGFLAG_CLIENT, "Render graphics when window is in background")
@@ -462,6 +463,7 @@ MACRO_CONFIG_STR(SvMap, sv_map, 128, "Sunny Side Up", CFGFLAG_SERVER, "Map to us
 MACRO_CONFIG_STR(SvMapAutoCfg, sv_map_auto_cfg, 128, "", CFGFLAG_SERVER | CFGFLAG_SAVE, "CFG file to execute on every map change")
 MACRO_CONFIG_INT(SvMaxClients, sv_max_clients, SERVER_MAX_CLIENTS, 1, SERVER_MAX_CLIENTS, CFGFLAG_SERVER, "Maximum number of clients that are allowed on a server")
 MACRO_CONFIG_INT(SvMaxClientsPerIp, sv_max_clients_per_ip, 4, 1, SERVER_MAX_CLIENTS, CFGFLAG_SERVER, "Maximum number of clients with the same IP that can connect to the server")
+MACRO_CONFIG_INT(SvSnapshotThreads, sv_snapshot_threads, 2, 0, 16, CFGFLAG_SERVER, "Number of extra threads that delta compress the client snapshots (0 = main thread only, only read on server start)")
 MACRO_CONFIG_INT(SvHighBandwidth, sv_high_bandwidth, 0, 0, 1, CFGFLAG_SERVER, "Use high bandwidth mode. Doubles the bandwidth required for the server. LAN use only")
 MACRO_CONFIG_INT(SvPreInput, sv_preinput, 1, 0, 1, CFGFLAG_SERVER, "Sends client inputs to other clients before their correct tick. Increases the bandwidth required for the server")
 MACRO_CONFIG_STR(SvRegister, sv_register, 16, "1", CFGFLAG_SERVER, "Register server with master server for public listing, can also accept a comma-separated list of protocols to register on, like 'ipv4,ipv6'")
@@ -699,6 +701,7 @@ MACRO_CONFIG_STR(SvPersistentBansFile, sv_persistent_bans_file, 128, "storage/ba
 MACRO_CONFIG_STR(SvAntiHookWebhookUrl, sv_anti_hook_webhook_url, 256, "", CFGFLAG_SERVER | CFGFLAG_SAVE, "Discord webhook URL used for anti-hook spam notifications")
 MACRO_CONFIG_INT(SvAntiHookMonitor, sv_anti_hook_monitor, 1, 0, 1, CFGFLAG_SERVER | CFGFLAG_SAVE, "Enable automatic monitoring of abnormal hook usage")
 MACRO_CONFIG_INT(SvAntiHookClick, sv_anti_hook_click, 20, 1, 1000, CFGFLAG_SERVER | CFGFLAG_SAVE, "Number of hooks per 10 seconds considered as abnormal")
+MACRO_CONFIG_INT(SvHookDemoPreTrigger, sv_hook_demo_pre_trigger, 10, 0, 30, CFGFLAG_SERVER | CFGFLAG_SAVE, "Seconds before the trigger included in hook spam and report demos")
 MACRO_CONFIG_INT(SvDDRaceTuneReset, sv_ddrace_tune_reset, 1, 0, 1, CFGFLAG_SERVER, "Whether DDRace tuning (sv_hit, sv_endless_drag and sv_old_laser) is reset after each map change or not")
 MACRO_CONFIG_INT(SvNamelessScore, sv_nameless_score, 1, 0, 1, CFGFLAG_SERVER, "Whether nameless tee has a score or not")
 MACRO_CONFIG_INT(SvTimeInBroadcastInterval, sv_time_in_broadcast_interval, 1, 0, 60, CFGFLAG_SERVER, "How often to update the broadcast time")
@@ -28,6 +28,9 @@ MACRO_CONFIG_STR(UcTranslateTarget, uc_translate_target, 8, "en", CFGFLAG_CLIENT
 MACRO_CONFIG_STR(UcTranslateApi, uc_translate_api, 256, "", CFGFLAG_CLIENT | CFGFLAG_SAVE, "Custom translation API endpoint for chat translator")
 MACRO_CONFIG_STR(UcTranslateKey, uc_translate_key, 256, "", CFGFLAG_CLIENT | CFGFLAG_SAVE, "API key for the custom translation endpoint")
 MACRO_CONFIG_STR(UcTranslateBackend, uc_translate_backend, 16, "google", CFGFLAG_CLIENT | CFGFLAG_SAVE, "Translation backend (google, deepl)")
+MACRO_CONFIG_INT(UcTranslateBatchWindow, uc_translate_batch_window, 100, 0, 1000, CFGFLAG_CLIENT | CFGFLAG_SAVE, "Milliseconds to collect messages into one DeepL request, 0 to send right away")
+MACRO_CONFIG_INT(UcTranslateCache, uc_translate_cache, 1, 0, 1, CFGFLAG_CLIENT | CFGFLAG_SAVE, "Reuse previous translation results instead of sending the same text again")
+MACRO_CONFIG_INT(UcTranslateCacheSize, uc_translate_cache_size, 2048, 0, 65536, CFGFLAG_CLIENT | CFGFLAG_SAVE, "Maximum number of cached translations kept in memory and on disk")
 
 // 디스코드 게임 활동 이미지
 MACRO_CONFIG_INT(UcRichPresenceImage, uc_rich_presence_image, 0, 0, 3, CFGFLAG_CLIENT | CFGFLAG_SAVE, "Discord Rich Presence image index")
@@ -5,7 +5,9 @@
 #include <base/system.h>
 
 #include <engine/console.h>
+#include <engine/engine.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 
 #if defined(CONF_VIDEORECORDER)
@@ -17,6 +19,8 @@
 #include "network.h"
 #include "snapshot.h"
 
+#include <algorithm>
+
 const CUuid SHA256_EXTENSION =
 	{{0x6b, 0xe6, 0xda, 0x4a, 0xce, 0xbd, 0x38, 0x0c,
 		0x9b, 0x5b, 0x12, 0x89, 0xc8, 0x42, 0xd7, 0x80}};
@@ -30,6 +34,10 @@ static const unsigned char gs_VersionTickCompression = 5; // demo files with thi
 static constexpr ColorRGBA gs_DemoPrintColor{0.75f, 0.7f, 0.7f, 1.0f};
 static constexpr LOG_COLOR DEMO_PRINT_COLOR = {191, 178, 178};
 
+// one checkpoint per second, the interval is doubled whenever the checkpoints use too much memory
+static constexpr int DEMO_CHECKPOINT_INTERVAL = SERVER_TICK_SPEED;
+static constexpr size_t DEMO_CHECKPOINT_MAX_MEMORY = 64 * 1024 * 1024;
+
 bool CDemoHeader::Valid() const
 {
 	// Check marker and ensure that strings are zero-terminated and valid UTF-8.
@@ -247,84 +255,109 @@ enum
 	CHUNKTYPE_DELTA = 3,
 };
 
-void CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe)
+static constexpr int DEMO_KEYFRAME_INTERVAL = SERVER_TICK_SPEED * 5;
+static constexpr int DEMO_TICKMARKER_MAX_SIZE = sizeof(int32_t) + 1;
+static constexpr int DEMO_CHUNK_MAX_DATA_SIZE = 64 * 1024;
+static constexpr int DEMO_CHUNK_MAX_SIZE = DEMO_CHUNK_MAX_DATA_SIZE + 3;
+
+// returns the size of the encoded tick marker
+static int EncodeTickMarker(unsigned char *pChunk, int Tick, int LastTickMarker, bool Keyframe)
 {
-	if(m_LastTickMarker == -1 || Tick - m_LastTickMarker > CHUNKMASK_TICK || Keyframe)
+	if(LastTickMarker == -1 || Tick - LastTickMarker > CHUNKMASK_TICK || Keyframe)
 	{
-		unsigned char aChunk[sizeof(int32_t) + 1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
-		uint_to_bytes_be(aChunk + 1, Tick);
+		pChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
+		uint_to_bytes_be(pChunk + 1, Tick);
 
 		if(Keyframe)
-			aChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
+			pChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
 
-		io_write(m_File, aChunk, sizeof(aChunk));
+		return DEMO_TICKMARKER_MAX_SIZE;
 	}
-	else
-	{
-		unsigned char aChunk[1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
-		io_write(m_File, aChunk, sizeof(aChunk));
-	}
-
-	m_LastTickMarker = Tick;
-	if(m_FirstTick < 0)
-		m_FirstTick = Tick;
+	pChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - LastTickMarker);
+	return 1;
 }
 
-void CDemoRecorder::Write(int Type, const void *pData, int Size)
+// pChunk must have room for DEMO_CHUNK_MAX_SIZE bytes, returns the size of the encoded chunk or -1
+static int EncodeChunk(unsigned char *pChunk, int Type, const void *pData, int Size)
 {
-	if(!m_File)
-		return;
-
-	if(Size > 64 * 1024)
-		return;
+	if(Size > DEMO_CHUNK_MAX_DATA_SIZE)
+		return -1;
 
 	/* pad the data with 0 so we get an alignment of 4,
 	else the compression won't work and miss some bytes */
-	char aBuffer[64 * 1024];
-	char aBuffer2[64 * 1024];
+	char aBuffer[DEMO_CHUNK_MAX_DATA_SIZE];
+	char aBuffer2[DEMO_CHUNK_MAX_DATA_SIZE];
 	mem_copy(aBuffer2, pData, Size);
 	while(Size & 3)
 		aBuffer2[Size++] = 0;
 	Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
 	if(Size < 0)
-		return;
+		return -1;
 
-	Size = CNetBase::Compress(aBuffer, Size, aBuffer2, sizeof(aBuffer2)); // buffer -> buffer2
+	// compress behind the largest possible header and move the data forward if the header is smaller
+	Size = CNetBase::Compress(aBuffer, Size, pChunk + 3, DEMO_CHUNK_MAX_DATA_SIZE); // buffer -> chunk
 	if(Size < 0)
-		return;
+		return -1;
 
-	unsigned char aChunk[3];
-	aChunk[0] = ((Type & 0x3) << 5);
+	int HeaderSize;
+	pChunk[0] = ((Type & 0x3) << 5);
 	if(Size < 30)
 	{
-		aChunk[0] |= Size;
-		io_write(m_File, aChunk, 1);
+		pChunk[0] |= Size;
+		HeaderSize = 1;
+	}
+	else if(Size < 256)
+	{
+		pChunk[0] |= 30;
+		pChunk[1] = Size & 0xff;
+		HeaderSize = 2;
 	}
 	else
 	{
-		if(Size < 256)
-		{
-			aChunk[0] |= 30;
-			aChunk[1] = Size & 0xff;
-			io_write(m_File, aChunk, 2);
-		}
-		else
-		{
-			aChunk[0] |= 31;
-			aChunk[1] = Size & 0xff;
-			aChunk[2] = Size >> 8;
-			io_write(m_File, aChunk, 3);
-		}
+		pChunk[0] |= 31;
+		pChunk[1] = Size & 0xff;
+		pChunk[2] = Size >> 8;
+		HeaderSize = 3;
 	}
+	if(HeaderSize < 3)
+		mem_move(pChunk + HeaderSize, pChunk + 3, Size);
+	return HeaderSize + Size;
+}
 
-	io_write(m_File, aBuffer2, Size);
+// returns the size of the delta, 0 if nothing changed
+static int CreateDemoDelta(CSnapshotDelta *pSnapshotDelta, const void *pFrom, const void *pTo, void *pDeltaData)
+{
+	pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
+	pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
+	return pSnapshotDelta->CreateDelta((const CSnapshot *)pFrom, (const CSnapshot *)pTo, pDeltaData);
+}
+
+void CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe)
+{
+	unsigned char aChunk[DEMO_TICKMARKER_MAX_SIZE];
+	io_write(m_File, aChunk, EncodeTickMarker(aChunk, Tick, m_LastTickMarker, Keyframe));
+
+	m_LastTickMarker = Tick;
+	if(m_FirstTick < 0)
+		m_FirstTick = Tick;
+}
+
+void CDemoRecorder::Write(int Type, const void *pData, int Size)
+{
+	if(!m_File)
+		return;
+
+	unsigned char aChunk[DEMO_CHUNK_MAX_SIZE];
+	const int ChunkSize = EncodeChunk(aChunk, Type, pData, Size);
+	if(ChunkSize < 0)
+		return;
+
+	io_write(m_File, aChunk, ChunkSize);
 }
 
 void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 {
-	if(m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > SERVER_TICK_SPEED * 5)
+	if(m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > DEMO_KEYFRAME_INTERVAL)
 	{
 		// write full tickmarker
 		WriteTickMarker(Tick, true);
@@ -342,9 +375,7 @@ void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 
 		// create delta
 		char aDeltaData[CSnapshot::MAX_SIZE + sizeof(int)];
-		m_pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
-		m_pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
-		const int DeltaSize = m_pSnapshotDelta->CreateDelta((CSnapshot *)m_aLastSnapshotData, (CSnapshot *)pData, &aDeltaData);
+		const int DeltaSize = CreateDemoDelta(m_pSnapshotDelta, m_aLastSnapshotData, pData, &aDeltaData);
 		if(DeltaSize)
 		{
 			// record delta
@@ -354,6 +385,17 @@ void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 	}
 }
 
+void CDemoRecorder::RecordEncoded(const void *pData, int Size, int FirstTick, int LastTick)
+{
+	if(!m_File || Size <= 0)
+		return;
+
+	io_write(m_File, pData, Size);
+	m_LastTickMarker = LastTick;
+	if(m_FirstTick < 0)
+		m_FirstTick = FirstTick;
+}
+
 void CDemoRecorder::RecordMessage(const void *pData, int Size)
 {
 	if(m_pfnFilter)
@@ -366,6 +408,110 @@ void CDemoRecorder::RecordMessage(const void *pData, int Size)
 	Write(CHUNKTYPE_MESSAGE, pData, Size);
 }
 
+CDemoRingBuffer::CDemoRingBuffer(CSnapshotDelta *pSnapshotDelta) :
+	m_pSnapshotDelta(pSnapshotDelta)
+{
+}
+
+void CDemoRingBuffer::Reset()
+{
+	m_vSegments.clear();
+	m_LastTickMarker = -1;
+	m_LastWriteOffset = 0;
+}
+
+void CDemoRingBuffer::Append(const unsigned char *pData, int Size)
+{
+	std::vector<unsigned char> &vData = m_vSegments.back().m_vData;
+	vData.insert(vData.end(), pData, pData + Size);
+}
+
+void CDemoRingBuffer::RecordSnapshot(int Tick, const void *pData, int Size, int MinTicks)
+{
+	if(!m_vSegments.empty())
+		m_LastWriteOffset = m_vSegments.back().m_vData.size();
+
+	unsigned char aChunk[DEMO_TICKMARKER_MAX_SIZE + DEMO_CHUNK_MAX_SIZE];
+	if(m_vSegments.empty() || Tick - m_vSegments.back().m_FirstTick > DEMO_KEYFRAME_INTERVAL)
+	{
+		// every segment starts with a keyframe, so a recording can begin at any of them
+		const int MarkerSize = EncodeTickMarker(aChunk, Tick, m_LastTickMarker, true);
+		const int ChunkSize = EncodeChunk(aChunk + MarkerSize, CHUNKTYPE_SNAPSHOT, pData, Size);
+		if(ChunkSize < 0)
+			return;
+
+		// drop the oldest segments as long as the remaining ones still cover the last MinTicks ticks
+		std::vector<unsigned char> vReuse;
+		while(!m_vSegments.empty())
+		{
+			const int NextFirstTick = m_vSegments.size() > 1 ? m_vSegments[1].m_FirstTick : Tick;
+			if(Tick - NextFirstTick < MinTicks)
+				break;
+			vReuse = std::move(m_vSegments.front().m_vData);
+			m_vSegments.pop_front();
+		}
+
+		CSegment &Segment = m_vSegments.emplace_back();
+		Segment.m_FirstTick = Tick;
+		Segment.m_vData = std::move(vReuse);
+		Segment.m_vData.clear();
+		Append(aChunk, MarkerSize + ChunkSize);
+		m_LastWriteOffset = 0;
+		mem_copy(m_aLastSnapshotData, pData, Size);
+	}
+	else
+	{
+		char aDeltaData[CSnapshot::MAX_SIZE + sizeof(int)];
+		const int MarkerSize = EncodeTickMarker(aChunk, Tick, m_LastTickMarker, false);
+		const int DeltaSize = CreateDemoDelta(m_pSnapshotDelta, m_aLastSnapshotData, pData, &aDeltaData);
+		int ChunkSize = 0;
+		if(DeltaSize)
+		{
+			ChunkSize = EncodeChunk(aChunk + MarkerSize, CHUNKTYPE_DELTA, aDeltaData, DeltaSize);
+			if(ChunkSize < 0)
+				ChunkSize = 0;
+			else
+				mem_copy(m_aLastSnapshotData, pData, Size);
+		}
+		Append(aChunk, MarkerSize + ChunkSize);
+	}
+	m_LastTickMarker = Tick;
+	m_vSegments.back().m_LastTick = Tick;
+}
+
+void CDemoRingBuffer::RecordMessage(const void *pData, int Size)
+{
+	// messages before the first snapshot can't be placed on a tick
+	if(m_vSegments.empty())
+		return;
+
+	m_LastWriteOffset = m_vSegments.back().m_vData.size();
+	unsigned char aChunk[DEMO_CHUNK_MAX_SIZE];
+	const int ChunkSize = EncodeChunk(aChunk, CHUNKTYPE_MESSAGE, pData, Size);
+	if(ChunkSize < 0)
+		return;
+	Append(aChunk, ChunkSize);
+}
+
+int CDemoRingBuffer::FirstTick() const
+{
+	return m_vSegments.empty() ? -1 : m_vSegments.front().m_FirstTick;
+}
+
+void CDemoRingBuffer::Write(CDemoRecorder &Recorder) const
+{
+	for(const CSegment &Segment : m_vSegments)
+		Recorder.RecordEncoded(Segment.m_vData.data(), Segment.m_vData.size(), Segment.m_FirstTick, Segment.m_LastTick);
+}
+
+void CDemoRingBuffer::WriteLast(CDemoRecorder &Recorder) const
+{
+	if(m_vSegments.empty())
+		return;
+	const CSegment &Segment = m_vSegments.back();
+	Recorder.RecordEncoded(Segment.m_vData.data() + m_LastWriteOffset, Segment.m_vData.size() - m_LastWriteOffset, Segment.m_FirstTick, Segment.m_LastTick);
+}
+
 int CDemoRecorder::Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilename)
 {
 	if(!m_File)
@@ -499,6 +645,7 @@ void CDemoPlayer::Construct(class CSnapshotDelta *pSnapshotDelta, bool UseVideo)
 	m_LastSnapshotDataSize = -1;
 	m_pListener = nullptr;
 	m_UseVideo = UseVideo;
+	m_SkipSnapshots = false;
 
 	m_aFilename[0] = '\0';
 	m_aErrorMessage[0] = '\0';
@@ -510,12 +657,17 @@ void CDemoPlayer::SetListener(IListener *pListener)
 }
 
 CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(int *pType, int *pSize, int *pTick)
+{
+	return ReadChunkHeader(m_File, m_Info.m_Header.m_Version, pType, pSize, pTick);
+}
+
+CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(IOHANDLE File, int Version, int *pType, int *pSize, int *pTick)
 {
 	*pSize = 0;
 	*pType = 0;
 
 	unsigned char Chunk = 0;
-	if(io_read(m_File, &Chunk, sizeof(Chunk)) != sizeof(Chunk))
+	if(io_read(File, &Chunk, sizeof(Chunk)) != sizeof(Chunk))
 		return CHUNKHEADER_EOF;
 
 	if(Chunk & CHUNKTYPEFLAG_TICKMARKER)
@@ -525,7 +677,7 @@ CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(int *pType, int
 		*pType = Chunk & (CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_KEYFRAME);
 
 		int NewTick;
-		if(m_Info.m_Header.m_Version < gs_VersionTickCompression && TickdeltaLegacy != 0)
+		if(Version < gs_VersionTickCompression && TickdeltaLegacy != 0)
 		{
 			if(*pTick < 0) // initial tick not initialized before a tick delta
 				return CHUNKHEADER_ERROR;
@@ -541,7 +693,7 @@ CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(int *pType, int
 		else
 		{
 			unsigned char aTickdata[sizeof(int32_t)];
-			if(io_read(m_File, aTickdata, sizeof(aTickdata)) != sizeof(aTickdata))
+			if(io_read(File, aTickdata, sizeof(aTickdata)) != sizeof(aTickdata))
 				return CHUNKHEADER_ERROR;
 			NewTick = bytes_be_to_uint(aTickdata);
 		}
@@ -558,14 +710,14 @@ CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(int *pType, int
 		if(*pSize == 30)
 		{
 			unsigned char aSizedata[1];
-			if(io_read(m_File, aSizedata, sizeof(aSizedata)) != sizeof(aSizedata))
+			if(io_read(File, aSizedata, sizeof(aSizedata)) != sizeof(aSizedata))
 				return CHUNKHEADER_ERROR;
 			*pSize = aSizedata[0];
 		}
 		else if(*pSize == 31)
 		{
 			unsigned char aSizedata[2];
-			if(io_read(m_File, aSizedata, sizeof(aSizedata)) != sizeof(aSizedata))
+			if(io_read(File, aSizedata, sizeof(aSizedata)) != sizeof(aSizedata))
 				return CHUNKHEADER_ERROR;
 			*pSize = (aSizedata[1] << 8) | aSizedata[0];
 		}
@@ -651,6 +803,74 @@ CDemoPlayer::EScanFileResult CDemoPlayer::ScanFile()
 	return ResetToStartPosition(m_vKeyFrames.empty() ? EScanFileResult::ERROR_UNRECOVERABLE : EScanFileResult::SUCCESS);
 }
 
+int CDemoPlayer::ReadChunkData(int ChunkSize)
+{
+	if(!ChunkSize)
+		return 0;
+
+	if(io_read(m_File, m_aCompressedSnapshotData, ChunkSize) != (unsigned)ChunkSize)
+	{
+		Stop("Error reading chunk data");
+		return -1;
+	}
+
+	int DataSize = CNetBase::Decompress(m_aCompressedSnapshotData, ChunkSize, m_aDecompressedSnapshotData, sizeof(m_aDecompressedSnapshotData));
+	if(DataSize < 0)
+	{
+		Stop("Error during network decompression");
+		return -1;
+	}
+
+	DataSize = CVariableInt::Decompress(m_aDecompressedSnapshotData, DataSize, m_aChunkData, sizeof(m_aChunkData));
+	if(DataSize < 0)
+	{
+		Stop("Error during intpack decompression");
+		return -1;
+	}
+	return DataSize;
+}
+
+bool CDemoPlayer::ReplayMessages(int64_t EndFilepos)
+{
+	int ChunkTick = -1;
+	while(true)
+	{
+		int ChunkType, ChunkSize;
+		if(ReadChunkHeader(&ChunkType, &ChunkSize, &ChunkTick) != CHUNKHEADER_SUCCESS)
+		{
+			Stop("Error reading chunk header");
+			return false;
+		}
+
+		if(ChunkType & CHUNKTYPEFLAG_TICKMARKER)
+		{
+			const int64_t Filepos = io_tell(m_File);
+			if(Filepos < 0)
+			{
+				Stop("Error reading chunk header");
+				return false;
+			}
+			// the chunks of the tick at the end are played normally
+			if(Filepos >= EndFilepos)
+				return true;
+			m_Info.m_PreviousTick = m_Info.m_Info.m_CurrentTick;
+			m_Info.m_Info.m_CurrentTick = ChunkTick;
+		}
+		else if(ChunkType == CHUNKTYPE_MESSAGE && m_pListener)
+		{
+			const int DataSize = ReadChunkData(ChunkSize);
+			if(DataSize < 0)
+				return false;
+			m_pListener->OnDemoPlayerMessage(m_aChunkData, DataSize);
+		}
+		else if(ChunkSize && io_skip(m_File, ChunkSize) != 0)
+		{
+			Stop("Error reading chunk data");
+			return false;
+		}
+	}
+}
+
 void CDemoPlayer::DoTick()
 {
 	// update ticks
@@ -689,29 +909,9 @@ void CDemoPlayer::DoTick()
 		}
 
 		// read the chunk
-		int DataSize = 0;
-		if(ChunkSize)
-		{
-			if(io_read(m_File, m_aCompressedSnapshotData, ChunkSize) != (unsigned)ChunkSize)
-			{
-				Stop("Error reading chunk data");
-				break;
-			}
-
-			DataSize = CNetBase::Decompress(m_aCompressedSnapshotData, ChunkSize, m_aDecompressedSnapshotData, sizeof(m_aDecompressedSnapshotData));
-			if(DataSize < 0)
-			{
-				Stop("Error during network decompression");
-				break;
-			}
-
-			DataSize = CVariableInt::Decompress(m_aDecompressedSnapshotData, DataSize, m_aChunkData, sizeof(m_aChunkData));
-			if(DataSize < 0)
-			{
-				Stop("Error during intpack decompression");
-				break;
-			}
-		}
+		int DataSize = ReadChunkData(ChunkSize);
+		if(DataSize < 0)
+			break;
 
 		if(ChunkType == CHUNKTYPE_DELTA)
 		{
@@ -739,7 +939,7 @@ void CDemoPlayer::DoTick()
 			}
 			else
 			{
-				if(m_pListener)
+				if(m_pListener && !m_SkipSnapshots)
 					m_pListener->OnDemoPlayerSnapshot(m_aSnapshot, DataSize);
 
 				m_LastSnapshotDataSize = DataSize;
@@ -766,7 +966,7 @@ void CDemoPlayer::DoTick()
 
 				m_LastSnapshotDataSize = DataSize;
 				mem_copy(m_aLastSnapshotData, m_aChunkData, DataSize);
-				if(m_pListener)
+				if(m_pListener && !m_SkipSnapshots)
 					m_pListener->OnDemoPlayerSnapshot(m_aChunkData, DataSize);
 			}
 		}
@@ -776,7 +976,8 @@ void CDemoPlayer::DoTick()
 			if(!GotSnapshot && m_pListener && m_LastSnapshotDataSize != -1)
 			{
 				GotSnapshot = true;
-				m_pListener->OnDemoPlayerSnapshot(m_aLastSnapshotData, m_LastSnapshotDataSize);
+				if(!m_SkipSnapshots)
+					m_pListener->OnDemoPlayerSnapshot(m_aLastSnapshotData, m_LastSnapshotDataSize);
 			}
 
 			// check the remaining types
@@ -812,7 +1013,150 @@ void CDemoPlayer::Unpause()
 #endif
 }
 
-int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType)
+class CDemoPlayer::CCheckpointJob : public IJob
+{
+	IOHANDLE m_File;
+	int m_Version;
+	bool m_Sixup;
+	CSnapshotDelta m_SnapshotDelta;
+
+	unsigned char m_aCompressedData[CSnapshot::MAX_SIZE];
+	unsigned char m_aDecompressedData[CSnapshot::MAX_SIZE];
+	unsigned char m_aChunkData[CSnapshot::MAX_SIZE];
+	unsigned char m_aSnapshot[CSnapshot::MAX_SIZE];
+	unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
+	int m_LastSnapshotDataSize = -1;
+
+	bool ReadSnapshot(int ChunkType, int ChunkSize);
+	void AddCheckpoint(int64_t Filepos, int Tick);
+
+	void Run() override;
+
+public:
+	std::vector<CCheckpoint> m_vCheckpoints;
+	int m_Interval = DEMO_CHECKPOINT_INTERVAL;
+	size_t m_Memory = 0;
+
+	CCheckpointJob(IOHANDLE File, int Version, bool Sixup, const CSnapshotDelta *pSnapshotDelta) :
+		m_File(File), m_Version(Version), m_Sixup(Sixup), m_SnapshotDelta(*pSnapshotDelta)
+	{
+		Abortable(true);
+		mem_zero(m_aLastSnapshotData, sizeof(m_aLastSnapshotData));
+	}
+
+	~CCheckpointJob() override
+	{
+		io_close(m_File);
+	}
+};
+
+bool CDemoPlayer::CCheckpointJob::ReadSnapshot(int ChunkType, int ChunkSize)
+{
+	int DataSize = 0;
+	if(ChunkSize)
+	{
+		if(io_read(m_File, m_aCompressedData, ChunkSize) != (unsigned)ChunkSize)
+			return false;
+		DataSize = CNetBase::Decompress(m_aCompressedData, ChunkSize, m_aDecompressedData, sizeof(m_aDecompressedData));
+		if(DataSize < 0)
+			return false;
+		DataSize = CVariableInt::Decompress(m_aDecompressedData, DataSize, m_aChunkData, sizeof(m_aChunkData));
+		if(DataSize < 0)
+			return false;
+	}
+
+	// invalid snapshots are skipped the same way as during playback
+	if(ChunkType == CHUNKTYPE_DELTA)
+	{
+		CSnapshot *pSnapshot = (CSnapshot *)m_aSnapshot;
+		DataSize = m_SnapshotDelta.UnpackDelta((CSnapshot *)m_aLastSnapshotData, pSnapshot, m_aChunkData, DataSize, m_Sixup);
+		if(DataSize >= 0 && pSnapshot->IsValid(DataSize))
+		{
+			m_LastSnapshotDataSize = DataSize;
+			mem_copy(m_aLastSnapshotData, m_aSnapshot, DataSize);
+		}
+	}
+	else if(((CSnapshot *)m_aChunkData)->IsValid(DataSize))
+	{
+		m_LastSnapshotDataSize = DataSize;
+		mem_copy(m_aLastSnapshotData, m_aChunkData, DataSize);
+	}
+	return true;
+}
+
+void CDemoPlayer::CCheckpointJob::AddCheckpoint(int64_t Filepos, int Tick)
+{
+	CCheckpoint &Checkpoint = m_vCheckpoints.emplace_back();
+	Checkpoint.m_Filepos = Filepos;
+	Checkpoint.m_Tick = Tick;
+	Checkpoint.m_vSnapshot.assign(m_aLastSnapshotData, m_aLastSnapshotData + m_LastSnapshotDataSize);
+	m_Memory += m_LastSnapshotDataSize;
+
+	if(m_Memory > DEMO_CHECKPOINT_MAX_MEMORY)
+	{
+		// drop every other checkpoint
+		size_t Kept = 0;
+		m_Memory = 0;
+		for(size_t i = 0; i < m_vCheckpoints.size(); i += 2)
+		{
+			m_Memory += m_vCheckpoints[i].m_vSnapshot.size();
+			m_vCheckpoints[Kept++] = std::move(m_vCheckpoints[i]);
+		}
+		m_vCheckpoints.resize(Kept);
+		m_Interval *= 2;
+	}
+}
+
+void CDemoPlayer::CCheckpointJob::Run()
+{
+	int ChunkTick = -1;
+	int NextCheckpointTick = -1;
+	while(State() != IJob::STATE_ABORTED)
+	{
+		int ChunkType, ChunkSize;
+		if(ReadChunkHeader(m_File, m_Version, &ChunkType, &ChunkSize, &ChunkTick) != CHUNKHEADER_SUCCESS)
+			break;
+
+		if(ChunkType & CHUNKTYPEFLAG_TICKMARKER)
+		{
+			// the checkpoint starts after the tick marker, where playback would
+			// continue with the snapshot that the deltas of this tick are based on
+			const int64_t Filepos = io_tell(m_File);
+			if(Filepos < 0)
+				break;
+			if(m_LastSnapshotDataSize > 0 && ChunkTick >= NextCheckpointTick)
+			{
+				AddCheckpoint(Filepos, ChunkTick);
+				NextCheckpointTick = ChunkTick + m_Interval;
+			}
+		}
+		else if(ChunkType == CHUNKTYPE_DELTA || ChunkType == CHUNKTYPE_SNAPSHOT)
+		{
+			if(!ReadSnapshot(ChunkType, ChunkSize))
+				break;
+		}
+		else if(ChunkSize && io_skip(m_File, ChunkSize) != 0)
+		{
+			break;
+		}
+	}
+}
+
+void CDemoPlayer::UpdateCheckpoints()
+{
+	if(m_pCheckpointJob && m_pCheckpointJob->State() == IJob::STATE_DONE)
+	{
+		m_vCheckpoints = std::move(m_pCheckpointJob->m_vCheckpoints);
+		m_pCheckpointJob = nullptr;
+	}
+}
+
+std::shared_ptr<const IJob> CDemoPlayer::CheckpointJob() const
+{
+	return m_pCheckpointJob;
+}
+
+int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType, class IEngine *pEngine)
 {
 	dbg_assert(m_File == 0, "Demo player already playing");
 
@@ -872,6 +1216,22 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 	}
 	m_Info.m_LiveStateUpdating = true;
 
+	// unpack snapshots in the background for faster seeking
+	if(pEngine)
+	{
+		const int64_t ChunksPos = io_tell(m_File);
+		IOHANDLE CheckpointFile = pStorage->OpenFile(pFilename, IOFLAG_READ, StorageType);
+		if(CheckpointFile && ChunksPos >= 0 && io_seek(CheckpointFile, ChunksPos, IOSEEK_START) == 0)
+		{
+			m_pCheckpointJob = std::make_shared<CCheckpointJob>(CheckpointFile, m_Info.m_Header.m_Version, m_Sixup, m_pSnapshotDelta);
+			pEngine->AddJob(m_pCheckpointJob);
+		}
+		else if(CheckpointFile)
+		{
+			io_close(CheckpointFile);
+		}
+	}
+
 	// reset slice markers
 	g_Config.m_ClDemoSliceBegin = -1;
 	g_Config.m_ClDemoSliceEnd = -1;
@@ -1064,15 +1424,35 @@ int CDemoPlayer::SetPos(int WantedTick)
 	m_Info.m_Info.m_CurrentTick = -1;
 	m_Info.m_PreviousTick = -1;
 
-	// playback everything until we hit our tick
+	// a later checkpoint saves unpacking the deltas since the key frame,
+	// only the messages in between are still read and passed on
+	UpdateCheckpoints();
+	auto Checkpoint = std::upper_bound(m_vCheckpoints.begin(), m_vCheckpoints.end(), KeyFrameWantedTick, [](int Tick, const CCheckpoint &Other) {
+		return Tick < Other.m_Tick;
+	});
+	if(Checkpoint != m_vCheckpoints.begin() && std::prev(Checkpoint)->m_Tick > m_vKeyFrames[KeyFrame].m_Tick)
+	{
+		--Checkpoint;
+		if(!ReplayMessages(Checkpoint->m_Filepos))
+			return -1;
+		m_Info.m_NextTick = Checkpoint->m_Tick;
+		m_LastSnapshotDataSize = Checkpoint->m_vSnapshot.size();
+		mem_copy(m_aLastSnapshotData, Checkpoint->m_vSnapshot.data(), m_LastSnapshotDataSize);
+	}
+
+	// playback everything until we hit our tick, only the
+	// snapshots of the last few ticks are passed to the listener
 	while(m_Info.m_NextTick < WantedTick)
 	{
+		m_SkipSnapshots = m_Info.m_NextTick < KeyFrameWantedTick;
 		DoTick();
 		if(!IsPlaying())
 		{
+			m_SkipSnapshots = false;
 			return -1;
 		}
 	}
+	m_SkipSnapshots = false;
 
 	Play();
 
@@ -1251,6 +1631,12 @@ void CDemoPlayer::Stop(const char *pErrorMessage)
 	io_close(m_File);
 	m_File = nullptr;
 	m_vKeyFrames.clear();
+	if(m_pCheckpointJob)
+	{
+		m_pCheckpointJob->Abort();
+		m_pCheckpointJob = nullptr;
+	}
+	m_vCheckpoints.clear();
 	str_copy(m_aFilename, "");
 	str_copy(m_aErrorMessage, pErrorMessage);
 }
@@ -10,9 +10,13 @@
 #include <engine/demo.h>
 #include <engine/shared/protocol.h>
 
+#include <deque>
 #include <functional>
+#include <memory>
 #include <vector>
 
+class IJob;
+
 typedef std::function<void()> TUpdateIntraTimesFunc;
 
 class CDemoRecorder : public IDemoRecorder
@@ -53,6 +57,8 @@ public:
 
 	void RecordSnapshot(int Tick, const void *pData, int Size);
 	void RecordMessage(const void *pData, int Size);
+	// appends chunks encoded by a CDemoRingBuffer, don't mix with RecordSnapshot
+	void RecordEncoded(const void *pData, int Size, int FirstTick, int LastTick);
 
 	bool IsRecording() const override { return m_File != nullptr; }
 	const char *CurrentFilename() const override { return m_aCurrentFilename; }
@@ -60,6 +66,44 @@ public:
 	int Length() const override { return (m_LastTickMarker - m_FirstTick) / SERVER_TICK_SPEED; }
 };
 
+// Keeps the last ticks of a recording in memory, already encoded as demo chunks.
+// Any number of recorders can be started from it and fed from it afterwards,
+// so they include what happened before they were started at no extra encoding cost.
+class CDemoRingBuffer
+{
+	// a keyframe and the ticks following it
+	class CSegment
+	{
+	public:
+		int m_FirstTick;
+		int m_LastTick;
+		std::vector<unsigned char> m_vData;
+	};
+
+	class CSnapshotDelta *m_pSnapshotDelta;
+	std::deque<CSegment> m_vSegments;
+	int m_LastTickMarker = -1;
+	size_t m_LastWriteOffset = 0;
+	unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
+
+	void Append(const unsigned char *pData, int Size);
+
+public:
+	CDemoRingBuffer(class CSnapshotDelta *pSnapshotDelta);
+
+	void Reset();
+	// keeps at least MinTicks ticks before the current one
+	void RecordSnapshot(int Tick, const void *pData, int Size, int MinTicks);
+	void RecordMessage(const void *pData, int Size);
+
+	bool Empty() const { return m_vSegments.empty(); }
+	int FirstTick() const;
+	// writes everything starting at the oldest keyframe
+	void Write(CDemoRecorder &Recorder) const;
+	// writes what the last RecordSnapshot or RecordMessage call added
+	void WriteLast(CDemoRecorder &Recorder) const;
+};
+
 class CDemoPlayer : public IDemoPlayer
 {
 public:
@@ -141,13 +185,33 @@ private:
 	bool m_WasRecording = false;
 #endif
 
+	// Fully unpacked snapshots at regular intervals, so seeking
+	// doesn't have to unpack every delta since the last keyframe.
+	class CCheckpoint
+	{
+	public:
+		int64_t m_Filepos;
+		int m_Tick;
+		std::vector<unsigned char> m_vSnapshot;
+	};
+	class CCheckpointJob;
+	std::vector<CCheckpoint> m_vCheckpoints;
+	std::shared_ptr<CCheckpointJob> m_pCheckpointJob;
+	// Don't pass snapshots of ticks which are skipped while seeking to the listener
+	bool m_SkipSnapshots;
+	void UpdateCheckpoints();
+	// Delivers the messages up to the given position without unpacking snapshots
+	bool ReplayMessages(int64_t EndFilepos);
+
 	enum EReadChunkHeaderResult
 	{
 		CHUNKHEADER_SUCCESS,
 		CHUNKHEADER_ERROR,
 		CHUNKHEADER_EOF,
 	};
+	static EReadChunkHeaderResult ReadChunkHeader(IOHANDLE File, int Version, int *pType, int *pSize, int *pTick);
 	EReadChunkHeaderResult ReadChunkHeader(int *pType, int *pSize, int *pTick);
+	int ReadChunkData(int ChunkSize);
 	void DoTick();
 	enum class EScanFileResult
 	{
@@ -170,7 +234,7 @@ public:
 
 	void SetListener(IListener *pListener);
 
-	int Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType);
+	int Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType, class IEngine *pEngine = nullptr);
 	unsigned char *GetMapData(class IStorage *pStorage);
 	bool ExtractMap(class IStorage *pStorage);
 	void Play();
@@ -192,6 +256,9 @@ public:
 
 	void Update(bool RealTime = true);
 	bool IsSixup() const { return m_Sixup; }
+	// Creates the checkpoints in the background, they are used once it is done
+	std::shared_ptr<const IJob> CheckpointJob() const;
+	int NumCheckpoints() const { return m_vCheckpoints.size(); }
 
 	const CPlaybackInfo *Info() const { return &m_Info; }
 	bool IsPlaying() const override { return m_File != nullptr; }
@@ -279,10 +279,16 @@ size_t CHttpRequest::OnHeader(char *pHeader, size_t HeaderSize)
 		m_HeadersEnded = false;
 		m_ResultDate = {};
 		m_ResultLastModified = {};
+		m_ResultRetryAfter = {};
+		m_ResultRateLimitRemaining = {};
+		m_ResultRateLimitResetAfter = {};
 	}
 
 	static const char DATE[] = "Date: ";
 	static const char LAST_MODIFIED[] = "Last-Modified: ";
+	static const char RETRY_AFTER[] = "Retry-After: ";
+	static const char RATELIMIT_REMAINING[] = "X-RateLimit-Remaining: ";
+	static const char RATELIMIT_RESET_AFTER[] = "X-RateLimit-Reset-After: ";
 
 	// Trailing newline and null termination evens out.
 	if(HeaderSize - 1 >= sizeof(DATE) - 1 && str_startswith_nocase(pHeader, DATE))
@@ -305,6 +311,36 @@ size_t CHttpRequest::OnHeader(char *pHeader, size_t HeaderSize)
 			m_ResultLastModified = Value;
 		}
 	}
+	if(HeaderSize - 1 >= sizeof(RETRY_AFTER) - 1 && str_startswith_nocase(pHeader, RETRY_AFTER))
+	{
+		char aValue[32];
+		str_truncate(aValue, sizeof(aValue), pHeader + (sizeof(RETRY_AFTER) - 1), HeaderSize - (sizeof(RETRY_AFTER) - 1) - 1);
+		float Value;
+		if(str_tofloat(aValue, &Value))
+		{
+			m_ResultRetryAfter = Value;
+		}
+	}
+	if(HeaderSize - 1 >= sizeof(RATELIMIT_REMAINING) - 1 && str_startswith_nocase(pHeader, RATELIMIT_REMAINING))
+	{
+		char aValue[32];
+		str_truncate(aValue, sizeof(aValue), pHeader + (sizeof(RATELIMIT_REMAINING) - 1), HeaderSize - (sizeof(RATELIMIT_REMAINING) - 1) - 1);
+		int Value;
+		if(str_toint(aValue, &Value))
+		{
+			m_ResultRateLimitRemaining = Value;
+		}
+	}
+	if(HeaderSize - 1 >= sizeof(RATELIMIT_RESET_AFTER) - 1 && str_startswith_nocase(pHeader, RATELIMIT_RESET_AFTER))
+	{
+		char aValue[32];
+		str_truncate(aValue, sizeof(aValue), pHeader + (sizeof(RATELIMIT_RESET_AFTER) - 1), HeaderSize - (sizeof(RATELIMIT_RESET_AFTER) - 1) - 1);
+		float Value;
+		if(str_tofloat(aValue, &Value))
+		{
+			m_ResultRateLimitResetAfter = Value;
+		}
+	}
 
 	return HeaderSize;
 }
@@ -585,6 +621,24 @@ std::optional<int64_t> CHttpRequest::ResultLastModified() const
 	return m_ResultLastModified;
 }
 
+std::optional<float> CHttpRequest::ResultRetryAfter() const
+{
+	dbg_assert(State() == EHttpState::DONE, "Request not done");
+	return m_ResultRetryAfter;
+}
+
+std::optional<int> CHttpRequest::ResultRateLimitRemaining() const
+{
+	dbg_assert(State() == EHttpState::DONE, "Request not done");
+	return m_ResultRateLimitRemaining;
+}
+
+std::optional<float> CHttpRequest::ResultRateLimitResetAfter() const
+{
+	dbg_assert(State() == EHttpState::DONE, "Request not done");
+	return m_ResultRateLimitResetAfter;
+}
+
 bool CHttp::Init(std::chrono::milliseconds ShutdownDelay)
 {
 	m_ShutdownDelay = ShutdownDelay;
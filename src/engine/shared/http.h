@@ -130,6 +130,9 @@ class CHttpRequest : public IHttpRequest
 	bool m_HeadersEnded = false;
 	std::optional<int64_t> m_ResultDate = std::nullopt;
 	std::optional<int64_t> m_ResultLastModified = std::nullopt;
+	std::optional<float> m_ResultRetryAfter = std::nullopt;
+	std::optional<int> m_ResultRateLimitRemaining = std::nullopt;
+	std::optional<float> m_ResultRateLimitResetAfter = std::nullopt;
 
 	bool ShouldSkipRequest();
 	// Abort the request with an error if `BeforeInit()` returns false.
@@ -247,6 +250,11 @@ public:
 	int StatusCode() const;
 	std::optional<int64_t> ResultAgeSeconds() const;
 	std::optional<int64_t> ResultLastModified() const;
+	// Rate limit hints from `Retry-After`, `X-RateLimit-Remaining` and
+	// `X-RateLimit-Reset-After` (in seconds) response headers.
+	std::optional<float> ResultRetryAfter() const;
+	std::optional<int> ResultRateLimitRemaining() const;
+	std::optional<float> ResultRateLimitResetAfter() const;
 };
 
 inline std::unique_ptr<CHttpRequest> HttpHead(const char *pUrl)
@@ -108,7 +108,7 @@ public:
 	void SetStaticsize(int ItemType, size_t Size);
 	void SetStaticsize7(int ItemType, size_t Size);
 	const CData *EmptyDelta() const;
-	int CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData);
+	int CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData) const;
 	int UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const void *pSrcData, int DataSize, bool Sixup);
 	int DebugDumpDelta(const void *pSrcData, int DataSize);
 };
@@ -97,6 +97,11 @@ void CBackground::OnMapLoad()
 	}
 }
 
+SHA256_DIGEST CBackground::MapSha256() const
+{
+	return m_pMap->Sha256();
+}
+
 void CBackground::OnRender()
 {
 	if(!m_Loaded)
@@ -40,6 +40,7 @@ public:
 	void OnInit() override;
 	void OnMapLoad() override;
 	void OnRender() override;
+	SHA256_DIGEST MapSha256() const override;
 
 	void LoadBackground();
 	const char *MapName() const { return m_aMapName; }
@@ -29,6 +29,11 @@ CCamera *CMapLayers::GetCurCamera()
 	return &GameClient()->m_Camera;
 }
 
+SHA256_DIGEST CMapLayers::MapSha256() const
+{
+	return Client()->GetCurrentMapSha256();
+}
+
 void CMapLayers::OnMapLoad()
 {
 	FRenderUploadCallback FRenderCallback = [&](const char *pTitle, const char *pMessage, int IncreaseCounter) { GameClient()->m_Menus.RenderLoading(pTitle, pMessage, IncreaseCounter); };
@@ -43,7 +48,7 @@ void CMapLayers::OnMapLoad()
 
 	m_EnvEvaluator = CEnvelopeState(m_pLayers->Map(), m_OnlineOnly);
 	m_EnvEvaluator.OnInterfacesInit(GameClient());
-	m_MapRenderer.Load(m_Type, m_pLayers, m_pImages, &m_EnvEvaluator, FRenderCallbackOptional);
+	m_MapRenderer.Load(m_Type, m_pLayers, m_pImages, &m_EnvEvaluator, FRenderCallbackOptional, Engine(), Storage(), MapSha256());
 }
 
 void CMapLayers::OnRender()
@@ -34,6 +34,7 @@ public:
 	void OnMapLoad() override;
 
 	virtual CCamera *GetCurCamera();
+	virtual SHA256_DIGEST MapSha256() const;
 
 	CEnvelopeState &EnvEvaluator() { return m_EnvEvaluator; }
 
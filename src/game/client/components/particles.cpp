@@ -21,21 +21,85 @@ CParticles::CParticles()
 	m_RenderGeneral.m_pParts = this;
 }
 
-void CParticles::OnReset()
+template<typename T>
+static void SwapRemove(std::vector<T> &v, int Index)
 {
-	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
-	{
-		m_aParticles[i].m_PrevPart = i - 1;
-		m_aParticles[i].m_NextPart = i + 1;
-	}
+	v[Index] = v.back();
+	v.pop_back();
+}
+
+void CParticles::CParticleGroup::Clear()
+{
+	m_vPosX.clear();
+	m_vPosY.clear();
+	m_vVelX.clear();
+	m_vVelY.clear();
+	m_vLife.clear();
+	m_vLifeSpan.clear();
+	m_vRot.clear();
+	m_vRotspeed.clear();
+	m_vGravity.clear();
+	m_vFriction.clear();
+	m_vStartSize.clear();
+	m_vEndSize.clear();
+	m_vStartAlpha.clear();
+	m_vEndAlpha.clear();
+	m_vColor.clear();
+	m_vSpr.clear();
+	m_vUseAlphaFading.clear();
+	m_vCollides.clear();
+}
 
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES - 1].m_NextPart = -1;
-	m_FirstFree = 0;
+void CParticles::CParticleGroup::Add(const CParticle &Part, float Life)
+{
+	m_vPosX.push_back(Part.m_Pos.x);
+	m_vPosY.push_back(Part.m_Pos.y);
+	m_vVelX.push_back(Part.m_Vel.x);
+	m_vVelY.push_back(Part.m_Vel.y);
+	m_vLife.push_back(Life);
+	m_vLifeSpan.push_back(Part.m_LifeSpan);
+	m_vRot.push_back(Part.m_Rot);
+	m_vRotspeed.push_back(Part.m_Rotspeed);
+	m_vGravity.push_back(Part.m_Gravity);
+	m_vFriction.push_back(Part.m_Friction);
+	m_vStartSize.push_back(Part.m_StartSize);
+	m_vEndSize.push_back(Part.m_EndSize);
+	m_vStartAlpha.push_back(Part.m_StartAlpha);
+	m_vEndAlpha.push_back(Part.m_EndAlpha);
+	m_vColor.push_back(Part.m_Color);
+	m_vSpr.push_back(Part.m_Spr);
+	m_vUseAlphaFading.push_back(Part.m_UseAlphaFading);
+	m_vCollides.push_back(Part.m_Collides);
+}
 
-	for(int &FirstPart : m_aFirstPart)
-		FirstPart = -1;
+void CParticles::CParticleGroup::Remove(int Index)
+{
+	SwapRemove(m_vPosX, Index);
+	SwapRemove(m_vPosY, Index);
+	SwapRemove(m_vVelX, Index);
+	SwapRemove(m_vVelY, Index);
+	SwapRemove(m_vLife, Index);
+	SwapRemove(m_vLifeSpan, Index);
+	SwapRemove(m_vRot, Index);
+	SwapRemove(m_vRotspeed, Index);
+	SwapRemove(m_vGravity, Index);
+	SwapRemove(m_vFriction, Index);
+	SwapRemove(m_vStartSize, Index);
+	SwapRemove(m_vEndSize, Index);
+	SwapRemove(m_vStartAlpha, Index);
+	SwapRemove(m_vEndAlpha, Index);
+	SwapRemove(m_vColor, Index);
+	SwapRemove(m_vSpr, Index);
+	SwapRemove(m_vUseAlphaFading, Index);
+	SwapRemove(m_vCollides, Index);
+}
+
+void CParticles::OnReset()
+{
+	// reset particles
+	for(CParticleGroup &Group : m_aGroups)
+		Group.Clear();
+	m_NumParticles = 0;
 }
 
 void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
@@ -52,27 +116,74 @@ void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
 			return;
 	}
 
-	if(m_FirstFree == -1)
+	if(m_NumParticles >= MAX_PARTICLES)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
+	m_aGroups[Group].Add(*pPart, TimePassed);
+	m_NumParticles++;
+}
+
+void CParticles::UpdateGroup(CParticleGroup &Group, float TimePassed, int FrictionCount)
+{
+	const int Num = Group.Size();
+	float *pPosX = Group.m_vPosX.data();
+	float *pPosY = Group.m_vPosY.data();
+	float *pVelX = Group.m_vVelX.data();
+	float *pVelY = Group.m_vVelY.data();
+	float *pLife = Group.m_vLife.data();
+	float *pRot = Group.m_vRot.data();
+	const float *pRotspeed = Group.m_vRotspeed.data();
+	const float *pGravity = Group.m_vGravity.data();
+	const float *pFriction = Group.m_vFriction.data();
+	const uint8_t *pCollides = Group.m_vCollides.data();
+
+	// plain integration, kept free of branches and calls so the compiler can vectorize it
+	for(int i = 0; i < Num; i++)
+		pVelY[i] += pGravity[i] * TimePassed;
+
+	for(int f = 0; f < FrictionCount; f++) // apply friction
+	{
+		for(int i = 0; i < Num; i++)
+		{
+			pVelX[i] *= pFriction[i];
+			pVelY[i] *= pFriction[i];
+		}
+	}
 
-	// copy data
-	m_aParticles[Id] = *pPart;
+	for(int i = 0; i < Num; i++)
+	{
+		// colliding particles are moved below
+		const float Step = pCollides[i] ? 0.0f : TimePassed;
+		pPosX[i] += pVelX[i] * Step;
+		pPosY[i] += pVelY[i] * Step;
+		pLife[i] += TimePassed;
+		pRot[i] += TimePassed * pRotspeed[i];
+	}
 
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
+	for(int i = 0; i < Num; i++)
+	{
+		if(!pCollides[i])
+			continue;
+
+		vec2 Pos = vec2(pPosX[i], pPosY[i]);
+		vec2 Vel = vec2(pVelX[i], pVelY[i]) * TimePassed;
+		Collision()->MovePoint(&Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
+		Vel *= 1.0f / TimePassed;
+		pPosX[i] = Pos.x;
+		pPosY[i] = Pos.y;
+		pVelX[i] = Vel.x;
+		pVelY[i] = Vel.y;
+	}
 
-	// set some parameters
-	m_aParticles[Id].m_Life = TimePassed;
+	// check particle death, walking backwards so the swapped in particle was already checked
+	for(int i = Num - 1; i >= 0; i--)
+	{
+		if(Group.m_vLife[i] > Group.m_vLifeSpan[i])
+		{
+			Group.Remove(i);
+			m_NumParticles--;
+		}
+	}
 }
 
 void CParticles::Update(float TimePassed)
@@ -92,55 +203,8 @@ void CParticles::Update(float TimePassed)
 		m_FrictionFraction -= 0.05f;
 	}
 
-	for(int &FirstPart : m_aFirstPart)
-	{
-		int i = FirstPart;
-		while(i != -1)
-		{
-			int Next = m_aParticles[i].m_NextPart;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity * TimePassed;
-
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
-
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel * TimePassed;
-			if(m_aParticles[i].m_Collides)
-			{
-				Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
-			}
-			else
-			{
-				m_aParticles[i].m_Pos += Vel;
-			}
-			m_aParticles[i].m_Vel = Vel * (1.0f / TimePassed);
-
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
-
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
-			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					FirstPart = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
-			}
-
-			i = Next;
-		}
-	}
+	for(CParticleGroup &Group : m_aGroups)
+		UpdateGroup(Group, TimePassed, FrictionCount);
 }
 
 void CParticles::OnRender()
@@ -218,127 +282,95 @@ void CParticles::RenderGroup(int Group)
 		ParticleQuadContainerIndex = m_ExtraParticleQuadContainerIndex;
 	}
 
+	const CParticleGroup &Parts = m_aGroups[Group];
+	const int Num = Parts.Size();
+	if(Num == 0)
+		return;
+
+	// newest particles are at the back, draw them first so older ones stay on top
 	// don't use the buffer methods here, else the old renderer gets many draw calls
 	if(Graphics()->IsQuadContainerBufferingEnabled())
 	{
-		int i = m_aFirstPart[Group];
-
-		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[MAX_PARTICLES];
-
 		int CurParticleRenderCount = 0;
 
 		// batching makes sense for stuff like ninja particles
 		ColorRGBA LastColor;
-		int LastQuadOffset = 0;
+		int LastQuadOffset = Parts.m_vSpr[Num - 1];
 
-		if(i != -1)
+		for(int i = Num - 1; i >= 0; i--)
 		{
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
+			int QuadOffset = Parts.m_vSpr[i];
+			float a = Parts.m_vLife[i] / Parts.m_vLifeSpan[i];
+			vec2 p = vec2(Parts.m_vPosX[i], Parts.m_vPosY[i]);
+			float Size = mix(Parts.m_vStartSize[i], Parts.m_vEndSize[i], a);
+			ColorRGBA Color = Parts.m_vColor[i];
+			if(Parts.m_vUseAlphaFading[i])
 			{
-				float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
+				Color.a = mix(Parts.m_vStartAlpha[i], Parts.m_vEndAlpha[i], a);
 			}
-			LastColor.r = m_aParticles[i].m_Color.r;
-			LastColor.g = m_aParticles[i].m_Color.g;
-			LastColor.b = m_aParticles[i].m_Color.b;
-			LastColor.a = Alpha;
-
-			Graphics()->SetColor(
-				m_aParticles[i].m_Color.r,
-				m_aParticles[i].m_Color.g,
-				m_aParticles[i].m_Color.b,
-				Alpha);
-
-			LastQuadOffset = m_aParticles[i].m_Spr;
-		}
 
-		while(i != -1)
-		{
-			int QuadOffset = m_aParticles[i].m_Spr;
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
+			if(i == Num - 1)
 			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
+				Graphics()->SetColor(Color);
+				LastColor = Color;
 			}
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != m_aParticles[i].m_Color.r || LastColor.g != m_aParticles[i].m_Color.g || LastColor.b != m_aParticles[i].m_Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
+				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor != Color || LastQuadOffset != QuadOffset)
 				{
 					Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
-					Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
+					Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, m_aRenderInfo);
 					CurParticleRenderCount = 0;
 					LastQuadOffset = QuadOffset;
 
-					Graphics()->SetColor(
-						m_aParticles[i].m_Color.r,
-						m_aParticles[i].m_Color.g,
-						m_aParticles[i].m_Color.b,
-						Alpha);
-
-					LastColor.r = m_aParticles[i].m_Color.r;
-					LastColor.g = m_aParticles[i].m_Color.g;
-					LastColor.b = m_aParticles[i].m_Color.b;
-					LastColor.a = Alpha;
+					Graphics()->SetColor(Color);
+					LastColor = Color;
 				}
 
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = Size;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = m_aParticles[i].m_Rot;
+				m_aRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
+				m_aRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
+				m_aRenderInfo[CurParticleRenderCount].m_Scale = Size;
+				m_aRenderInfo[CurParticleRenderCount].m_Rotation = Parts.m_vRot[i];
 
 				++CurParticleRenderCount;
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 
 		Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
-		Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
+		Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, m_aRenderInfo);
 	}
 	else
 	{
-		int i = m_aFirstPart[Group];
-
 		Graphics()->BlendNormal();
 		Graphics()->WrapClamp();
 
-		while(i != -1)
+		for(int i = Num - 1; i >= 0; i--)
 		{
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
+			float a = Parts.m_vLife[i] / Parts.m_vLifeSpan[i];
+			vec2 p = vec2(Parts.m_vPosX[i], Parts.m_vPosY[i]);
+			float Size = mix(Parts.m_vStartSize[i], Parts.m_vEndSize[i], a);
+			ColorRGBA Color = Parts.m_vColor[i];
+			if(Parts.m_vUseAlphaFading[i])
 			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
+				Color.a = mix(Parts.m_vStartAlpha[i], Parts.m_vEndAlpha[i], a);
 			}
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				Graphics()->TextureSet(aParticles[m_aParticles[i].m_Spr - FirstParticleOffset]);
+				Graphics()->TextureSet(aParticles[Parts.m_vSpr[i] - FirstParticleOffset]);
 				Graphics()->QuadsBegin();
 
-				Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
+				Graphics()->QuadsSetRotation(Parts.m_vRot[i]);
 
-				Graphics()->SetColor(
-					m_aParticles[i].m_Color.r,
-					m_aParticles[i].m_Color.g,
-					m_aParticles[i].m_Color.b,
-					Alpha);
+				Graphics()->SetColor(Color);
 
 				IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
 				Graphics()->QuadsDraw(&QuadItem, 1);
 				Graphics()->QuadsEnd();
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 		Graphics()->WrapNormal();
 		Graphics()->BlendNormal();
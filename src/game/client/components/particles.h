@@ -5,8 +5,13 @@
 #include <base/color.h>
 #include <base/vmath.h>
 
+#include <engine/graphics.h>
+
 #include <game/client/component.h>
 
+#include <cstdint>
+#include <vector>
+
 // particles
 struct CParticle
 {
@@ -54,11 +59,6 @@ struct CParticle
 	ColorRGBA m_Color;
 
 	bool m_Collides;
-
-	// set by the particle system
-	float m_Life;
-	int m_PrevPart;
-	int m_NextPart;
 };
 
 class CParticles : public CComponent
@@ -94,15 +94,47 @@ private:
 		MAX_PARTICLES = 1024 * 8,
 	};
 
-	CParticle m_aParticles[MAX_PARTICLES];
-	int m_FirstFree;
-	int m_aFirstPart[NUM_GROUPS];
+	// particles of one group, stored as structure of arrays so the update loops vectorize;
+	// dead particles are swap-removed, so the order inside a group is not stable
+	class CParticleGroup
+	{
+	public:
+		int Size() const { return m_vLife.size(); }
+		void Clear();
+		void Add(const CParticle &Part, float Life);
+		void Remove(int Index);
+
+		std::vector<float> m_vPosX;
+		std::vector<float> m_vPosY;
+		std::vector<float> m_vVelX;
+		std::vector<float> m_vVelY;
+		std::vector<float> m_vLife;
+		std::vector<float> m_vLifeSpan;
+		std::vector<float> m_vRot;
+		std::vector<float> m_vRotspeed;
+		std::vector<float> m_vGravity;
+		std::vector<float> m_vFriction;
+		std::vector<float> m_vStartSize;
+		std::vector<float> m_vEndSize;
+		std::vector<float> m_vStartAlpha;
+		std::vector<float> m_vEndAlpha;
+		std::vector<ColorRGBA> m_vColor;
+		std::vector<int> m_vSpr;
+		std::vector<uint8_t> m_vUseAlphaFading;
+		std::vector<uint8_t> m_vCollides;
+	};
+
+	CParticleGroup m_aGroups[NUM_GROUPS];
+	int m_NumParticles;
+
+	IGraphics::SRenderSpriteInfo m_aRenderInfo[gs_GraphicsMaxParticlesRenderCount];
 
 	float m_FrictionFraction = 0.0f;
 	int64_t m_LastRenderTime = 0;
 
 	void RenderGroup(int Group);
 	void Update(float TimePassed);
+	void UpdateGroup(CParticleGroup &Group, float TimePassed, int FrictionCount);
 
 	template<int TGROUP>
 	class CRenderGroup : public CComponent
@@ -215,78 +215,132 @@ void CPlayers::RenderHookCollLine(
 	if(HookLength < HOOK_START_DISTANCE || HookFireSpeed <= 0.0f)
 		return;
 
-	vec2 QuantizedDirection = Direction;
 	vec2 StartOffset = Direction * HOOK_START_DISTANCE;
-	vec2 BasePos = Position;
-	vec2 LineStartPos = BasePos + StartOffset;
-	vec2 SegmentStartPos = LineStartPos;
 
-	ColorRGBA HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorNoColl));
-	std::vector<IGraphics::CLineItem> vLineSegments;
+	// the trace only changes when its inputs do, other players are only checked once per tick
+	CHookCollLine &HookCollLine = m_aHookCollLines[ClientId];
+	const int Tick = Client()->GameTick(g_Config.m_ClDummy);
+	const ivec2 RoundedPosition = ivec2(round_to_int(Position.x), round_to_int(Position.y));
+	const int RoundedAngle = round_to_int(Angle * 256.0f);
+	if(HookCollLine.m_Tick != Tick || HookCollLine.m_Position != RoundedPosition || HookCollLine.m_Angle != RoundedAngle ||
+		HookCollLine.m_HookLength != HookLength || HookCollLine.m_HookFireSpeed != HookFireSpeed)
+	{
+		vec2 QuantizedDirection = Direction;
+		vec2 BasePos = Position;
+		vec2 LineStartPos = BasePos + StartOffset;
+		vec2 SegmentStartPos = LineStartPos;
 
-	const int MaxHookTicks = 5 * Client()->GameTickSpeed(); // calculating above 5 seconds is very expensive and unlikely to happen
+		ColorRGBA HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorNoColl));
+		std::vector<IGraphics::CLineItem> &vLineSegments = HookCollLine.m_vLineSegments;
+		vLineSegments.clear();
 
-	auto AddHookPlayerSegment = [&](const vec2 &StartPos, const vec2 &EndPos, const vec2 &HookablePlayerPosition, const vec2 &HitPos) {
-		HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorTeeColl));
+		const int MaxHookTicks = 5 * Client()->GameTickSpeed(); // calculating above 5 seconds is very expensive and unlikely to happen
 
-		// stop hookline at player circle so it looks better
-		vec2 aIntersections[2];
-		int NumIntersections = intersect_line_circle(StartPos, EndPos, HookablePlayerPosition, CCharacterCore::PhysicalSize() * 1.45f / 2.0f, aIntersections);
-		if(NumIntersections == 2)
-		{
-			if(distance(Position, aIntersections[0]) < distance(Position, aIntersections[1]))
+		auto AddHookPlayerSegment = [&](const vec2 &StartPos, const vec2 &EndPos, const vec2 &HookablePlayerPosition, const vec2 &HitPos) {
+			HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorTeeColl));
+
+			// stop hookline at player circle so it looks better
+			vec2 aIntersections[2];
+			int NumIntersections = intersect_line_circle(StartPos, EndPos, HookablePlayerPosition, CCharacterCore::PhysicalSize() * 1.45f / 2.0f, aIntersections);
+			if(NumIntersections == 2)
+			{
+				if(distance(Position, aIntersections[0]) < distance(Position, aIntersections[1]))
+					vLineSegments.emplace_back(StartPos, aIntersections[0]);
+				else
+					vLineSegments.emplace_back(StartPos, aIntersections[1]);
+			}
+			else if(NumIntersections == 1)
 				vLineSegments.emplace_back(StartPos, aIntersections[0]);
 			else
-				vLineSegments.emplace_back(StartPos, aIntersections[1]);
-		}
-		else if(NumIntersections == 1)
-			vLineSegments.emplace_back(StartPos, aIntersections[0]);
-		else
-			vLineSegments.emplace_back(StartPos, HitPos);
-	};
+				vLineSegments.emplace_back(StartPos, HitPos);
+		};
 
-	// simulate the hook into the future
-	int HookTick;
-	bool HookEnteredTelehook = false;
-	for(HookTick = 0; HookTick < MaxHookTicks; ++HookTick)
-	{
-		int Tele;
-		vec2 HitPos, IntersectedPlayerPosition;
-		vec2 SegmentEndPos = SegmentStartPos + QuantizedDirection * HookFireSpeed;
-
-		// check if a hook would enter retracting state in this tick
-		if(distance(BasePos, SegmentEndPos) > HookLength)
+		// simulate the hook into the future
+		int HookTick;
+		bool HookEnteredTelehook = false;
+		for(HookTick = 0; HookTick < MaxHookTicks; ++HookTick)
 		{
-			// check if the retracting hook hits a player
-			if(!HookEnteredTelehook)
+			int Tele;
+			vec2 HitPos, IntersectedPlayerPosition;
+			vec2 SegmentEndPos = SegmentStartPos + QuantizedDirection * HookFireSpeed;
+
+			// check if a hook would enter retracting state in this tick
+			if(distance(BasePos, SegmentEndPos) > HookLength)
 			{
-				vec2 RetractingHookEndPos = BasePos + normalize(SegmentEndPos - BasePos) * HookLength;
-				if(GameClient()->IntersectCharacter(SegmentStartPos, RetractingHookEndPos, HitPos, ClientId, &IntersectedPlayerPosition) != -1)
+				// check if the retracting hook hits a player
+				if(!HookEnteredTelehook)
 				{
-					AddHookPlayerSegment(LineStartPos, SegmentEndPos, IntersectedPlayerPosition, HitPos);
-					break;
+					vec2 RetractingHookEndPos = BasePos + normalize(SegmentEndPos - BasePos) * HookLength;
+					if(GameClient()->IntersectCharacter(SegmentStartPos, RetractingHookEndPos, HitPos, ClientId, &IntersectedPlayerPosition) != -1)
+					{
+						AddHookPlayerSegment(LineStartPos, SegmentEndPos, IntersectedPlayerPosition, HitPos);
+						break;
+					}
 				}
+
+				// the line is too long here, and the hook retracts, use old position
+				vLineSegments.emplace_back(LineStartPos, SegmentStartPos);
+				break;
 			}
 
-			// the line is too long here, and the hook retracts, use old position
-			vLineSegments.emplace_back(LineStartPos, SegmentStartPos);
-			break;
-		}
+			// check for map collisions
+			int Hit = Collision()->IntersectLineTeleHook(SegmentStartPos, SegmentEndPos, &HitPos, nullptr, &Tele);
 
-		// check for map collisions
-		int Hit = Collision()->IntersectLineTeleHook(SegmentStartPos, SegmentEndPos, &HitPos, nullptr, &Tele);
+			// check if we intersect a player
+			if(GameClient()->IntersectCharacter(SegmentStartPos, HitPos, SegmentEndPos, ClientId, &IntersectedPlayerPosition) != -1)
+			{
+				AddHookPlayerSegment(LineStartPos, HitPos, IntersectedPlayerPosition, SegmentEndPos);
+				break;
+			}
 
-		// check if we intersect a player
-		if(GameClient()->IntersectCharacter(SegmentStartPos, HitPos, SegmentEndPos, ClientId, &IntersectedPlayerPosition) != -1)
-		{
-			AddHookPlayerSegment(LineStartPos, HitPos, IntersectedPlayerPosition, SegmentEndPos);
-			break;
-		}
+			// we hit nothing, continue calculating segments
+			if(!Hit)
+			{
+				SegmentStartPos = SegmentEndPos;
+				SegmentStartPos.x = round_to_int(SegmentStartPos.x);
+				SegmentStartPos.y = round_to_int(SegmentStartPos.y);
 
-		// we hit nothing, continue calculating segments
-		if(!Hit)
-		{
-			SegmentStartPos = SegmentEndPos;
+				// direction is always the same after the first tick quantization
+				if(HookTick == 0)
+				{
+					QuantizedDirection.x = round_to_int(QuantizedDirection.x * 256.0f) / 256.0f;
+					QuantizedDirection.y = round_to_int(QuantizedDirection.y * 256.0f) / 256.0f;
+				}
+				continue;
+			}
+
+			// we hit a solid / hook stopper
+			if(Hit != TILE_TELEINHOOK)
+			{
+				if(Hit != TILE_NOHOOK)
+					HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorHookableColl));
+				vLineSegments.emplace_back(LineStartPos, HitPos);
+				break;
+			}
+
+			// we are hitting TILE_TELEINHOOK
+			vLineSegments.emplace_back(LineStartPos, HitPos);
+			HookEnteredTelehook = true;
+
+			// check tele outs
+			const std::vector<vec2> &vTeleOuts = Collision()->TeleOuts(Tele - 1);
+			if(vTeleOuts.empty())
+			{
+				// the hook gets stuck, this is a feature or a bug
+				HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorHookableColl));
+				break;
+			}
+			else if(vTeleOuts.size() > 1)
+			{
+				// we don't know which teleout the hook takes, just invert the color
+				HookCollColor = color_invert(color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorTeeColl)));
+				break;
+			}
+
+			// go through one teleout, update positions and continue
+			BasePos = vTeleOuts[0];
+			LineStartPos = BasePos; // make the line start in the teleporter to prevent a gap
+			SegmentStartPos = BasePos + Direction * HOOK_START_DISTANCE;
 			SegmentStartPos.x = round_to_int(SegmentStartPos.x);
 			SegmentStartPos.y = round_to_int(SegmentStartPos.y);
 
@@ -296,62 +350,28 @@ void CPlayers::RenderHookCollLine(
 				QuantizedDirection.x = round_to_int(QuantizedDirection.x * 256.0f) / 256.0f;
 				QuantizedDirection.y = round_to_int(QuantizedDirection.y * 256.0f) / 256.0f;
 			}
-			continue;
 		}
 
-		// we hit a solid / hook stopper
-		if(Hit != TILE_TELEINHOOK)
+		// The hook line is too expensive to calculate and didn't hit anything before, just set a straight line
+		if(HookTick >= MaxHookTicks && vLineSegments.empty())
 		{
-			if(Hit != TILE_NOHOOK)
-				HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorHookableColl));
-			vLineSegments.emplace_back(LineStartPos, HitPos);
-			break;
-		}
-
-		// we are hitting TILE_TELEINHOOK
-		vLineSegments.emplace_back(LineStartPos, HitPos);
-		HookEnteredTelehook = true;
-
-		// check tele outs
-		const std::vector<vec2> &vTeleOuts = Collision()->TeleOuts(Tele - 1);
-		if(vTeleOuts.empty())
-		{
-			// the hook gets stuck, this is a feature or a bug
-			HookCollColor = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorHookableColl));
-			break;
-		}
-		else if(vTeleOuts.size() > 1)
-		{
-			// we don't know which teleout the hook takes, just invert the color
+			// we simply don't know if we hit anything or not
 			HookCollColor = color_invert(color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorTeeColl)));
-			break;
+			vLineSegments.emplace_back(LineStartPos, BasePos + QuantizedDirection * HookLength);
 		}
 
-		// go through one teleout, update positions and continue
-		BasePos = vTeleOuts[0];
-		LineStartPos = BasePos; // make the line start in the teleporter to prevent a gap
-		SegmentStartPos = BasePos + Direction * HOOK_START_DISTANCE;
-		SegmentStartPos.x = round_to_int(SegmentStartPos.x);
-		SegmentStartPos.y = round_to_int(SegmentStartPos.y);
+		// add a line from the player to the start position to prevent a visual gap
+		vLineSegments.emplace_back(Position, Position + StartOffset);
 
-		// direction is always the same after the first tick quantization
-		if(HookTick == 0)
-		{
-			QuantizedDirection.x = round_to_int(QuantizedDirection.x * 256.0f) / 256.0f;
-			QuantizedDirection.y = round_to_int(QuantizedDirection.y * 256.0f) / 256.0f;
-		}
+		HookCollLine.m_Tick = Tick;
+		HookCollLine.m_Position = RoundedPosition;
+		HookCollLine.m_Angle = RoundedAngle;
+		HookCollLine.m_HookLength = HookLength;
+		HookCollLine.m_HookFireSpeed = HookFireSpeed;
+		HookCollLine.m_Color = HookCollColor;
 	}
-
-	// The hook line is too expensive to calculate and didn't hit anything before, just set a straight line
-	if(HookTick >= MaxHookTicks && vLineSegments.empty())
-	{
-		// we simply don't know if we hit anything or not
-		HookCollColor = color_invert(color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClHookCollColorTeeColl)));
-		vLineSegments.emplace_back(LineStartPos, BasePos + QuantizedDirection * HookLength);
-	}
-
-	// add a line from the player to the start position to prevent a visual gap
-	vLineSegments.emplace_back(Position, Position + StartOffset);
+	const std::vector<IGraphics::CLineItem> &vLineSegments = HookCollLine.m_vLineSegments;
+	ColorRGBA HookCollColor = HookCollLine.m_Color;
 
 	if(AlwaysRenderHookColl && RenderHookCollPlayer)
 	{
@@ -370,8 +390,8 @@ void CPlayers::RenderHookCollLine(
 	Graphics()->TextureClear();
 	if(HookCollSize > 0)
 	{
-		std::vector<IGraphics::CFreeformItem> vLineQuadSegments;
-		vLineQuadSegments.reserve(vLineSegments.size());
+		std::vector<IGraphics::CFreeformItem> &vLineQuadSegments = m_vHookCollQuadSegments;
+		vLineQuadSegments.clear();
 
 		float LineWidth = 0.5f + (float)(HookCollSize - 1) * 0.25f;
 		const vec2 PerpToAngle = normalize(vec2(Direction.y, -Direction.x)) * GameClient()->m_Camera.m_Zoom;
@@ -7,6 +7,8 @@
 #include <game/client/component.h>
 #include <game/client/render.h>
 
+#include <vector>
+
 class CPlayers : public CComponent
 {
 	friend class CGhost;
@@ -40,6 +42,22 @@ class CPlayers : public CComponent
 		int ClientId);
 	bool IsPlayerInfoAvailable(int ClientId) const;
 
+	// The hook collision line of a player is only traced again when
+	// the tick, the rounded position or the aim angle changes
+	class CHookCollLine
+	{
+	public:
+		int m_Tick = -1;
+		ivec2 m_Position;
+		int m_Angle;
+		float m_HookLength;
+		float m_HookFireSpeed;
+		ColorRGBA m_Color;
+		std::vector<IGraphics::CLineItem> m_vLineSegments;
+	};
+	CHookCollLine m_aHookCollLines[MAX_CLIENTS];
+	std::vector<IGraphics::CFreeformItem> m_vHookCollQuadSegments;
+
 	int m_WeaponEmoteQuadContainerIndex;
 	int m_aWeaponSpriteMuzzleQuadContainerIndex[NUM_WEAPONS];
 
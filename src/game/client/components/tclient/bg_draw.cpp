@@ -3,9 +3,12 @@
 #include <base/log.h>
 
 #include <engine/client.h>
+#include <engine/engine.h>
 #include <engine/external/spt.h>
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
+#include <engine/storage.h>
 
 #include <game/client/animstate.h>
 #include <game/client/components/tclient/bg_draw_file.h>
@@ -15,7 +18,8 @@
 
 #include <algorithm>
 #include <array>
-#include <deque>
+#include <cmath>
+#include <unordered_map>
 #include <vector>
 
 #define MAX_ITEMS_TO_LOAD 65536
@@ -66,6 +70,21 @@ public:
 		if(MaxPos.y > m_Max.y)
 			m_Max.y = MaxPos.y;
 	}
+	void ExtendBoundingBox(const CBoundingBox &Other)
+	{
+		if(m_Min == m_Max)
+		{
+			*this = Other;
+			return;
+		}
+		m_Min = vec2(std::min(m_Min.x, Other.m_Min.x), std::min(m_Min.y, Other.m_Min.y));
+		m_Max = vec2(std::max(m_Max.x, Other.m_Max.x), std::max(m_Max.y, Other.m_Max.y));
+	}
+	bool Overlaps(vec2 Min, vec2 Max) const
+	{
+		return m_Min.x <= Max.x && m_Max.x >= Min.x && m_Min.y <= Max.y && m_Max.y >= Min.y;
+	}
+	vec2 Center() const { return (m_Min + m_Max) / 2.0f; }
 };
 
 class CPathContainer
@@ -75,18 +94,6 @@ private:
 	std::vector<int> m_vQuadContainerIndexes;
 	int m_QuadCount = 0;
 	IGraphics &m_Graphics;
-	void Clear()
-	{
-		for(int QuadContainerIndex : m_vQuadContainerIndexes)
-			m_Graphics.DeleteQuadContainer(QuadContainerIndex);
-		m_vQuadContainerIndexes.clear();
-		m_QuadCount = 0;
-	}
-	void Upload()
-	{
-		int &QuadContainerIndex = *(m_vQuadContainerIndexes.end() - 1);
-		m_Graphics.QuadContainerUpload(QuadContainerIndex);
-	}
 	void AddQuads(IGraphics::CFreeformItem *pFreeformItem, int Count, ColorRGBA Color)
 	{
 		m_QuadCount += Count;
@@ -125,9 +132,31 @@ private:
 public:
 	CPathContainer(IGraphics &Graphics) :
 		m_Graphics(Graphics) {}
+	CPathContainer(const CPathContainer &) = delete;
+	CPathContainer &operator=(const CPathContainer &) = delete;
+	void Clear()
+	{
+		for(int QuadContainerIndex : m_vQuadContainerIndexes)
+			m_Graphics.DeleteQuadContainer(QuadContainerIndex);
+		m_vQuadContainerIndexes.clear();
+		m_QuadCount = 0;
+	}
+	void Upload()
+	{
+		if(m_vQuadContainerIndexes.empty())
+			return;
+		int &QuadContainerIndex = *(m_vQuadContainerIndexes.end() - 1);
+		m_Graphics.QuadContainerUpload(QuadContainerIndex);
+	}
 	void Update(const CBgDrawItemData &Data)
 	{
 		Clear();
+		Append(Data);
+		Upload();
+	}
+	// Adds the path to the current containers, call Upload once done
+	void Append(const CBgDrawItemData &Data)
+	{
 		if(Data.size() == 0)
 		{
 			return;
@@ -156,7 +185,6 @@ public:
 			return true;
 		};
 		SPT_prims(SPTGetPt, SPTAddQuad, SPTAddArc);
-		Upload();
 	}
 	void Render()
 	{
@@ -191,17 +219,22 @@ private:
 
 public:
 	bool m_Killed = false;
-	float m_SecondsAge = 0.0f;
+	// Set once the item is finished and moved into the grid
+	bool m_Indexed = false;
+	int64_t m_CellKey = 0;
+	float m_FinishTime = 0.0f;
 
 	const CBgDrawItemData &Data() const { return m_Data; }
 	const CBoundingBox &BoundingBox() const { return m_BoundingBox; }
+	bool Drawing() const { return m_Drawing; }
 
 	bool PenUp(const CBgDrawItemDataPoint &Point)
 	{
 		if(!m_Drawing)
 			return false;
 		m_Drawing = false;
-		m_PathContainer.Update(m_Data);
+		// Finished items are rendered from the shared containers of their grid cell
+		m_PathContainer.Clear();
 		return true;
 	}
 	bool PenUp(vec2 Pos)
@@ -218,6 +251,7 @@ public:
 			*(m_Data.end() - 1) = Point;
 		else
 			m_Data.emplace_back(Point);
+		m_BoundingBox.ExtendBoundingBox(Point.Pos(), Point.w);
 		m_PathContainer.Update(m_Data);
 		return true;
 	}
@@ -286,16 +320,163 @@ public:
 		m_Data.clear();
 		m_Data.push_back(StartPoint);
 	}
+	// Loaded items are already simplified and finished, no geometry is built here
 	CBgDrawItem(CGameClient &This, const CBgDrawItemData &Data) :
 		CBgDrawItem(This, Data[0])
 	{
-		if(Data.size() > 1)
-			for(auto It = Data.begin() + 1; It != Data.end() - 1; ++It)
+		m_Data = Data;
+		if((int)m_Data.size() > BG_DRAW_MAX_POINTS_PER_ITEM + 1)
+			m_Data.erase(m_Data.begin() + BG_DRAW_MAX_POINTS_PER_ITEM + 1, m_Data.end());
+		for(const CBgDrawItemDataPoint &Point : m_Data)
+			m_BoundingBox.ExtendBoundingBox(Point.Pos(), Point.w);
+		m_Drawing = false;
+	}
+};
+
+// Finished items bucketed by the cell of their bounding box center. Each
+// cell merges the geometry of its items into a few batches of shared quad
+// containers, so erasing an item only rebuilds the batch it was part of.
+// Cells and batches keep the union of their bounding boxes for culling and
+// erase queries.
+class CBgDrawGrid
+{
+public:
+	static constexpr float CELL_SIZE = 1024.0f;
+	static constexpr int MAX_ITEMS_PER_BATCH = 32;
+
+	class CBatch
+	{
+	public:
+		std::vector<CBgDrawItem *> m_vpItems;
+		CPathContainer m_PathContainer;
+		CBoundingBox m_BoundingBox;
+		bool m_Dirty = true;
+
+		CBatch(IGraphics &Graphics) :
+			m_PathContainer(Graphics) {}
+
+		void Rebuild()
+		{
+			m_PathContainer.Clear();
+			m_BoundingBox = CBoundingBox();
+			for(const CBgDrawItem *pItem : m_vpItems)
+			{
+				m_PathContainer.Append(pItem->Data());
+				m_BoundingBox.ExtendBoundingBox(pItem->BoundingBox());
+			}
+			m_PathContainer.Upload();
+			m_Dirty = false;
+		}
+	};
+
+	class CCell
+	{
+	public:
+		std::vector<std::unique_ptr<CBatch>> m_vpBatches;
+		CBoundingBox m_BoundingBox;
+	};
+
+private:
+	IGraphics &m_Graphics;
+	std::unordered_map<int64_t, CCell> m_Cells;
+
+	static int64_t CellKey(vec2 Pos)
+	{
+		const int64_t X = (int32_t)std::floor(Pos.x / CELL_SIZE);
+		const int64_t Y = (int32_t)std::floor(Pos.y / CELL_SIZE);
+		return (X << 32) | (uint32_t)Y;
+	}
+
+public:
+	CBgDrawGrid(IGraphics &Graphics) :
+		m_Graphics(Graphics) {}
+
+	void Insert(CBgDrawItem &Item)
+	{
+		Item.m_CellKey = CellKey(Item.BoundingBox().Center());
+		Item.m_Indexed = true;
+		CCell &Cell = m_Cells[Item.m_CellKey];
+		if(Cell.m_vpBatches.empty() || (int)Cell.m_vpBatches.back()->m_vpItems.size() >= MAX_ITEMS_PER_BATCH)
+			Cell.m_vpBatches.push_back(std::make_unique<CBatch>(m_Graphics));
+		CBatch &Batch = *Cell.m_vpBatches.back();
+		Batch.m_vpItems.push_back(&Item);
+		Batch.m_BoundingBox.ExtendBoundingBox(Item.BoundingBox());
+		Batch.m_Dirty = true;
+		Cell.m_BoundingBox.ExtendBoundingBox(Item.BoundingBox());
+	}
+	void Remove(CBgDrawItem &Item)
+	{
+		if(!Item.m_Indexed)
+			return;
+		Item.m_Indexed = false;
+		auto CellIt = m_Cells.find(Item.m_CellKey);
+		if(CellIt == m_Cells.end())
+			return;
+		// The bounding boxes only shrink once the batch is rebuilt
+		std::vector<std::unique_ptr<CBatch>> &vpBatches = CellIt->second.m_vpBatches;
+		for(auto BatchIt = vpBatches.begin(); BatchIt != vpBatches.end(); ++BatchIt)
+		{
+			std::vector<CBgDrawItem *> &vpItems = (*BatchIt)->m_vpItems;
+			auto ItemIt = std::find(vpItems.begin(), vpItems.end(), &Item);
+			if(ItemIt == vpItems.end())
+				continue;
+			vpItems.erase(ItemIt);
+			if(vpItems.empty())
+				vpBatches.erase(BatchIt);
+			else
+				(*BatchIt)->m_Dirty = true;
+			break;
+		}
+		if(vpBatches.empty())
+			m_Cells.erase(CellIt);
+	}
+	void Clear()
+	{
+		m_Cells.clear();
+	}
+	template<typename F>
+	void ForEachItem(vec2 Min, vec2 Max, F &&Func)
+	{
+		for(auto &[Key, Cell] : m_Cells)
+		{
+			if(!Cell.m_BoundingBox.Overlaps(Min, Max))
+				continue;
+			for(const std::unique_ptr<CBatch> &pBatch : Cell.m_vpBatches)
 			{
-				const CBgDrawItemDataPoint &Point = *It;
-				MoveTo(Point);
+				if(!pBatch->m_BoundingBox.Overlaps(Min, Max))
+					continue;
+				for(CBgDrawItem *pItem : pBatch->m_vpItems)
+					if(pItem->BoundingBox().Overlaps(Min, Max))
+						Func(*pItem);
 			}
-		PenUp(Data.back());
+		}
+	}
+	// Dirty batches are only rebuilt once they are on screen
+	void Render(vec2 Min, vec2 Max)
+	{
+		for(auto &[Key, Cell] : m_Cells)
+		{
+			if(!Cell.m_BoundingBox.Overlaps(Min, Max))
+				continue;
+			bool Rebuilt = false;
+			for(const std::unique_ptr<CBatch> &pBatch : Cell.m_vpBatches)
+			{
+				if(!pBatch->m_BoundingBox.Overlaps(Min, Max))
+					continue;
+				if(pBatch->m_Dirty)
+				{
+					pBatch->Rebuild();
+					Rebuilt = true;
+				}
+				pBatch->m_PathContainer.Render();
+			}
+			if(Rebuilt)
+			{
+				Cell.m_BoundingBox = CBoundingBox();
+				for(const std::unique_ptr<CBatch> &pBatch : Cell.m_vpBatches)
+					Cell.m_BoundingBox.ExtendBoundingBox(pBatch->m_BoundingBox);
+			}
+		}
 	}
 };
 
@@ -336,31 +517,116 @@ void CBgDraw::ConBgDrawLoad(IConsole::IResult *pResult, void *pUserData)
 	pThis->Load(pResult->GetString(0), true);
 }
 
-static IOHANDLE BgDrawOpenFile(CGameClient &This, const char *pFilename, int Flags)
+// Writes a snapshot of the drawings in the binary format, first to a
+// temporary file which then replaces the old save
+class CBgDrawSaveJob : public IJob
+{
+	IStorage *m_pStorage;
+	char m_aFilename[IO_MAX_PATH_LENGTH];
+	std::vector<CBgDrawItemData> m_vItems;
+	bool m_Compress;
+	std::atomic<bool> m_Success = false;
+
+protected:
+	void Run() override
+	{
+		std::vector<unsigned char> vData;
+		BgDrawFile::WriteBinary(vData, m_vItems, m_Compress);
+
+		char aTempFilename[IO_MAX_PATH_LENGTH];
+		IStorage::FormatTmpPath(aTempFilename, sizeof(aTempFilename), m_aFilename);
+		IOHANDLE File = m_pStorage->OpenFile(aTempFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(!File)
+		{
+			log_error("bgdraw", "failed to open '%s' for writing", aTempFilename);
+			return;
+		}
+		const bool Written = io_write(File, vData.data(), vData.size()) == vData.size();
+		io_close(File);
+		if(!Written)
+		{
+			log_error("bgdraw", "failed to write '%s'", aTempFilename);
+			m_pStorage->RemoveFile(aTempFilename, IStorage::TYPE_SAVE);
+			return;
+		}
+		// Replaces the old save, which stays intact if anything fails
+		if(!m_pStorage->RenameFile(aTempFilename, m_aFilename, IStorage::TYPE_SAVE))
+		{
+			log_error("bgdraw", "failed to rename '%s' to '%s'", aTempFilename, m_aFilename);
+			return;
+		}
+		m_Success = true;
+	}
+
+public:
+	CBgDrawSaveJob(IStorage *pStorage, const char *pFilename, std::vector<CBgDrawItemData> &&vItems, bool Compress) :
+		m_pStorage(pStorage), m_vItems(std::move(vItems)), m_Compress(Compress)
+	{
+		str_copy(m_aFilename, pFilename);
+	}
+	bool Success() const { return m_Success; }
+	const char *Filename() const { return m_aFilename; }
+	int NumItems() const { return m_vItems.size(); }
+};
+
+// Extension is appended unless the name already has ".csv" or ".bgd"
+static void BgDrawFilename(CGameClient &This, const char *pFilename, const char *pExtension, char *pBuf, int BufSize)
 {
-	char aFilename[IO_MAX_PATH_LENGTH];
 	if(pFilename && pFilename[0] != '\0')
 	{
-		if(str_endswith_nocase(pFilename, ".csv"))
-			str_format(aFilename, sizeof(aFilename), "bgdraw/%s", pFilename);
+		if(str_endswith_nocase(pFilename, ".csv") || str_endswith_nocase(pFilename, ".bgd"))
+			str_format(pBuf, BufSize, "bgdraw/%s", pFilename);
 		else
-			str_format(aFilename, sizeof(aFilename), "bgdraw/%s.csv", pFilename);
+			str_format(pBuf, BufSize, "bgdraw/%s%s", pFilename, pExtension);
 	}
 	else
 	{
 		SHA256_DIGEST Sha256 = This.Client()->GetCurrentMapSha256();
 		char aSha256[SHA256_MAXSTRSIZE];
 		sha256_str(Sha256, aSha256, sizeof(aSha256));
-		str_format(aFilename, sizeof(aFilename), "bgdraw/%s_%s.csv", This.Client()->GetCurrentMap(), aSha256);
+		str_format(pBuf, BufSize, "bgdraw/%s_%s%s", This.Client()->GetCurrentMap(), aSha256, pExtension);
+	}
+}
+
+static bool BgDrawCreateFolder(CGameClient &This)
+{
+	if(This.Storage()->CreateFolder("bgdraw", IStorage::TYPE_SAVE))
+		return true;
+	This.Echo(TCLocalize("Failed to create bgdraw folder", "bgdraw"));
+	return false;
+}
+
+void CBgDraw::UpdateSaveJob()
+{
+	if(m_pSaveJob)
+	{
+		if(!m_pSaveJob->Done())
+			return;
+		if(!m_pSaveJob->Success())
+		{
+			char aMsg[256];
+			str_format(aMsg, sizeof(aMsg), TCLocalize("Writing '%s' failed", "bgdraw"), m_pSaveJob->Filename());
+			GameClient()->Echo(aMsg);
+			m_Dirty = true;
+		}
+		m_pSaveJob = nullptr;
+	}
+	if(!m_vpQueuedSaveJobs.empty())
+	{
+		m_pSaveJob = m_vpQueuedSaveJobs.front();
+		m_vpQueuedSaveJobs.erase(m_vpQueuedSaveJobs.begin());
+		Engine()->AddJob(m_pSaveJob);
 	}
-	dbg_assert(Flags == IOFLAG_WRITE || Flags == IOFLAG_READ, "Flags must be either read or write");
-	if(Flags == IOFLAG_WRITE)
+}
+
+void CBgDraw::FinishSaveJobs()
+{
+	while(m_pSaveJob)
 	{
-		// Create folder
-		if(!This.Storage()->CreateFolder("bgdraw", IStorage::TYPE_SAVE))
-			This.Echo(TCLocalize("Failed to create bgdraw folder", "bgdraw"));
+		while(!m_pSaveJob->Done())
+			thread_yield();
+		UpdateSaveJob();
 	}
-	return This.Storage()->OpenFile(aFilename, Flags, IStorage::TYPE_SAVE);
 }
 
 bool CBgDraw::Save(const char *pFilename, bool Verbose)
@@ -377,58 +643,135 @@ bool CBgDraw::Save(const char *pFilename, bool Verbose)
 			GameClient()->Echo(TCLocalize("No changes since last save", "bgdraw"));
 		return false;
 	}
-	m_Dirty = false;
-	IOHANDLE Handle = BgDrawOpenFile(*GameClient(), pFilename, IOFLAG_WRITE);
-	if(!Handle)
+	if(!BgDrawCreateFolder(*GameClient()))
 		return false;
-	int Written = 0;
-	bool Success = true;
+
+	char aFilename[IO_MAX_PATH_LENGTH];
 	char aMsg[256];
-	for(const CBgDrawItem &Item : *m_pvItems)
+	BgDrawFilename(*GameClient(), pFilename, ".bgd", aFilename, sizeof(aFilename));
+	if(str_endswith_nocase(aFilename, ".csv"))
 	{
-		if(!BgDrawFile::Write(Handle, Item.Data()))
+		// Text export, written directly
+		IOHANDLE Handle = Storage()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(!Handle)
+			return false;
+		m_Dirty = false;
+		int Written = 0;
+		bool Success = true;
+		for(const CBgDrawItem &Item : *m_pvItems)
 		{
-			str_format(aMsg, sizeof(aMsg), TCLocalize("Writing item %d failed", "bgdraw"), Written);
+			if(!BgDrawFile::Write(Handle, Item.Data()))
+			{
+				str_format(aMsg, sizeof(aMsg), TCLocalize("Writing item %d failed", "bgdraw"), Written);
+				GameClient()->Echo(aMsg);
+				Success = false;
+				break;
+			}
+			Written += 1;
+		}
+		if(Verbose || !Success)
+		{
+			str_format(aMsg, sizeof(aMsg), TCLocalize("Written %d items", "bgdraw"), Written);
 			GameClient()->Echo(aMsg);
-			Success = false;
-			break;
 		}
-		Written += 1;
+		io_close(Handle);
+		return Success;
 	}
-	if(Verbose || !Success)
+
+	m_Dirty = false;
+	std::vector<CBgDrawItemData> vItems;
+	vItems.reserve(m_pvItems->size());
+	for(const CBgDrawItem &Item : *m_pvItems)
+		vItems.push_back(Item.Data());
+	std::shared_ptr<CBgDrawSaveJob> pJob = std::make_shared<CBgDrawSaveJob>(Storage(), aFilename, std::move(vItems), g_Config.m_TcBgDrawCompress);
+	if(Verbose)
 	{
-		str_format(aMsg, sizeof(aMsg), TCLocalize("Written %d items", "bgdraw"), Written);
+		str_format(aMsg, sizeof(aMsg), TCLocalize("Writing %d items", "bgdraw"), pJob->NumItems());
 		GameClient()->Echo(aMsg);
 	}
-	io_close(Handle);
-	return Success;
+	if(m_pSaveJob)
+	{
+		// Saves only overlap when leaving a server right after saving or saving
+		// manually, the items are copied now and written once the file is free
+		auto It = std::find_if(m_vpQueuedSaveJobs.begin(), m_vpQueuedSaveJobs.end(), [&](const std::shared_ptr<CBgDrawSaveJob> &pQueued) {
+			return str_comp(pQueued->Filename(), aFilename) == 0;
+		});
+		if(It != m_vpQueuedSaveJobs.end())
+			*It = pJob;
+		else
+			m_vpQueuedSaveJobs.push_back(pJob);
+	}
+	else
+	{
+		m_pSaveJob = pJob;
+		Engine()->AddJob(m_pSaveJob);
+	}
+	return true;
 }
 
 bool CBgDraw::Load(const char *pFilename, bool Verbose)
 {
 	if(Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
 		return false;
-	IOHANDLE Handle = BgDrawOpenFile(*GameClient(), pFilename, IOFLAG_READ);
-	if(!Handle)
+
+	// A save that is still being written could be the file we are about to read
+	FinishSaveJobs();
+
+	// Prefer the binary save, fall back to importing the text format
+	char aFilename[IO_MAX_PATH_LENGTH];
+	BgDrawFilename(*GameClient(), pFilename, ".bgd", aFilename, sizeof(aFilename));
+	if(!Storage()->FileExists(aFilename, IStorage::TYPE_SAVE))
+		BgDrawFilename(*GameClient(), pFilename, ".csv", aFilename, sizeof(aFilename));
+
+	void *pData;
+	unsigned DataSize;
+	if(!Storage()->ReadFile(aFilename, IStorage::TYPE_SAVE, &pData, &DataSize))
 		return false;
-	std::deque<CBgDrawItemData> Queue;
+
+	std::vector<CBgDrawItemData> vItems;
 	int ItemsLoaded = 0;
 	int ItemsDiscarded = 0;
+	const size_t MaxItems = g_Config.m_TcBgDrawMaxItems;
+	if(BgDrawFile::IsBinary((const unsigned char *)pData, DataSize))
 	{
-		CBgDrawItemData Data;
-		while(BgDrawFile::Read(Handle, Data) && (ItemsLoaded++) < MAX_ITEMS_TO_LOAD)
+		if(!BgDrawFile::ReadBinary((const unsigned char *)pData, DataSize, vItems, MAX_ITEMS_TO_LOAD))
 		{
-			if((int)Queue.size() > g_Config.m_TcBgDrawMaxItems)
-			{
-				ItemsDiscarded += 1;
-				Queue.pop_front();
-			}
-			Queue.push_back(Data);
+			free(pData);
+			char aMsg[256];
+			str_format(aMsg, sizeof(aMsg), TCLocalize("Failed to read '%s'", "bgdraw"), aFilename);
+			GameClient()->Echo(aMsg);
+			return false;
 		}
+		ItemsLoaded = vItems.size();
+	}
+	else
+	{
+		const char *pCur = (const char *)pData;
+		const char *pEnd = pCur + DataSize;
+		auto ReadLine = [&](char *pBuf, int Length) -> bool {
+			if(pCur >= pEnd)
+				return false;
+			const char *pLineEnd = std::find(pCur, pEnd, '\n');
+			str_truncate(pBuf, Length, pCur, pLineEnd - pCur);
+			int Len = str_length(pBuf);
+			while(Len > 0 && pBuf[Len - 1] == '\r')
+				pBuf[--Len] = '\0';
+			pCur = pLineEnd == pEnd ? pEnd : pLineEnd + 1;
+			return true;
+		};
+		CBgDrawItemData Data;
+		while(BgDrawFile::Read(ReadLine, Data) && (ItemsLoaded++) < MAX_ITEMS_TO_LOAD)
+			vItems.push_back(Data);
 	}
-	io_close(Handle);
-	MakeSpaceFor(Queue.size());
-	for(const CBgDrawItemData &Data : Queue)
+	free(pData);
+
+	if(vItems.size() > MaxItems)
+	{
+		ItemsDiscarded = vItems.size() - MaxItems;
+		vItems.erase(vItems.begin(), vItems.begin() + ItemsDiscarded);
+	}
+	MakeSpaceFor(vItems.size());
+	for(const CBgDrawItemData &Data : vItems)
 		AddItem(*GameClient(), Data);
 	if(Verbose)
 	{
@@ -451,29 +794,45 @@ CBgDrawItem *CBgDraw::AddItem(T &&...Aargs)
 		return nullptr;
 	m_pvItems->emplace_back(std::forward<T>(Aargs)...);
 	m_Dirty = true;
-	return &m_pvItems->back();
+	CBgDrawItem &Item = m_pvItems->back();
+	if(!Item.Drawing())
+		FinishItem(Item);
+	return &Item;
+}
+
+void CBgDraw::FinishItem(CBgDrawItem &Item)
+{
+	if(Item.m_Indexed)
+		return;
+	Item.m_FinishTime = Client()->LocalTime();
+	// Keep finished items in the order they finished, which fading relies on.
+	// Items being finished were started recently, so search from the back
+	auto It = std::find_if(m_pvItems->rbegin(), m_pvItems->rend(), [&](const CBgDrawItem &Other) { return &Other == &Item; });
+	m_pvItems->splice(m_pvItems->end(), *m_pvItems, std::prev(It.base()));
+	m_pGrid->Insert(Item);
+}
+
+void CBgDraw::RemoveItem(std::list<CBgDrawItem>::iterator It)
+{
+	// Prevent floating pointer
+	for(std::optional<CBgDrawItem *> &ActiveItem : m_apActiveItems)
+		if(ActiveItem.value_or(nullptr) == &*It)
+			ActiveItem = std::nullopt;
+	m_pGrid->Remove(*It);
+	m_pvItems->erase(It);
 }
 
 void CBgDraw::MakeSpaceFor(int Count)
 {
 	if(g_Config.m_TcBgDrawMaxItems == 0 || Count >= g_Config.m_TcBgDrawMaxItems)
 	{
+		m_apActiveItems.fill(std::nullopt);
+		m_pGrid->Clear();
 		m_pvItems->clear();
 		return;
 	}
 	while((int)m_pvItems->size() + Count > g_Config.m_TcBgDrawMaxItems)
-	{
-		// Prevent floating pointer
-		for(std::optional<CBgDrawItem *> &ActiveItem : m_apActiveItems)
-		{
-			if(!ActiveItem.has_value())
-				continue;
-			if(ActiveItem.value() != &(*m_pvItems->begin()))
-				continue;
-			ActiveItem = std::nullopt;
-		}
-		m_pvItems->pop_front();
-	}
+		RemoveItem(m_pvItems->begin());
 }
 
 void CBgDraw::OnConsoleInit()
@@ -481,12 +840,15 @@ void CBgDraw::OnConsoleInit()
 	Console()->Register("+bg_draw", "", CFGFLAG_CLIENT, ConBgDraw, this, "Draw on the in game background");
 	Console()->Register("+bg_draw_erase", "", CFGFLAG_CLIENT, ConBgDrawErase, this, "Erase items on the in game background");
 	Console()->Register("bg_draw_reset", "", CFGFLAG_CLIENT, ConBgDrawReset, this, "Reset all drawings on the background");
-	Console()->Register("bg_draw_save", "?r[filename]", CFGFLAG_CLIENT, ConBgDrawSave, this, "Save drawings to a given csv file (defaults to map name)");
-	Console()->Register("bg_draw_load", "?r[filename]", CFGFLAG_CLIENT, ConBgDrawLoad, this, "Load drawings from a given csv file (defaults to map name)");
+	Console()->Register("bg_draw_save", "?r[filename]", CFGFLAG_CLIENT, ConBgDrawSave, this, "Save drawings to a given file, .csv saves as text (defaults to map name)");
+	Console()->Register("bg_draw_load", "?r[filename]", CFGFLAG_CLIENT, ConBgDrawLoad, this, "Load drawings from a given .bgd or .csv file (defaults to map name)");
 }
 
 void CBgDraw::OnRender()
 {
+	// Also start queued saves after leaving a server
+	UpdateSaveJob();
+
 	if(Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
 		return;
 
@@ -495,7 +857,8 @@ void CBgDraw::OnRender()
 	float Delta = Client()->RenderFrameTime();
 
 	m_NextAutoSave -= Delta;
-	if(m_NextAutoSave < 0)
+	// Autosave once the previous save is written, retried every frame until then
+	if(m_NextAutoSave < 0 && !m_pSaveJob)
 	{
 		if(g_Config.m_TcBgDrawAutoSaveLoad)
 			Save(nullptr, false);
@@ -518,27 +881,41 @@ void CBgDraw::OnRender()
 				(*ActiveItem)->MoveTo(Pos);
 			else
 				ActiveItem = AddItem(*GameClient(), Pos);
+			// Items stop drawing on their own once they reach the point limit
+			if(ActiveItem.value_or(nullptr) && !(*ActiveItem)->Drawing())
+				FinishItem(**ActiveItem);
 			m_Dirty = true;
 		}
 		else if(ActiveItem.has_value())
 		{
 			(*ActiveItem)->PenUp(Pos);
+			FinishItem(**ActiveItem);
 			ActiveItem = std::nullopt;
 		}
 		std::optional<vec2> &LastPos = m_aLastPos[Dummy];
 		if(Input == InputMode::ERASE)
 		{
+			// Only items whose bounding box is near the eraser are tested
+			const auto EraseNear = [&](vec2 Min, vec2 Max, const auto &Intersects) {
+				m_pGrid->ForEachItem(Min, Max, [&](CBgDrawItem &Item) {
+					if(Intersects(Item))
+						Item.m_Killed = true;
+				});
+				for(const std::optional<CBgDrawItem *> &Active : m_apActiveItems)
+					if(Active.value_or(nullptr) && !(*Active)->m_Indexed && Intersects(**Active))
+						(*Active)->m_Killed = true;
+			};
 			if(LastPos.has_value())
 			{
-				for(CBgDrawItem &Item : *m_pvItems)
-					if(Item.LineIntersect(*LastPos, Pos))
-						Item.m_Killed = true;
+				const vec2 A = *LastPos;
+				EraseNear(vec2(std::min(A.x, Pos.x), std::min(A.y, Pos.y)), vec2(std::max(A.x, Pos.x), std::max(A.y, Pos.y)),
+					[&](const CBgDrawItem &Item) { return Item.LineIntersect(A, Pos); });
 			}
 			else
 			{
-				for(CBgDrawItem &Item : *m_pvItems)
-					if(Item.PointIntersect(Pos, 2.0f))
-						Item.m_Killed = true;
+				const float Radius = 2.0f;
+				EraseNear(Pos - vec2(Radius, Radius), Pos + vec2(Radius, Radius),
+					[&](const CBgDrawItem &Item) { return Item.PointIntersect(Pos, Radius); });
 			}
 		}
 		else
@@ -548,32 +925,38 @@ void CBgDraw::OnRender()
 	}
 	// Remove extra items
 	MakeSpaceFor(0);
-	// Update age of items, delete old items, render items
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
-	for(CBgDrawItem &Item : *m_pvItems)
+	// Fade out old items. Finished items are kept in the order they finished,
+	// so only the oldest ones need to be looked at
+	if(g_Config.m_TcBgDrawFadeTime > 0)
 	{
-		// If this item is currently active
-		if(std::any_of(std::begin(m_apActiveItems), std::end(m_apActiveItems), [&](const std::optional<CBgDrawItem *> &ActiveItem) {
-			   return ActiveItem.value_or(nullptr) == &Item;
-		   }))
+		const float Now = Client()->LocalTime();
+		for(CBgDrawItem &Item : *m_pvItems)
 		{
-			Item.m_SecondsAge = 0.0f;
+			if(!Item.m_Indexed)
+				continue;
+			if(Now - Item.m_FinishTime <= (float)g_Config.m_TcBgDrawFadeTime)
+				break;
+			Item.m_Killed = true;
 		}
-		else
+	}
+	// Remove killed items
+	for(auto It = m_pvItems->begin(); It != m_pvItems->end();)
+	{
+		if(It->m_Killed)
 		{
-			Item.m_SecondsAge += Delta;
-			if(g_Config.m_TcBgDrawFadeTime > 0 && Item.m_SecondsAge > (float)g_Config.m_TcBgDrawFadeTime)
-				Item.m_Killed = true;
+			RemoveItem(It++);
+			m_Dirty = true;
 		}
-		const bool InRangeX = Item.BoundingBox().m_Min.x < ScreenX1 || Item.BoundingBox().m_Max.x > ScreenX0;
-		const bool InRangeY = Item.BoundingBox().m_Min.y < ScreenY1 || Item.BoundingBox().m_Max.y > ScreenY0;
-		if(InRangeX && InRangeY)
-			Item.Render();
+		else
+			++It;
 	}
-	// Remove killed items
-	if(m_pvItems->remove_if([&](CBgDrawItem &Item) { return Item.m_Killed; }))
-		m_Dirty = true;
+	// Render visible cells and the items still being drawn
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	m_pGrid->Render(vec2(ScreenX0, ScreenY0), vec2(ScreenX1, ScreenY1));
+	for(const std::optional<CBgDrawItem *> &ActiveItem : m_apActiveItems)
+		if(ActiveItem.value_or(nullptr) && (*ActiveItem)->Drawing())
+			(*ActiveItem)->Render();
 	Graphics()->SetColor(ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
 }
 
@@ -582,6 +965,7 @@ void CBgDraw::Reset()
 	m_aInputData.fill(InputMode::NONE);
 	m_aLastPos.fill(std::nullopt);
 	m_apActiveItems.fill(std::nullopt);
+	m_pGrid->Clear();
 	m_pvItems->clear();
 }
 
@@ -607,6 +991,7 @@ void CBgDraw::OnStateChange(int NewState, int OldState)
 
 void CBgDraw::OnShutdown()
 {
+	FinishSaveJobs();
 	Reset();
 }
 
@@ -615,7 +1000,13 @@ CBgDraw::CBgDraw() :
 {
 }
 
+void CBgDraw::OnInit()
+{
+	m_pGrid = new CBgDrawGrid(*Graphics());
+}
+
 CBgDraw::~CBgDraw()
 {
+	delete m_pGrid;
 	delete m_pvItems;
 }
@@ -8,11 +8,15 @@
 
 #include <array>
 #include <list>
+#include <memory>
 #include <optional>
+#include <vector>
 
 #define BG_DRAW_MAX_POINTS_PER_ITEM 1024
 
+class CBgDrawGrid;
 class CBgDrawItem;
+class CBgDrawSaveJob;
 
 class CBgDraw : public CComponent
 {
@@ -22,6 +26,10 @@ private:
 	std::array<std::optional<CBgDrawItem *>, NUM_DUMMIES> m_apActiveItems;
 	std::array<std::optional<vec2>, NUM_DUMMIES> m_aLastPos;
 	std::list<CBgDrawItem> *m_pvItems;
+	CBgDrawGrid *m_pGrid = nullptr;
+	std::shared_ptr<CBgDrawSaveJob> m_pSaveJob;
+	// Saves requested while another one is written, started in order
+	std::vector<std::shared_ptr<CBgDrawSaveJob>> m_vpQueuedSaveJobs;
 	static void ConBgDraw(IConsole::IResult *pResult, void *pUserData);
 	static void ConBgDrawErase(IConsole::IResult *pResult, void *pUserData);
 	static void ConBgDrawReset(IConsole::IResult *pResult, void *pUserData);
@@ -30,9 +38,13 @@ private:
 	void Reset();
 	bool Save(const char *pFile, bool Verbose);
 	bool Load(const char *pFile, bool Verbose);
+	void UpdateSaveJob();
+	void FinishSaveJobs();
 	template<typename... T>
 	CBgDrawItem *AddItem(T &&...Args);
 	void MakeSpaceFor(int Count);
+	void FinishItem(CBgDrawItem &Item);
+	void RemoveItem(std::list<CBgDrawItem>::iterator It);
 
 public:
 	enum class InputMode
@@ -45,6 +57,7 @@ public:
 
 	int Sizeof() const override { return sizeof(*this); }
 	void OnConsoleInit() override;
+	void OnInit() override;
 	void OnRender() override;
 	void OnStateChange(int NewState, int OldState) override;
 	void OnMapLoad() override;
@@ -1,9 +1,21 @@
 #include "bg_draw_file.h"
 
+#include <cmath>
+#include <cstdint>
 #include <cstring>
 
+#include <zlib.h>
+
 #define MAX_LINE_LENGTH 256
 #define MAX_PARTS_PER_ITEM 4096
+#define MAX_BINARY_UNCOMPRESSED_SIZE (64 * 1024 * 1024)
+
+// Header: "TCBD", u8 version, u8 flags, u32 item count, u32 payload size, u32 stored size (little endian)
+static const unsigned char BINARY_MAGIC[4] = {'T', 'C', 'B', 'D'};
+static constexpr unsigned char BINARY_VERSION = 1;
+static constexpr unsigned char BINARY_FLAG_ZLIB = 1;
+static constexpr size_t BINARY_HEADER_SIZE = 18;
+static constexpr float BINARY_POS_SCALE = 16.0f;
 
 bool BgDrawFile::Write(const std::function<bool(const char *)> &WriteLine, const CBgDrawItemData &Data)
 {
@@ -64,3 +76,180 @@ bool BgDrawFile::Read(FILE *pFile, CBgDrawItemData &Data)
 	};
 	return Read(ReadLine, Data);
 }
+
+static void WriteU32(unsigned char *pOut, uint32_t Value)
+{
+	for(int i = 0; i < 4; i++)
+		pOut[i] = (Value >> (i * 8)) & 0xff;
+}
+
+static uint32_t ReadU32(const unsigned char *pIn)
+{
+	return pIn[0] | (pIn[1] << 8) | (pIn[2] << 16) | ((uint32_t)pIn[3] << 24);
+}
+
+static void WriteVarint(std::vector<unsigned char> &vOut, int32_t Value)
+{
+	// zigzag so small negative deltas stay small
+	uint32_t Encoded = ((uint32_t)Value << 1) ^ (uint32_t)(Value >> 31);
+	while(Encoded >= 0x80)
+	{
+		vOut.push_back((Encoded & 0x7f) | 0x80);
+		Encoded >>= 7;
+	}
+	vOut.push_back(Encoded);
+}
+
+static bool ReadVarint(const unsigned char *&pData, const unsigned char *pEnd, int32_t &Value)
+{
+	uint32_t Encoded = 0;
+	for(int Shift = 0; Shift < 35; Shift += 7)
+	{
+		if(pData >= pEnd)
+			return false;
+		const unsigned char Current = *pData++;
+		Encoded |= (uint32_t)(Current & 0x7f) << Shift;
+		if(!(Current & 0x80))
+		{
+			Value = (int32_t)(Encoded >> 1) ^ -(int32_t)(Encoded & 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+static int32_t Quantize(float Value)
+{
+	return (int32_t)std::lround(std::fmax(std::fmin(Value * BINARY_POS_SCALE, 1e9f), -1e9f));
+}
+
+static unsigned char QuantizeColor(float Value)
+{
+	return (unsigned char)std::lround(std::fmax(std::fmin(Value, 1.0f), 0.0f) * 255.0f);
+}
+
+bool BgDrawFile::IsBinary(const unsigned char *pData, size_t Size)
+{
+	return Size >= sizeof(BINARY_MAGIC) && std::memcmp(pData, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+
+void BgDrawFile::WriteBinary(std::vector<unsigned char> &vOut, const std::vector<CBgDrawItemData> &vItems, bool Compress)
+{
+	std::vector<unsigned char> vPayload;
+	for(const CBgDrawItemData &Data : vItems)
+	{
+		WriteVarint(vPayload, (int32_t)Data.size());
+		int32_t LastX = 0, LastY = 0, LastW = 0;
+		unsigned char aLastColor[4] = {0, 0, 0, 0};
+		bool First = true;
+		for(const CBgDrawItemDataPoint &Point : Data)
+		{
+			const int32_t X = Quantize(Point.x);
+			const int32_t Y = Quantize(Point.y);
+			const int32_t W = Quantize(Point.w);
+			WriteVarint(vPayload, X - LastX);
+			WriteVarint(vPayload, Y - LastY);
+			WriteVarint(vPayload, W - LastW);
+			LastX = X;
+			LastY = Y;
+			LastW = W;
+
+			const unsigned char aColor[4] = {QuantizeColor(Point.r), QuantizeColor(Point.g), QuantizeColor(Point.b), QuantizeColor(Point.a)};
+			const bool ColorChanged = First || std::memcmp(aColor, aLastColor, sizeof(aColor)) != 0;
+			vPayload.push_back(ColorChanged ? 1 : 0);
+			if(ColorChanged)
+			{
+				vPayload.insert(vPayload.end(), std::begin(aColor), std::end(aColor));
+				std::memcpy(aLastColor, aColor, sizeof(aColor));
+			}
+			First = false;
+		}
+	}
+
+	unsigned char Flags = 0;
+	std::vector<unsigned char> vCompressed;
+	if(Compress && !vPayload.empty())
+	{
+		uLongf CompressedSize = compressBound(vPayload.size());
+		vCompressed.resize(CompressedSize);
+		if(compress2(vCompressed.data(), &CompressedSize, vPayload.data(), vPayload.size(), Z_DEFAULT_COMPRESSION) == Z_OK && CompressedSize < vPayload.size())
+		{
+			vCompressed.resize(CompressedSize);
+			Flags |= BINARY_FLAG_ZLIB;
+		}
+	}
+	const std::vector<unsigned char> &vStored = (Flags & BINARY_FLAG_ZLIB) ? vCompressed : vPayload;
+
+	vOut.resize(BINARY_HEADER_SIZE);
+	std::memcpy(vOut.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	vOut[4] = BINARY_VERSION;
+	vOut[5] = Flags;
+	WriteU32(vOut.data() + 6, vItems.size());
+	WriteU32(vOut.data() + 10, vPayload.size());
+	WriteU32(vOut.data() + 14, vStored.size());
+	vOut.insert(vOut.end(), vStored.begin(), vStored.end());
+}
+
+bool BgDrawFile::ReadBinary(const unsigned char *pData, size_t Size, std::vector<CBgDrawItemData> &vItems, size_t MaxItems)
+{
+	vItems.clear();
+	if(Size < BINARY_HEADER_SIZE || !IsBinary(pData, Size) || pData[4] != BINARY_VERSION)
+		return false;
+	const unsigned char Flags = pData[5];
+	const uint32_t NumItems = ReadU32(pData + 6);
+	const uint32_t PayloadSize = ReadU32(pData + 10);
+	const uint32_t StoredSize = ReadU32(pData + 14);
+	if(StoredSize > Size - BINARY_HEADER_SIZE || PayloadSize > MAX_BINARY_UNCOMPRESSED_SIZE)
+		return false;
+
+	const unsigned char *pStored = pData + BINARY_HEADER_SIZE;
+	std::vector<unsigned char> vPayload;
+	if(Flags & BINARY_FLAG_ZLIB)
+	{
+		vPayload.resize(PayloadSize);
+		uLongf DestSize = PayloadSize;
+		if(uncompress(vPayload.data(), &DestSize, pStored, StoredSize) != Z_OK || DestSize != PayloadSize)
+			return false;
+	}
+	else
+	{
+		if(StoredSize != PayloadSize)
+			return false;
+		vPayload.assign(pStored, pStored + StoredSize);
+	}
+
+	const unsigned char *pCur = vPayload.data();
+	const unsigned char *pEnd = pCur + vPayload.size();
+	for(uint32_t Item = 0; Item < NumItems; Item++)
+	{
+		int32_t NumPoints;
+		if(!ReadVarint(pCur, pEnd, NumPoints) || NumPoints <= 0 || NumPoints > MAX_PARTS_PER_ITEM)
+			return false;
+		CBgDrawItemData Data;
+		Data.reserve(NumPoints);
+		int32_t X = 0, Y = 0, W = 0;
+		float aColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+		for(int32_t i = 0; i < NumPoints; i++)
+		{
+			int32_t DeltaX, DeltaY, DeltaW;
+			if(!ReadVarint(pCur, pEnd, DeltaX) || !ReadVarint(pCur, pEnd, DeltaY) || !ReadVarint(pCur, pEnd, DeltaW) || pCur >= pEnd)
+				return false;
+			X += DeltaX;
+			Y += DeltaY;
+			W += DeltaW;
+			if(*pCur++)
+			{
+				if(pEnd - pCur < 4)
+					return false;
+				for(float &Component : aColor)
+					Component = *pCur++ / 255.0f;
+			}
+			Data.emplace_back(X / BINARY_POS_SCALE, Y / BINARY_POS_SCALE, W / BINARY_POS_SCALE, aColor[0], aColor[1], aColor[2], aColor[3]);
+		}
+		vItems.push_back(std::move(Data));
+	}
+	// like the text reader, keep the newest items
+	if(vItems.size() > MaxItems)
+		vItems.erase(vItems.begin(), vItems.end() - MaxItems);
+	return true;
+}
@@ -3,6 +3,7 @@
 
 // bg_draw_file.{cpp,h} can be used separately
 
+#include <cstddef>
 #include <cstdio>
 #include <functional>
 #include <vector>
@@ -37,6 +38,7 @@ using CBgDrawItemData = std::vector<CBgDrawItemDataPoint>;
 
 namespace BgDrawFile
 {
+	// Text format, one point per line and items separated by ",", kept for import/export
 	[[nodiscard]] bool Write(const std::function<bool(const char *)> &WriteLine, const CBgDrawItemData &Data);
 	[[nodiscard]] bool Read(const std::function<bool(char *pBuf, int Length)> &ReadLine, CBgDrawItemData &Data);
 	[[nodiscard]] bool Write(FILE *pFile, const CBgDrawItemData &Data);
@@ -51,6 +53,12 @@ namespace BgDrawFile
 		return Read((FILE *)File, Data);
 	}
 #endif
+
+	// Versioned binary format, positions and widths are quantized to
+	// 1/16 units and delta encoded, colors are only stored on change
+	[[nodiscard]] bool IsBinary(const unsigned char *pData, size_t Size);
+	void WriteBinary(std::vector<unsigned char> &vOut, const std::vector<CBgDrawItemData> &vItems, bool Compress);
+	[[nodiscard]] bool ReadBinary(const unsigned char *pData, size_t Size, std::vector<CBgDrawItemData> &vItems, size_t MaxItems);
 }; // namespace BgDrawFile
 
 #endif
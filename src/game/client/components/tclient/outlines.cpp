@@ -100,8 +100,38 @@ public:
 // The order of this determines order of priority into the one map (tele + freeze = tele)
 static constexpr COutLineLayer OUTLINE_LAYERS[] = {{OutlineLayer::TELE}, {OutlineLayer::GAME}, {OutlineLayer::FRONT}};
 
+bool COutlines::CTypeConfig::operator==(const CTypeConfig &Other) const
+{
+	return m_Enable == Other.m_Enable && m_Width == Other.m_Width && m_Color == Other.m_Color;
+}
+
+COutlines::CTypeConfig COutlines::TypeConfig(int Type)
+{
+	switch(Type)
+	{
+	case OUTLINE_UNFREEZE: return {g_Config.m_TcOutlineUnfreeze, g_Config.m_TcOutlineWidthUnfreeze, g_Config.m_TcOutlineColorUnfreeze};
+	case OUTLINE_FREEZE: return {g_Config.m_TcOutlineFreeze, g_Config.m_TcOutlineWidthFreeze, g_Config.m_TcOutlineColorFreeze};
+	case OUTLINE_TELE: return {g_Config.m_TcOutlineTele, g_Config.m_TcOutlineWidthTele, g_Config.m_TcOutlineColorTele};
+	case OUTLINE_KILL: return {g_Config.m_TcOutlineKill, g_Config.m_TcOutlineWidthKill, g_Config.m_TcOutlineColorKill};
+	case OUTLINE_SOLID: return {g_Config.m_TcOutlineSolid, g_Config.m_TcOutlineWidthSolid, g_Config.m_TcOutlineColorSolid};
+	}
+	dbg_assert_failed("Invalid outline type %d", Type);
+}
+
+void COutlines::ClearChunks()
+{
+	for(CChunk &Chunk : m_vChunks)
+		for(std::vector<int> &vQuadContainerIndices : Chunk.m_avQuadContainerIndices)
+			for(int &QuadContainerIndex : vQuadContainerIndices)
+				Graphics()->DeleteQuadContainer(QuadContainerIndex);
+	m_vChunks.clear();
+	m_NumChunks = {0, 0};
+	m_Built = false;
+}
+
 void COutlines::OnMapLoad()
 {
+	ClearChunks();
 	if(m_pMapData)
 	{
 		delete[] m_pMapData;
@@ -130,37 +160,63 @@ void COutlines::OnMapLoad()
 	{
 		pLayer->SetData(GameClient(), m_pMapData, m_MapDataSize);
 	}
+
+	// Tessellate while the map is loading instead of on the first frame
+	if(g_Config.m_TcOutline)
+		BuildChunks();
 }
 
-void COutlines::OnRender()
+void COutlines::BuildChunks()
 {
-	if(!m_pMapData)
-		return;
-	if(GameClient()->m_MapLayersBackground.m_OnlineOnly && Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
-		return;
-	if(!g_Config.m_ClOverlayEntities && g_Config.m_TcOutlineEntities)
-		return;
-	if(!g_Config.m_TcOutline)
-		return;
+	ClearChunks();
+	m_Built = true;
+	m_NumChunks = {(m_MapDataSize.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (m_MapDataSize.y + CHUNK_SIZE - 1) / CHUNK_SIZE};
+	m_vChunks.resize((size_t)m_NumChunks.x * m_NumChunks.y);
+	BuildTypes((1u << NUM_OUTLINE_TYPES) - 1);
+}
+
+void COutlines::BuildTypes(unsigned TypeMask)
+{
+	for(int Type = OUTLINE_UNFREEZE; Type <= OUTLINE_SOLID; Type++)
+	{
+		if(TypeMask & (1u << (Type - 1)))
+			m_aBuiltConfig[Type - 1] = TypeConfig(Type);
+	}
+	for(int ChunkY = 0; ChunkY < m_NumChunks.y; ChunkY++)
+		for(int ChunkX = 0; ChunkX < m_NumChunks.x; ChunkX++)
+			BuildChunk(m_vChunks[ChunkY * m_NumChunks.x + ChunkX], ChunkX, ChunkY, TypeMask);
+}
 
+void COutlines::BuildChunk(CChunk &Chunk, int ChunkX, int ChunkY, unsigned TypeMask)
+{
 	const float Scale = 32.0f;
+	const int StartX = ChunkX * CHUNK_SIZE;
+	const int StartY = ChunkY * CHUNK_SIZE;
+	const int EndX = std::min(StartX + CHUNK_SIZE, m_MapDataSize.x);
+	const int EndY = std::min(StartY + CHUNK_SIZE, m_MapDataSize.y);
 
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
-	int MaxScale = 12;
-	if(EndX - StartX > Graphics()->ScreenWidth() / MaxScale || EndY - StartY > Graphics()->ScreenHeight() / MaxScale)
+	int aNumQuadsInContainer[NUM_OUTLINE_TYPES] = {0};
+	for(int Type = OUTLINE_UNFREEZE; Type <= OUTLINE_SOLID; Type++)
 	{
-		int EdgeX = (EndX - StartX) - (Graphics()->ScreenWidth() / MaxScale);
-		StartX += EdgeX / 2;
-		EndX -= EdgeX / 2;
-		int EdgeY = (EndY - StartY) - (Graphics()->ScreenHeight() / MaxScale);
-		StartY += EdgeY / 2;
-		EndY -= EdgeY / 2;
+		if(!(TypeMask & (1u << (Type - 1))))
+			continue;
+		for(int QuadContainerIndex : Chunk.m_avQuadContainerIndices[Type - 1])
+			Graphics()->DeleteQuadContainer(QuadContainerIndex);
+		Chunk.m_avQuadContainerIndices[Type - 1].clear();
 	}
+	auto AddQuads = [&](int Type, IGraphics::CQuadItem *pQuads, int NumQuads) {
+		std::vector<int> &vQuadContainerIndices = Chunk.m_avQuadContainerIndices[Type - 1];
+		int &NumQuadsInContainer = aNumQuadsInContainer[Type - 1];
+		if(vQuadContainerIndices.empty() || NumQuadsInContainer + NumQuads > MAX_QUADS_PER_CONTAINER)
+		{
+			if(!vQuadContainerIndices.empty())
+				Graphics()->QuadContainerUpload(vQuadContainerIndices.back());
+			vQuadContainerIndices.push_back(Graphics()->CreateQuadContainer(false));
+			NumQuadsInContainer = 0;
+		}
+		Graphics()->QuadContainerAddQuads(vQuadContainerIndices.back(), pQuads, NumQuads);
+		NumQuadsInContainer += NumQuads;
+	};
 
 	auto GetTile = [&](int x, int y) {
 		x = std::clamp(x, 0, m_MapDataSize.x - 1);
@@ -168,36 +224,14 @@ void COutlines::OnRender()
 		return m_pMapData[y * m_MapDataSize.x + x];
 	};
 
-	Graphics()->TextureClear();
-	Graphics()->QuadsBegin();
-
 	for(int y = StartY; y < EndY; y++)
 	{
 		for(int x = StartX; x < EndX; x++)
 		{
 			const int Type = GetTile(x, y);
-			if(Type == OUTLINE_NONE)
+			if(Type == OUTLINE_NONE || !(TypeMask & (1u << (Type - 1))))
 				continue;
-			class COutlineConfig
-			{
-			public:
-				const int &m_Enable;
-				const int &m_Width;
-				const unsigned int &m_Color;
-			};
-			const COutlineConfig Config = [&]() -> COutlineConfig {
-				if(Type == OUTLINE_SOLID)
-					return {g_Config.m_TcOutlineSolid, g_Config.m_TcOutlineWidthSolid, g_Config.m_TcOutlineColorSolid};
-				if(Type == OUTLINE_FREEZE)
-					return {g_Config.m_TcOutlineFreeze, g_Config.m_TcOutlineWidthFreeze, g_Config.m_TcOutlineColorFreeze};
-				if(Type == OUTLINE_UNFREEZE)
-					return {g_Config.m_TcOutlineUnfreeze, g_Config.m_TcOutlineWidthUnfreeze, g_Config.m_TcOutlineColorUnfreeze};
-				if(Type == OUTLINE_KILL)
-					return {g_Config.m_TcOutlineKill, g_Config.m_TcOutlineWidthKill, g_Config.m_TcOutlineColorKill};
-				if(Type == OUTLINE_TELE)
-					return {g_Config.m_TcOutlineTele, g_Config.m_TcOutlineWidthTele, g_Config.m_TcOutlineColorTele};
-				dbg_assert(false, "Invalid value for Type at %d, %d/%d, %d", x, y, m_MapDataSize.x, m_MapDataSize.y);
-			}();
+			const CTypeConfig &Config = m_aBuiltConfig[Type - 1];
 			if(!Config.m_Enable || Config.m_Width <= 0)
 				continue;
 			// Find neighbours
@@ -256,9 +290,58 @@ void COutlines::OnRender()
 			if(NumQuads <= 0)
 				continue;
 			Graphics()->SetColor(color_cast<ColorRGBA>(ColorHSLA(Config.m_Color, true)));
-			Graphics()->QuadsDrawTL(aQuads, NumQuads);
+			AddQuads(Type, aQuads, NumQuads);
+		}
+	}
+
+	for(int Type = OUTLINE_UNFREEZE; Type <= OUTLINE_SOLID; Type++)
+	{
+		if((TypeMask & (1u << (Type - 1))) && !Chunk.m_avQuadContainerIndices[Type - 1].empty())
+			Graphics()->QuadContainerUpload(Chunk.m_avQuadContainerIndices[Type - 1].back());
+	}
+	Graphics()->SetColor(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void COutlines::OnRender()
+{
+	if(!m_pMapData)
+		return;
+	if(GameClient()->m_MapLayersBackground.m_OnlineOnly && Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
+		return;
+	if(!g_Config.m_ClOverlayEntities && g_Config.m_TcOutlineEntities)
+		return;
+	if(!g_Config.m_TcOutline)
+		return;
+
+	if(!m_Built)
+	{
+		// Only when outlines get enabled after the map was loaded
+		BuildChunks();
+	}
+	else
+	{
+		unsigned ChangedTypes = 0;
+		for(int Type = OUTLINE_UNFREEZE; Type <= OUTLINE_SOLID; Type++)
+		{
+			if(!(m_aBuiltConfig[Type - 1] == TypeConfig(Type)))
+				ChangedTypes |= 1u << (Type - 1);
 		}
+		if(ChangedTypes)
+			BuildTypes(ChangedTypes);
 	}
 
-	Graphics()->QuadsEnd();
+	const float ChunkScale = 32.0f * CHUNK_SIZE;
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	const int StartX = std::max((int)std::floor(ScreenX0 / ChunkScale), 0);
+	const int StartY = std::max((int)std::floor(ScreenY0 / ChunkScale), 0);
+	const int EndX = std::min((int)std::floor(ScreenX1 / ChunkScale) + 1, m_NumChunks.x);
+	const int EndY = std::min((int)std::floor(ScreenY1 / ChunkScale) + 1, m_NumChunks.y);
+
+	Graphics()->TextureClear();
+	for(int ChunkY = StartY; ChunkY < EndY; ChunkY++)
+		for(int ChunkX = StartX; ChunkX < EndX; ChunkX++)
+			for(const std::vector<int> &vQuadContainerIndices : m_vChunks[ChunkY * m_NumChunks.x + ChunkX].m_avQuadContainerIndices)
+				for(int QuadContainerIndex : vQuadContainerIndices)
+					Graphics()->RenderQuadContainer(QuadContainerIndex, -1);
 }
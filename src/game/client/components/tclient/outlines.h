@@ -3,15 +3,50 @@
 
 #include <game/client/component.h>
 
+#include <vector>
+
 class CTile;
 class CTeleTile;
 
 class COutlines : public CComponent
 {
 private:
+	// Outline quads are built per chunk of tiles and outline type into quad
+	// containers with baked colors, so a config change only rebuilds its type
+	static constexpr int CHUNK_SIZE = 16;
+	static constexpr int MAX_QUADS_PER_CONTAINER = 512;
+	static constexpr int NUM_OUTLINE_TYPES = 5;
+
+	class CChunk
+	{
+	public:
+		// Indexed by outline type - 1
+		std::vector<int> m_avQuadContainerIndices[NUM_OUTLINE_TYPES];
+	};
+
+	class CTypeConfig
+	{
+	public:
+		int m_Enable;
+		int m_Width;
+		unsigned m_Color;
+		bool operator==(const CTypeConfig &Other) const;
+	};
+
 	ivec2 m_MapDataSize;
 	int *m_pMapData = nullptr;
 
+	ivec2 m_NumChunks = {0, 0};
+	std::vector<CChunk> m_vChunks;
+	bool m_Built = false;
+	CTypeConfig m_aBuiltConfig[NUM_OUTLINE_TYPES];
+
+	static CTypeConfig TypeConfig(int Type);
+	void ClearChunks();
+	void BuildChunks();
+	void BuildTypes(unsigned TypeMask);
+	void BuildChunk(CChunk &Chunk, int ChunkX, int ChunkY, unsigned TypeMask);
+
 public:
 	int Sizeof() const override { return sizeof(*this); }
 	void OnMapLoad() override;
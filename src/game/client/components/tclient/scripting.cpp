@@ -6,7 +6,9 @@
 #include <base/str.h>
 
 #include <engine/console.h>
+#include <engine/engine.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 
 #include <game/client/component.h>
@@ -243,19 +245,89 @@ public:
 	}
 };
 
+class CScriptRunnerInitJob : public IJob
+{
+	CGameClient *m_pClient;
+
+protected:
+	void Run() override
+	{
+		m_pRunner = new CScriptRunner(m_pClient);
+	}
+
+public:
+	CScriptRunner *m_pRunner = nullptr;
+
+	CScriptRunnerInitJob(CGameClient *pClient) :
+		m_pClient(pClient)
+	{
+	}
+};
+
 void CScripting::ConExecScript(IConsole::IResult *pResult, void *pUserData)
 {
 	CScripting *pThis = static_cast<CScripting *>(pUserData);
 	pThis->ExecScript(pResult->GetString(0), pResult->GetString(1));
 }
 
+CScriptRunner *CScripting::Runner()
+{
+	if(m_pInitJob)
+	{
+		while(!m_pInitJob->Done())
+			thread_yield();
+		m_pRunner = m_pInitJob->m_pRunner;
+		m_pInitJob = nullptr;
+	}
+	if(!m_pRunner)
+		m_pRunner = new CScriptRunner(GameClient());
+	return m_pRunner;
+}
+
 void CScripting::ExecScript(const char *pFilename, const char *pArgs)
 {
-	CScriptRunner Runner(GameClient());
-	Runner.Run(pFilename, pArgs);
+	m_RunDepth++;
+	if(m_RunDepth == 1)
+	{
+		Runner()->Run(pFilename, pArgs);
+	}
+	else
+	{
+		CScriptRunner Runner(GameClient());
+		Runner.Run(pFilename, pArgs);
+	}
+	m_RunDepth--;
 }
 
 void CScripting::OnConsoleInit()
 {
 	Console()->Register(SCRIPTING_IMPL, "s[file] ?r[args]", CFGFLAG_CLIENT, ConExecScript, this, "Execute a " SCRIPTING_IMPL " script");
 }
+
+void CScripting::OnInit()
+{
+	// Setting up the engine and its bindings takes a while, don't do it on the first script
+	if(g_Config.m_TcScriptPreload)
+	{
+		m_pInitJob = std::make_shared<CScriptRunnerInitJob>(GameClient());
+		Engine()->AddJob(m_pInitJob);
+	}
+}
+
+void CScripting::OnShutdown()
+{
+	if(m_pInitJob)
+	{
+		while(!m_pInitJob->Done())
+			thread_yield();
+		delete m_pInitJob->m_pRunner;
+		m_pInitJob = nullptr;
+	}
+	delete m_pRunner;
+	m_pRunner = nullptr;
+}
+
+CScripting::~CScripting()
+{
+	OnShutdown();
+}
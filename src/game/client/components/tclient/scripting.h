@@ -5,15 +5,29 @@
 
 #include <game/client/component.h>
 
+#include <memory>
+
+class CScriptRunner;
+class CScriptRunnerInitJob;
+
 class CScripting : public CComponent
 {
 private:
+	// Set up once and reused for every script
+	CScriptRunner *m_pRunner = nullptr;
+	std::shared_ptr<CScriptRunnerInitJob> m_pInitJob;
+	// Scripts executing other scripts must not reset the state of the running one
+	int m_RunDepth = 0;
+	CScriptRunner *Runner();
 	static void ConExecScript(IConsole::IResult *pResult, void *pUserData);
 
 public:
 	void ExecScript(const char *pFilename, const char *pArgs);
 	void OnConsoleInit() override;
+	void OnInit() override;
+	void OnShutdown() override;
 	int Sizeof() const override { return sizeof(*this); }
+	~CScripting() override;
 };
 
 #endif
@@ -5,6 +5,9 @@
 #include <engine/external/regex.h>
 #include <engine/storage.h>
 
+#include <map>
+#include <optional>
+#include <unordered_map>
 #include <variant>
 
 #define CHAISCRIPT_NO_THREADS
@@ -56,8 +59,82 @@ static const char *ReadScript(IStorage *pStorage, const char *pFilename)
 class CScriptingCtx::CScriptingCtxData
 {
 public:
+	class CParsedScript
+	{
+	public:
+		int m_StorageType;
+		time_t m_Modified;
+		// Included files can change the layout of the top level scope,
+		// which breaks the variable locations cached in the syntax tree
+		bool m_Reusable;
+		chaiscript::AST_NodePtr m_pAst;
+	};
+
 	IStorage *m_pStorage;
 	chaiscript::ChaiScript m_Chai;
+	std::optional<chaiscript::ChaiScript::State> m_InitialState = std::nullopt;
+	std::map<std::string, chaiscript::Boxed_Value> m_InitialLocals = {};
+	std::unordered_map<std::string, CParsedScript> m_ParsedScripts = {};
+	CParsedScript *m_pRunning = nullptr;
+	int m_RunDepth = 0;
+
+	chaiscript::AST_NodePtr Parse(const char *pFilename)
+	{
+		const char *pScript = ReadScript(m_pStorage, pFilename);
+		chaiscript::AST_NodePtr pAst;
+		try
+		{
+			pAst = m_Chai.get_parser().parse(pScript, pFilename);
+		}
+		catch(...)
+		{
+			std::free((void *)pScript);
+			throw;
+		}
+		std::free((void *)pScript);
+		return pAst;
+	}
+
+	CParsedScript &ParsedScript(const char *pFilename)
+	{
+		// Find the file in the same order as reading it
+		int StorageType = -1;
+		time_t Modified = 0;
+		for(int Type = IStorage::TYPE_SAVE; Type < m_pStorage->NumPaths(); ++Type)
+		{
+			time_t Created;
+			if(m_pStorage->RetrieveTimes(pFilename, Type, &Created, &Modified))
+			{
+				StorageType = Type;
+				break;
+			}
+		}
+
+		CParsedScript &Parsed = m_ParsedScripts[pFilename];
+		if(!Parsed.m_pAst || !Parsed.m_Reusable || Parsed.m_StorageType != StorageType || Parsed.m_Modified != Modified)
+		{
+			Parsed.m_pAst = Parse(pFilename);
+			Parsed.m_StorageType = StorageType;
+			Parsed.m_Modified = Modified;
+			Parsed.m_Reusable = true;
+		}
+		return Parsed;
+	}
+
+	void ResetState()
+	{
+		// Everything added before the first run is kept, definitions of previous runs are dropped
+		if(!m_InitialState)
+		{
+			m_InitialState = m_Chai.get_state();
+			m_InitialLocals = m_Chai.get_locals();
+		}
+		else
+		{
+			m_Chai.set_state(*m_InitialState);
+			m_Chai.set_locals(m_InitialLocals);
+		}
+	}
 };
 
 CScriptingCtx::CScriptingCtx()
@@ -79,10 +156,17 @@ CScriptingCtx::CScriptingCtx()
 	m_pData->m_Chai.add(PrintStrBoxed, "print");
 	m_pData->m_Chai.add(PrintStrBoxed, "puts");
 	m_pData->m_Chai.add(chaiscript::fun([&](const std::string &Module) {
-		const char *pScript = ReadScript(m_pData->m_pStorage, Module.c_str());
-		auto Out = m_pData->m_Chai.eval(pScript, chaiscript::Exception_Handler(), Module);
-		std::free((void *)pScript);
-		return Out;
+		if(m_pData->m_pRunning)
+			m_pData->m_pRunning->m_Reusable = false;
+		const chaiscript::AST_NodePtr pAst = m_pData->Parse(Module.c_str());
+		try
+		{
+			return m_pData->m_Chai.eval(*pAst);
+		}
+		catch(const chaiscript::eval::detail::Return_Value &Return)
+		{
+			return Return.retval;
+		}
 	}),
 		"include");
 	m_pData->m_Chai.add(chaiscript::fun([&](const std::string &Path) {
@@ -152,13 +236,25 @@ void CScriptingCtx::AddGlobal(const char *pName, const std::string &Object)
 
 void CScriptingCtx::Run(IStorage *pStorage, const char *pFilename, const char *pArgs)
 {
+	// Resetting the state or replacing the cached syntax tree would break the running script
+	if(m_pData->m_RunDepth > 0)
+	{
+		log_error(SCRIPTING_IMPL, "Cannot run '%s' while another script is running in the same context", pFilename);
+		return;
+	}
+	m_pData->m_RunDepth++;
 	m_pData->m_pStorage = pStorage;
-	const char *pScript = nullptr;
+	m_pData->ResetState();
 	try
 	{
 		m_pData->m_Chai.add_global_const(chaiscript::const_var(std::string(pArgs)), "args");
-		pScript = ReadScript(pStorage, pFilename);
-		m_pData->m_Chai.eval(pScript, chaiscript::Exception_Handler(), pFilename);
+		CScriptingCtxData::CParsedScript &Parsed = m_pData->ParsedScript(pFilename);
+		m_pData->m_pRunning = &Parsed;
+		m_pData->m_Chai.eval(*Parsed.m_pAst);
+	}
+	catch(const chaiscript::eval::detail::Return_Value &)
+	{
+		// Returning from the top level of a script
 	}
 	catch(const chaiscript::exception::eval_error &e)
 	{
@@ -176,10 +272,18 @@ void CScriptingCtx::Run(IStorage *pStorage, const char *pFilename, const char *p
 	{
 		try
 		{
-			chaiscript::Boxed_Value ToStringRaw = m_pData->m_Chai.eval("to_string");
-			std::function<std::string(chaiscript::Boxed_Value)> ToString =
-				chaiscript::boxed_cast<std::function<std::string(chaiscript::Boxed_Value)>>(ToStringRaw);
-			log_error(SCRIPTING_IMPL, "Exception in '%s': %s", pFilename, ToString(e).c_str());
+			// Evaluating a syntax tree wraps eval errors
+			if(e.get_type_info().bare_equal(chaiscript::user_type<chaiscript::exception::eval_error>()))
+			{
+				log_error(SCRIPTING_IMPL, "Eval error in '%s': %s", pFilename, chaiscript::boxed_cast<const chaiscript::exception::eval_error &>(e).pretty_print().c_str());
+			}
+			else
+			{
+				chaiscript::Boxed_Value ToStringRaw = m_pData->m_Chai.eval("to_string");
+				std::function<std::string(chaiscript::Boxed_Value)> ToString =
+					chaiscript::boxed_cast<std::function<std::string(chaiscript::Boxed_Value)>>(ToStringRaw);
+				log_error(SCRIPTING_IMPL, "Exception in '%s': %s", pFilename, ToString(e).c_str());
+			}
 		}
 		catch(...)
 		{
@@ -190,5 +294,6 @@ void CScriptingCtx::Run(IStorage *pStorage, const char *pFilename, const char *p
 	{
 		log_error(SCRIPTING_IMPL, "Unknown exception in '%s'", pFilename);
 	}
-	std::free((void *)pScript);
+	m_pData->m_pRunning = nullptr;
+	m_pData->m_RunDepth--;
 }
@@ -24,8 +24,7 @@ void CTrails::ClearAllHistory()
 }
 void CTrails::ClearHistory(int ClientId)
 {
-	for(int i = 0; i < 200; ++i)
-		m_History[ClientId][i] = {{}, -1};
+	std::fill(std::begin(m_aHistory[ClientId].m_aTick), std::end(m_aHistory[ClientId].m_aTick), -1);
 	m_HistoryValid[ClientId] = false;
 }
 void CTrails::OnReset()
@@ -44,7 +43,9 @@ void CTrails::OnRender()
 	if(!GameClient()->m_Snap.m_pGameInfoObj)
 		return;
 
-	Graphics()->TextureClear();
+	const bool LineMode = g_Config.m_TcTeeTrailWidth == 0;
+	m_vQuads.clear();
+	m_vLines.clear();
 
 	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
 	{
@@ -66,304 +67,318 @@ void CTrails::OnRender()
 		else
 			m_HistoryValid[ClientId] = true;
 
-		CTeeRenderInfo TeeInfo = GameClient()->m_aClients[ClientId].m_RenderInfo;
+		AddTrail(ClientId, LineMode);
+	}
 
-		const bool PredictPlayer = ShouldPredictPlayer(ClientId);
-		int StartTick;
-		const int GameTick = Client()->GameTick(g_Config.m_ClDummy);
-		const int PredTick = Client()->PredGameTick(g_Config.m_ClDummy);
-		float IntraTick;
-		if(PredictPlayer)
+	if(m_vQuads.empty() && m_vLines.empty())
+		return;
+
+	Graphics()->TextureClear();
+	if(LineMode)
+	{
+		Graphics()->LinesBegin();
+		for(const CTrailLine &Line : m_vLines)
 		{
-			StartTick = PredTick;
-			IntraTick = Client()->PredIntraGameTick(g_Config.m_ClDummy);
-			if(g_Config.m_TcRemoveAnti)
-			{
-				StartTick = GameClient()->m_SmoothTick[g_Config.m_ClDummy];
-				IntraTick = GameClient()->m_SmoothIntraTick[g_Config.m_ClDummy];
-			}
-			if(g_Config.m_TcUnpredOthersInFreeze && !Local && Client()->m_IsLocalFrozen)
-			{
-				StartTick = GameTick;
-			}
+			Graphics()->SetColor(Line.m_Color);
+			Graphics()->LinesDraw(&Line.m_Item, 1);
 		}
-		else
+		Graphics()->LinesEnd();
+	}
+	else
+	{
+		Graphics()->QuadsBegin();
+		for(const CTrailQuad &Quad : m_vQuads)
+		{
+			Graphics()->SetColor4(Quad.m_aColors[0], Quad.m_aColors[1], Quad.m_aColors[2], Quad.m_aColors[3]);
+			Graphics()->QuadsDrawFreeform(&Quad.m_Item, 1);
+		}
+		Graphics()->QuadsEnd();
+	}
+}
+
+void CTrails::AddTrail(int ClientId, bool LineMode)
+{
+	const bool Local = GameClient()->m_Snap.m_LocalClientId == ClientId;
+
+	CTeeRenderInfo TeeInfo = GameClient()->m_aClients[ClientId].m_RenderInfo;
+
+	const bool PredictPlayer = ShouldPredictPlayer(ClientId);
+	int StartTick;
+	const int GameTick = Client()->GameTick(g_Config.m_ClDummy);
+	const int PredTick = Client()->PredGameTick(g_Config.m_ClDummy);
+	float IntraTick;
+	if(PredictPlayer)
+	{
+		StartTick = PredTick;
+		IntraTick = Client()->PredIntraGameTick(g_Config.m_ClDummy);
+		if(g_Config.m_TcRemoveAnti)
+		{
+			StartTick = GameClient()->m_SmoothTick[g_Config.m_ClDummy];
+			IntraTick = GameClient()->m_SmoothIntraTick[g_Config.m_ClDummy];
+		}
+		if(g_Config.m_TcUnpredOthersInFreeze && !Local && Client()->m_IsLocalFrozen)
 		{
 			StartTick = GameTick;
-			IntraTick = Client()->IntraGameTick(g_Config.m_ClDummy);
 		}
+	}
+	else
+	{
+		StartTick = GameTick;
+		IntraTick = Client()->IntraGameTick(g_Config.m_ClDummy);
+	}
 
-		const vec2 CurServerPos = vec2(GameClient()->m_Snap.m_aCharacters[ClientId].m_Cur.m_X, GameClient()->m_Snap.m_aCharacters[ClientId].m_Cur.m_Y);
-		const vec2 PrevServerPos = vec2(GameClient()->m_Snap.m_aCharacters[ClientId].m_Prev.m_X, GameClient()->m_Snap.m_aCharacters[ClientId].m_Prev.m_Y);
-		m_History[ClientId][GameTick % 200] = {
-			mix(PrevServerPos, CurServerPos, IntraTick),
-			GameTick,
-		};
-
-		// // NOTE: this is kind of a hack to fix 25tps. This fixes flickering when using the speed mode
-		// m_History[ClientId][(GameTick + 1) % 200] = m_History[ClientId][GameTick % 200];
-		// m_History[ClientId][(GameTick + 2) % 200] = m_History[ClientId][GameTick % 200];
-
-		IGraphics::CLineItem LineItem;
-		bool LineMode = g_Config.m_TcTeeTrailWidth == 0;
-
-		float Alpha = g_Config.m_TcTeeTrailAlpha / 100.0f;
-		// Taken from players.cpp
-		if(ClientId == -2)
-			Alpha *= g_Config.m_ClRaceGhostAlpha / 100.0f;
-		else if(ClientId < 0 || GameClient()->IsOtherTeam(ClientId))
-			Alpha *= g_Config.m_ClShowOthersAlpha / 100.0f;
-
-		int TrailLength = g_Config.m_TcTeeTrailLength;
-		float Width = g_Config.m_TcTeeTrailWidth;
-
-		static std::vector<CTrailPart> s_Trail;
-		s_Trail.clear();
-
-		// TODO: figure out why this is required
-		if(!PredictPlayer)
-			TrailLength += 2;
-		bool TrailFull = false;
-		// Fill trail list with initial positions
-		for(int i = 0; i < TrailLength; i++)
+	const vec2 CurServerPos = vec2(GameClient()->m_Snap.m_aCharacters[ClientId].m_Cur.m_X, GameClient()->m_Snap.m_aCharacters[ClientId].m_Cur.m_Y);
+	const vec2 PrevServerPos = vec2(GameClient()->m_Snap.m_aCharacters[ClientId].m_Prev.m_X, GameClient()->m_Snap.m_aCharacters[ClientId].m_Prev.m_Y);
+	CHistory &History = m_aHistory[ClientId];
+	History.m_aPos[GameTick % HISTORY_SIZE] = mix(PrevServerPos, CurServerPos, IntraTick);
+	History.m_aTick[GameTick % HISTORY_SIZE] = GameTick;
+
+	// // NOTE: this is kind of a hack to fix 25tps. This fixes flickering when using the speed mode
+	// m_History[ClientId][(GameTick + 1) % 200] = m_History[ClientId][GameTick % 200];
+	// m_History[ClientId][(GameTick + 2) % 200] = m_History[ClientId][GameTick % 200];
+
+	float Alpha = g_Config.m_TcTeeTrailAlpha / 100.0f;
+	// Taken from players.cpp
+	if(ClientId == -2)
+		Alpha *= g_Config.m_ClRaceGhostAlpha / 100.0f;
+	else if(ClientId < 0 || GameClient()->IsOtherTeam(ClientId))
+		Alpha *= g_Config.m_ClShowOthersAlpha / 100.0f;
+
+	int TrailLength = g_Config.m_TcTeeTrailLength;
+	float Width = g_Config.m_TcTeeTrailWidth;
+
+	std::vector<CTrailPart> &vTrail = m_vTrail;
+	vTrail.clear();
+
+	// TODO: figure out why this is required
+	if(!PredictPlayer)
+		TrailLength += 2;
+	bool TrailFull = false;
+	// Fill trail list with initial positions
+	for(int i = 0; i < TrailLength; i++)
+	{
+		CTrailPart Part;
+		int PosTick = StartTick - i;
+		if(PredictPlayer)
 		{
-			CTrailPart Part;
-			int PosTick = StartTick - i;
-			if(PredictPlayer)
-			{
-				if(GameClient()->m_aClients[ClientId].m_aPredTick[PosTick % 200] != PosTick)
-					continue;
-				Part.m_Pos = GameClient()->m_aClients[ClientId].m_aPredPos[PosTick % 200];
-				if(i == TrailLength - 1)
-					TrailFull = true;
-			}
-			else
-			{
-				if(m_History[ClientId][PosTick % 200].m_Tick != PosTick)
-					continue;
-				Part.m_Pos = m_History[ClientId][PosTick % 200].m_Pos;
-				if(i == TrailLength - 2 || i == TrailLength - 3)
-					TrailFull = true;
-			}
-			Part.m_UnmovedPos = Part.m_Pos;
-			Part.m_Tick = PosTick;
-			s_Trail.push_back(Part);
+			if(GameClient()->m_aClients[ClientId].m_aPredTick[PosTick % 200] != PosTick)
+				continue;
+			Part.m_Pos = GameClient()->m_aClients[ClientId].m_aPredPos[PosTick % 200];
+			if(i == TrailLength - 1)
+				TrailFull = true;
+		}
+		else
+		{
+			if(History.m_aTick[PosTick % HISTORY_SIZE] != PosTick)
+				continue;
+			Part.m_Pos = History.m_aPos[PosTick % HISTORY_SIZE];
+			if(i == TrailLength - 2 || i == TrailLength - 3)
+				TrailFull = true;
 		}
+		Part.m_UnmovedPos = Part.m_Pos;
+		Part.m_Tick = PosTick;
+		vTrail.push_back(Part);
+	}
 
-		// Trim the ends if intratick is too big
-		// this was not trivial to figure out
-		int TrimTicks = (int)IntraTick;
-		for(int i = 0; i < TrimTicks; i++)
-			if((int)s_Trail.size() > 0)
-				s_Trail.pop_back();
+	// Trim the ends if intratick is too big
+	// this was not trivial to figure out
+	int TrimTicks = (int)IntraTick;
+	for(int i = 0; i < TrimTicks; i++)
+		if((int)vTrail.size() > 0)
+			vTrail.pop_back();
 
-		// Stuff breaks if we have less than 3 points because we cannot calculate an angle between segments to preserve constant width
-		// TODO: Pad the list with generated entries in the same direction as before
-		if((int)s_Trail.size() < 3)
-			continue;
+	// Stuff breaks if we have less than 3 points because we cannot calculate an angle between segments to preserve constant width
+	// TODO: Pad the list with generated entries in the same direction as before
+	if((int)vTrail.size() < 3)
+		return;
 
-		if(PredictPlayer)
-			s_Trail.at(0).m_Pos = GameClient()->m_aClients[ClientId].m_RenderPos;
-		else
-			s_Trail.at(0).m_Pos = mix(PrevServerPos, CurServerPos, IntraTick);
+	if(PredictPlayer)
+		vTrail.at(0).m_Pos = GameClient()->m_aClients[ClientId].m_RenderPos;
+	else
+		vTrail.at(0).m_Pos = mix(PrevServerPos, CurServerPos, IntraTick);
 
-		if(TrailFull)
-			s_Trail.at(s_Trail.size() - 1).m_Pos = mix(s_Trail.at(s_Trail.size() - 1).m_Pos, s_Trail.at(s_Trail.size() - 2).m_Pos, std::fmod(IntraTick, 1.0f));
+	if(TrailFull)
+		vTrail.at(vTrail.size() - 1).m_Pos = mix(vTrail.at(vTrail.size() - 1).m_Pos, vTrail.at(vTrail.size() - 2).m_Pos, std::fmod(IntraTick, 1.0f));
 
-		// Set progress
-		for(int i = 0; i < (int)s_Trail.size(); i++)
+	// Set progress
+	for(int i = 0; i < (int)vTrail.size(); i++)
+	{
+		float Size = float(vTrail.size() - 1 + TrimTicks);
+		CTrailPart &Part = vTrail.at(i);
+		if(i == 0)
+			Part.m_Progress = 0.0f;
+		else if(i == (int)vTrail.size() - 1)
+			Part.m_Progress = 1.0f;
+		else
+			Part.m_Progress = ((float)i + IntraTick - 1.0f) / (Size - 1.0f);
+
+		switch(g_Config.m_TcTeeTrailColorMode)
 		{
-			float Size = float(s_Trail.size() - 1 + TrimTicks);
-			CTrailPart &Part = s_Trail.at(i);
-			if(i == 0)
-				Part.m_Progress = 0.0f;
-			else if(i == (int)s_Trail.size() - 1)
-				Part.m_Progress = 1.0f;
+		case COLORMODE_SOLID:
+			Part.m_Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_TcTeeTrailColor));
+			break;
+		case COLORMODE_TEE:
+			if(TeeInfo.m_CustomColoredSkin)
+				Part.m_Col = TeeInfo.m_ColorBody;
 			else
-				Part.m_Progress = ((float)i + IntraTick - 1.0f) / (Size - 1.0f);
-
-			switch(g_Config.m_TcTeeTrailColorMode)
+				Part.m_Col = TeeInfo.m_BloodColor;
+			break;
+		case COLORMODE_RAINBOW:
+		{
+			float Cycle = (1.0f / TrailLength) * 0.5f;
+			float Hue = std::fmod(((Part.m_Tick + 6361 * ClientId) % 1000000) * Cycle, 1.0f);
+			Part.m_Col = color_cast<ColorRGBA>(ColorHSLA(Hue, 1.0f, 0.5f));
+			break;
+		}
+		case COLORMODE_SPEED:
+		{
+			float Speed = 0.0f;
+			if(vTrail.size() > 3)
 			{
-			case COLORMODE_SOLID:
-				Part.m_Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_TcTeeTrailColor));
-				break;
-			case COLORMODE_TEE:
-				if(TeeInfo.m_CustomColoredSkin)
-					Part.m_Col = TeeInfo.m_ColorBody;
+				if(i < 2)
+					Speed = distance(vTrail.at(i + 2).m_UnmovedPos, Part.m_UnmovedPos) / std::abs(vTrail.at(i + 2).m_Tick - Part.m_Tick);
 				else
-					Part.m_Col = TeeInfo.m_BloodColor;
-				break;
-			case COLORMODE_RAINBOW:
-			{
-				float Cycle = (1.0f / TrailLength) * 0.5f;
-				float Hue = std::fmod(((Part.m_Tick + 6361 * ClientId) % 1000000) * Cycle, 1.0f);
-				Part.m_Col = color_cast<ColorRGBA>(ColorHSLA(Hue, 1.0f, 0.5f));
-				break;
-			}
-			case COLORMODE_SPEED:
-			{
-				float Speed = 0.0f;
-				if(s_Trail.size() > 3)
-				{
-					if(i < 2)
-						Speed = distance(s_Trail.at(i + 2).m_UnmovedPos, Part.m_UnmovedPos) / std::abs(s_Trail.at(i + 2).m_Tick - Part.m_Tick);
-					else
-						Speed = distance(Part.m_UnmovedPos, s_Trail.at(i - 2).m_UnmovedPos) / std::abs(Part.m_Tick - s_Trail.at(i - 2).m_Tick);
-				}
-				Part.m_Col = color_cast<ColorRGBA>(ColorHSLA(65280 * ((int)(Speed * Speed / 12.5f) + 1)).UnclampLighting(ColorHSLA::DARKEST_LGT));
-				break;
-			}
-			default:
-				dbg_assert(false, "Invalid value for g_Config.m_TcTeeTrailColorMode");
-				dbg_break();
+					Speed = distance(Part.m_UnmovedPos, vTrail.at(i - 2).m_UnmovedPos) / std::abs(Part.m_Tick - vTrail.at(i - 2).m_Tick);
 			}
+			Part.m_Col = color_cast<ColorRGBA>(ColorHSLA(65280 * ((int)(Speed * Speed / 12.5f) + 1)).UnclampLighting(ColorHSLA::DARKEST_LGT));
+			break;
+		}
+		default:
+			dbg_assert(false, "Invalid value for g_Config.m_TcTeeTrailColorMode");
+			dbg_break();
+		}
+
+		Part.m_Col.a = Alpha;
+		if(g_Config.m_TcTeeTrailFade)
+			Part.m_Col.a *= 1.0 - Part.m_Progress;
+
+		Part.m_Width = Width;
+		if(g_Config.m_TcTeeTrailTaper)
+			Part.m_Width = Width * (1.0 - Part.m_Progress);
+	}
+
+	// Remove duplicate elements (those with same Pos)
+	auto NewEnd = std::unique(vTrail.begin(), vTrail.end());
+	vTrail.erase(NewEnd, vTrail.end());
+
+	if((int)vTrail.size() < 3)
+		return;
 
-			Part.m_Col.a = Alpha;
-			if(g_Config.m_TcTeeTrailFade)
-				Part.m_Col.a *= 1.0 - Part.m_Progress;
+	// Calculate the widths
+	for(int i = 0; i < (int)vTrail.size(); i++)
+	{
+		CTrailPart &Part = vTrail.at(i);
+		vec2 PrevPos;
+		vec2 Pos = vTrail.at(i).m_Pos;
+		vec2 NextPos;
 
-			Part.m_Width = Width;
-			if(g_Config.m_TcTeeTrailTaper)
-				Part.m_Width = Width * (1.0 - Part.m_Progress);
+		if(i == 0)
+		{
+			vec2 Direction = normalize(vTrail.at(i + 1).m_Pos - Pos);
+			PrevPos = Pos - Direction;
 		}
+		else
+			PrevPos = vTrail.at(i - 1).m_Pos;
 
-		// Remove duplicate elements (those with same Pos)
-		auto NewEnd = std::unique(s_Trail.begin(), s_Trail.end());
-		s_Trail.erase(NewEnd, s_Trail.end());
+		if(i == (int)vTrail.size() - 1)
+		{
+			vec2 Direction = normalize(Pos - vTrail.at(i - 1).m_Pos);
+			NextPos = Pos + Direction;
+		}
+		else
+			NextPos = vTrail.at(i + 1).m_Pos;
+
+		vec2 NextDirection = normalize(NextPos - Pos);
+		vec2 PrevDirection = normalize(Pos - PrevPos);
+
+		vec2 Normal = vec2(-PrevDirection.y, PrevDirection.x);
+		Part.m_Normal = Normal;
+		vec2 Tangent = normalize(NextDirection + PrevDirection);
+		if(Tangent == vec2(0.0f, 0.0f))
+			Tangent = Normal;
+
+		vec2 PerpVec = vec2(-Tangent.y, Tangent.x);
+		Width = Part.m_Width;
+		float ScaledWidth = Width / dot(Normal, PerpVec);
+		float TopScaled = ScaledWidth;
+		float BotScaled = ScaledWidth;
+		if(dot(PrevDirection, Tangent) > 0.0f)
+			TopScaled = std::min(Width * 3.0f, TopScaled);
+		else
+			BotScaled = std::min(Width * 3.0f, BotScaled);
 
-		if((int)s_Trail.size() < 3)
-			continue;
+		vec2 Top = Pos + PerpVec * TopScaled;
+		vec2 Bot = Pos - PerpVec * BotScaled;
+		Part.m_Top = Top;
+		Part.m_Bot = Bot;
 
-		// Calculate the widths
-		for(int i = 0; i < (int)s_Trail.size(); i++)
+		// Bevel Cap
+		if(dot(PrevDirection, NextDirection) < -0.25f)
 		{
-			CTrailPart &Part = s_Trail.at(i);
-			vec2 PrevPos;
-			vec2 Pos = s_Trail.at(i).m_Pos;
-			vec2 NextPos;
+			Top = Pos + Tangent * Width;
+			Bot = Pos - Tangent * Width;
 
-			if(i == 0)
+			float Det = PrevDirection.x * NextDirection.y - PrevDirection.y * NextDirection.x;
+			if(Det >= 0.0f)
 			{
-				vec2 Direction = normalize(s_Trail.at(i + 1).m_Pos - Pos);
-				PrevPos = Pos - Direction;
+				Part.m_Top = Top;
+				Part.m_Bot = Bot;
+				if(i > 0)
+					vTrail.at(i).m_Flip = true;
 			}
-			else
-				PrevPos = s_Trail.at(i - 1).m_Pos;
-
-			if(i == (int)s_Trail.size() - 1)
+			else // <-Left Direction
 			{
-				vec2 Direction = normalize(Pos - s_Trail.at(i - 1).m_Pos);
-				NextPos = Pos + Direction;
+				Part.m_Top = Bot;
+				Part.m_Bot = Top;
+				if(i > 0)
+					vTrail.at(i).m_Flip = true;
 			}
-			else
-				NextPos = s_Trail.at(i + 1).m_Pos;
-
-			vec2 NextDirection = normalize(NextPos - Pos);
-			vec2 PrevDirection = normalize(Pos - PrevPos);
-
-			vec2 Normal = vec2(-PrevDirection.y, PrevDirection.x);
-			Part.m_Normal = Normal;
-			vec2 Tangent = normalize(NextDirection + PrevDirection);
-			if(Tangent == vec2(0.0f, 0.0f))
-				Tangent = Normal;
-
-			vec2 PerpVec = vec2(-Tangent.y, Tangent.x);
-			Width = Part.m_Width;
-			float ScaledWidth = Width / dot(Normal, PerpVec);
-			float TopScaled = ScaledWidth;
-			float BotScaled = ScaledWidth;
-			if(dot(PrevDirection, Tangent) > 0.0f)
-				TopScaled = std::min(Width * 3.0f, TopScaled);
-			else
-				BotScaled = std::min(Width * 3.0f, BotScaled);
+		}
+	}
 
-			vec2 Top = Pos + PerpVec * TopScaled;
-			vec2 Bot = Pos - PerpVec * BotScaled;
-			Part.m_Top = Top;
-			Part.m_Bot = Bot;
+	// Draw the trail
+	for(int i = 0; i < (int)vTrail.size() - 1; i++)
+	{
+		const CTrailPart &Part = vTrail.at(i);
+		const CTrailPart &NextPart = vTrail.at(i + 1);
+		const float Dist = distance(Part.m_UnmovedPos, NextPart.m_UnmovedPos);
 
-			// Bevel Cap
-			if(dot(PrevDirection, NextDirection) < -0.25f)
-			{
-				Top = Pos + Tangent * Width;
-				Bot = Pos - Tangent * Width;
-
-				float Det = PrevDirection.x * NextDirection.y - PrevDirection.y * NextDirection.x;
-				if(Det >= 0.0f)
-				{
-					Part.m_Top = Top;
-					Part.m_Bot = Bot;
-					if(i > 0)
-						s_Trail.at(i).m_Flip = true;
-				}
-				else // <-Left Direction
-				{
-					Part.m_Top = Bot;
-					Part.m_Bot = Top;
-					if(i > 0)
-						s_Trail.at(i).m_Flip = true;
-				}
-			}
+		const float MaxDiff = 120.0f;
+		if(i > 0)
+		{
+			const CTrailPart &PrevPart = vTrail.at(i - 1);
+			float PrevDist = distance(PrevPart.m_UnmovedPos, Part.m_UnmovedPos);
+			if(std::abs(Dist - PrevDist) > MaxDiff)
+				continue;
+		}
+		if(i < (int)vTrail.size() - 2)
+		{
+			const CTrailPart &NextNextPart = vTrail.at(i + 2);
+			float NextDist = distance(NextPart.m_UnmovedPos, NextNextPart.m_UnmovedPos);
+			if(std::abs(Dist - NextDist) > MaxDiff)
+				continue;
 		}
 
 		if(LineMode)
-			Graphics()->LinesBegin();
+		{
+			m_vLines.push_back({IGraphics::CLineItem(Part.m_Pos.x, Part.m_Pos.y, NextPart.m_Pos.x, NextPart.m_Pos.y), Part.m_Col});
+		}
 		else
-			Graphics()->QuadsBegin();
-
-		// Draw the trail
-		for(int i = 0; i < (int)s_Trail.size() - 1; i++)
 		{
-			const CTrailPart &Part = s_Trail.at(i);
-			const CTrailPart &NextPart = s_Trail.at(i + 1);
-			const float Dist = distance(Part.m_UnmovedPos, NextPart.m_UnmovedPos);
-
-			const float MaxDiff = 120.0f;
-			if(i > 0)
-			{
-				const CTrailPart &PrevPart = s_Trail.at(i - 1);
-				float PrevDist = distance(PrevPart.m_UnmovedPos, Part.m_UnmovedPos);
-				if(std::abs(Dist - PrevDist) > MaxDiff)
-					continue;
-			}
-			if(i < (int)s_Trail.size() - 2)
-			{
-				const CTrailPart &NextNextPart = s_Trail.at(i + 2);
-				float NextDist = distance(NextPart.m_UnmovedPos, NextNextPart.m_UnmovedPos);
-				if(std::abs(Dist - NextDist) > MaxDiff)
-					continue;
-			}
-
-			if(LineMode)
+			vec2 Top, Bot;
+			if(Part.m_Flip)
 			{
-				Graphics()->SetColor(Part.m_Col);
-				LineItem = IGraphics::CLineItem(Part.m_Pos.x, Part.m_Pos.y, NextPart.m_Pos.x, NextPart.m_Pos.y);
-				Graphics()->LinesDraw(&LineItem, 1);
+				Top = Part.m_Bot;
+				Bot = Part.m_Top;
 			}
 			else
 			{
-				vec2 Top, Bot;
-				if(Part.m_Flip)
-				{
-					Top = Part.m_Bot;
-					Bot = Part.m_Top;
-				}
-				else
-				{
-					Top = Part.m_Top;
-					Bot = Part.m_Bot;
-				}
-
-				Graphics()->SetColor4(NextPart.m_Col, NextPart.m_Col, Part.m_Col, Part.m_Col);
-				// IGraphics::CFreeformItem FreeformItem(Top, Bot, NextPart.m_Top, NextPart.m_Bot);
-				IGraphics::CFreeformItem FreeformItem(NextPart.m_Top, NextPart.m_Bot, Top, Bot);
-
-				Graphics()->QuadsDrawFreeform(&FreeformItem, 1);
+				Top = Part.m_Top;
+				Bot = Part.m_Bot;
 			}
+
+			// IGraphics::CFreeformItem FreeformItem(Top, Bot, NextPart.m_Top, NextPart.m_Bot);
+			m_vQuads.push_back({IGraphics::CFreeformItem(NextPart.m_Top, NextPart.m_Bot, Top, Bot), {NextPart.m_Col, NextPart.m_Col, Part.m_Col, Part.m_Col}});
 		}
-		if(LineMode)
-			Graphics()->LinesEnd();
-		else
-			Graphics()->QuadsEnd();
 	}
 }
@@ -5,8 +5,12 @@
 
 #include <engine/shared/protocol.h>
 
+#include <engine/graphics.h>
+
 #include <game/client/component.h>
 
+#include <vector>
+
 class CTrailPart
 {
 public:
@@ -44,18 +48,40 @@ public:
 	};
 
 private:
-	class CInfo
+	static constexpr int HISTORY_SIZE = 200;
+
+	// Ring buffers indexed by tick % HISTORY_SIZE, ticks are kept apart
+	// from positions so validity checks don't touch the position data
+	class CHistory
 	{
 	public:
-		vec2 m_Pos;
-		int m_Tick;
+		vec2 m_aPos[HISTORY_SIZE];
+		int m_aTick[HISTORY_SIZE];
 	};
-	CInfo m_History[MAX_CLIENTS][200];
+	CHistory m_aHistory[MAX_CLIENTS];
 	bool m_HistoryValid[MAX_CLIENTS] = {};
 
+	// Segments of all players for this frame, drawn with one begin/end pair
+	class CTrailQuad
+	{
+	public:
+		IGraphics::CFreeformItem m_Item;
+		ColorRGBA m_aColors[4];
+	};
+	class CTrailLine
+	{
+	public:
+		IGraphics::CLineItem m_Item;
+		ColorRGBA m_Color;
+	};
+	std::vector<CTrailPart> m_vTrail;
+	std::vector<CTrailQuad> m_vQuads;
+	std::vector<CTrailLine> m_vLines;
+
 	void ClearAllHistory();
 	void ClearHistory(int ClientId);
 	bool ShouldPredictPlayer(int ClientId);
+	void AddTrail(int ClientId, bool LineMode);
 };
 
 #endif
@@ -60,9 +60,18 @@ class ITranslateBackendHttp : public ITranslateBackend
 {
 protected:
 	std::shared_ptr<CHttpRequest> m_pHttpRequest = nullptr;
-	virtual bool ParseResponse(CTranslateResponse &Out) = 0;
+	virtual bool ParseResponse(std::vector<CTranslateResponse> &vOut) = 0;
 	virtual bool ParseHttpError() const { return false; }
 
+	static void SetError(std::vector<CTranslateResponse> &vOut, const char *pError)
+	{
+		for(auto &Out : vOut)
+		{
+			str_copy(Out.m_Text, pError);
+			Out.m_Error = true;
+		}
+	}
+
 	void CreateHttpRequest(IHttp &Http, const char *pUrl)
 	{
 		auto pGet = std::make_shared<CHttpRequest>(pUrl);
@@ -71,31 +80,38 @@ protected:
 		pGet->Timeout(CTimeout{10000, 0, 500, 10});
 
 		m_pHttpRequest = pGet;
-		Http.Run(pGet);
+	}
+
+	// Only run once the body and headers are set, the request is picked up by the http thread
+	void RunHttpRequest(IHttp &Http)
+	{
+		Http.Run(m_pHttpRequest);
 	}
 
 public:
-	std::optional<bool> Update(CTranslateResponse &Out) override
+	std::optional<bool> Update(std::vector<CTranslateResponse> &vOut) override
 	{
 		dbg_assert(m_pHttpRequest != nullptr, "m_pHttpRequest is nullptr");
 		if(m_pHttpRequest->State() == EHttpState::RUNNING || m_pHttpRequest->State() == EHttpState::QUEUED)
 			return std::nullopt;
 		if(m_pHttpRequest->State() == EHttpState::ABORTED)
 		{
-			str_copy(Out.m_Text, "Aborted");
+			SetError(vOut, "Aborted");
 			return false;
 		}
 		if(m_pHttpRequest->State() != EHttpState::DONE)
 		{
-			str_copy(Out.m_Text, "Curl error, see console");
+			SetError(vOut, "Curl error, see console");
 			return false;
 		}
 		if(m_pHttpRequest->StatusCode() != 200 && !ParseHttpError())
 		{
-			str_format(Out.m_Text, sizeof(Out.m_Text), "Got http code %d", m_pHttpRequest->StatusCode());
+			char aError[64];
+			str_format(aError, sizeof(aError), "Got http code %d", m_pHttpRequest->StatusCode());
+			SetError(vOut, aError);
 			return false;
 		}
-		return ParseResponse(Out);
+		return ParseResponse(vOut);
 	}
 	~ITranslateBackendHttp() override
 	{
@@ -107,31 +123,8 @@ public:
 class CTranslateBackendLibretranslate : public ITranslateBackendHttp
 {
 private:
-	bool ParseResponseJson(const json_value *pObj, CTranslateResponse &Out)
+	static bool ParseResult(const json_value *pTranslatedText, const json_value *pDetectedLanguage, CTranslateResponse &Out)
 	{
-		if(!pObj)
-		{
-			str_copy(Out.m_Text, "Response is not JSON");
-			return false;
-		}
-
-		if(pObj->type != json_object)
-		{
-			str_copy(Out.m_Text, "Response is not object");
-			return false;
-		}
-
-		const json_value *pError = json_object_get(pObj, "error");
-		if(pError != &json_value_none)
-		{
-			if(pError->type != json_string)
-				str_copy(Out.m_Text, "Error is not string");
-			else
-				str_copy(Out.m_Text, pError->u.string.ptr);
-			return false;
-		}
-
-		const json_value *pTranslatedText = json_object_get(pObj, "translatedText");
 		if(pTranslatedText == &json_value_none)
 		{
 			str_copy(Out.m_Text, "No translatedText");
@@ -143,7 +136,6 @@ private:
 			return false;
 		}
 
-		const json_value *pDetectedLanguage = json_object_get(pObj, "detectedLanguage");
 		if(pDetectedLanguage == &json_value_none)
 		{
 			str_copy(Out.m_Text, "No pDetectedLanguage");
@@ -181,11 +173,52 @@ private:
 		return true;
 	}
 
+	bool ParseResponseJson(const json_value *pObj, std::vector<CTranslateResponse> &vOut)
+	{
+		if(!pObj)
+		{
+			SetError(vOut, "Response is not JSON");
+			return false;
+		}
+
+		if(pObj->type != json_object)
+		{
+			SetError(vOut, "Response is not object");
+			return false;
+		}
+
+		const json_value *pError = json_object_get(pObj, "error");
+		if(pError != &json_value_none)
+		{
+			SetError(vOut, pError->type != json_string ? "Error is not string" : pError->u.string.ptr);
+			return false;
+		}
+
+		// A single text is sent as string, a batch as array of strings
+		const json_value *pTranslatedText = json_object_get(pObj, "translatedText");
+		const json_value *pDetectedLanguage = json_object_get(pObj, "detectedLanguage");
+		if(vOut.size() == 1)
+		{
+			vOut[0].m_Error = !ParseResult(pTranslatedText, pDetectedLanguage, vOut[0]);
+			return !vOut[0].m_Error;
+		}
+
+		if(pTranslatedText->type != json_array || pTranslatedText->u.array.length != vOut.size())
+		{
+			SetError(vOut, "translatedText does not match batch");
+			return false;
+		}
+		const bool LanguagePerText = pDetectedLanguage->type == json_array && pDetectedLanguage->u.array.length == vOut.size();
+		for(size_t i = 0; i < vOut.size(); i++)
+			vOut[i].m_Error = !ParseResult(pTranslatedText->u.array.values[i], LanguagePerText ? pDetectedLanguage->u.array.values[i] : pDetectedLanguage, vOut[i]);
+		return true;
+	}
+
 protected:
-	bool ParseResponse(CTranslateResponse &Out) override
+	bool ParseResponse(std::vector<CTranslateResponse> &vOut) override
 	{
 		json_value *pObj = m_pHttpRequest->ResultJson();
-		bool Res = ParseResponseJson(pObj, Out);
+		bool Res = ParseResponseJson(pObj, vOut);
 		json_value_free(pObj);
 		return Res;
 	}
@@ -196,12 +229,22 @@ public:
 	{
 		return "LibreTranslate";
 	}
-	CTranslateBackendLibretranslate(IHttp &Http, const char *pText)
+	CTranslateBackendLibretranslate(IHttp &Http, const std::vector<const char *> &vpTexts)
 	{
 		CJsonStringWriter Json = CJsonStringWriter();
 		Json.BeginObject();
 		Json.WriteAttribute("q");
-		Json.WriteStrValue(pText);
+		if(vpTexts.size() == 1)
+		{
+			Json.WriteStrValue(vpTexts[0]);
+		}
+		else
+		{
+			Json.BeginArray();
+			for(const char *pText : vpTexts)
+				Json.WriteStrValue(pText);
+			Json.EndArray();
+		}
 		Json.WriteAttribute("source");
 		Json.WriteStrValue("auto");
 		Json.WriteAttribute("target");
@@ -217,6 +260,7 @@ public:
 		CreateHttpRequest(Http, g_Config.m_TcTranslateEndpoint[0] == '\0' ? "localhost:5000/translate" : g_Config.m_TcTranslateEndpoint);
 		std::string JsonPayload = Json.GetOutputString();
 		m_pHttpRequest->PostJson(JsonPayload.c_str());
+		RunHttpRequest(Http);
 	}
 };
 
@@ -268,11 +312,13 @@ private:
 	}
 
 protected:
-	bool ParseResponse(CTranslateResponse &Out) override
+	bool ParseResponse(std::vector<CTranslateResponse> &vOut) override
 	{
+		dbg_assert(vOut.size() == 1, "FTAPI does not support batches");
 		json_value *pObj = m_pHttpRequest->ResultJson();
-		bool Res = ParseResponseJson(pObj, Out);
+		bool Res = ParseResponseJson(pObj, vOut[0]);
 		json_value_free(pObj);
+		vOut[0].m_Error = !Res;
 		return Res;
 	}
 
@@ -299,6 +345,7 @@ public:
 		UrlEncode(pText, aBuf + strlen(aBuf), sizeof(aBuf) - strlen(aBuf));
 
 		CreateHttpRequest(Http, aBuf);
+		RunHttpRequest(Http);
 	}
 };
 
@@ -318,27 +365,8 @@ private:
 		pDst[i] = '\0';
 	}
 
-	bool ParseResponseJson(const json_value *pObj, CTranslateResponse &Out)
+	static bool ParseEntry(const json_value *pEntry, CTranslateResponse &Out)
 	{
-		if(!pObj || pObj->type != json_object)
-		{
-			str_copy(Out.m_Text, "Response is not JSON object");
-			return false;
-		}
-
-		const json_value *pTranslations = json_object_get(pObj, "translations");
-		if(pTranslations == &json_value_none)
-		{
-			str_copy(Out.m_Text, "No translations entry");
-			return false;
-		}
-		if(pTranslations->type != json_array || pTranslations->u.array.length == 0)
-		{
-			str_copy(Out.m_Text, "translations is empty");
-			return false;
-		}
-
-		const json_value *pEntry = pTranslations->u.array.values[0];
 		if(!pEntry || pEntry->type != json_object)
 		{
 			str_copy(Out.m_Text, "translation entry invalid");
@@ -362,41 +390,79 @@ private:
 		return true;
 	}
 
-	protected:
-		bool ParseResponse(CTranslateResponse &Out) override
+	bool ParseResponseJson(const json_value *pObj, std::vector<CTranslateResponse> &vOut)
+	{
+		if(!pObj || pObj->type != json_object)
 		{
-			json_value *pObj = m_pHttpRequest->ResultJson();
-			bool Res = ParseResponseJson(pObj, Out);
-			json_value_free(pObj);
-			return Res;
+			SetError(vOut, "Response is not JSON object");
+			return false;
 		}
 
-	public:
-		const char *Name() const override { return "DeepL"; }
-
-		CTranslateBackendDeepl(IHttp &Http, const char *pText)
+		const json_value *pTranslations = json_object_get(pObj, "translations");
+		if(pTranslations == &json_value_none)
 		{
-			const char *pEndpoint = g_Config.m_TcTranslateEndpoint[0] != '\0' ? g_Config.m_TcTranslateEndpoint : "https://api-free.deepl.com/v2/translate";
-			CreateHttpRequest(Http, pEndpoint);
+			SetError(vOut, "No translations entry");
+			return false;
+		}
+		if(pTranslations->type != json_array || pTranslations->u.array.length == 0)
+		{
+			SetError(vOut, "translations is empty");
+			return false;
+		}
+		if(pTranslations->u.array.length != vOut.size())
+		{
+			SetError(vOut, "translations does not match batch");
+			return false;
+		}
+
+		// DeepL returns the translations in the order the text fields were sent
+		for(size_t i = 0; i < vOut.size(); i++)
+			vOut[i].m_Error = !ParseEntry(pTranslations->u.array.values[i], vOut[i]);
+		return true;
+	}
 
-			if(g_Config.m_TcTranslateKey[0] != '\0')
+protected:
+	bool ParseResponse(std::vector<CTranslateResponse> &vOut) override
+	{
+		json_value *pObj = m_pHttpRequest->ResultJson();
+		bool Res = ParseResponseJson(pObj, vOut);
+		json_value_free(pObj);
+		return Res;
+	}
+
+public:
+	const char *Name() const override { return "DeepL"; }
+
+	CTranslateBackendDeepl(IHttp &Http, const std::vector<const char *> &vpTexts)
+	{
+		const char *pEndpoint = g_Config.m_TcTranslateEndpoint[0] != '\0' ? g_Config.m_TcTranslateEndpoint : "https://api-free.deepl.com/v2/translate";
+		CreateHttpRequest(Http, pEndpoint);
+
+		if(g_Config.m_TcTranslateKey[0] != '\0')
 		{
 			char aAuth[512];
 			str_format(aAuth, sizeof(aAuth), "DeepL-Auth-Key %s", g_Config.m_TcTranslateKey);
 			m_pHttpRequest->HeaderString("Authorization", aAuth);
-			}
-			m_pHttpRequest->HeaderString("Content-Type", "application/x-www-form-urlencoded");
+		}
+		m_pHttpRequest->HeaderString("Content-Type", "application/x-www-form-urlencoded");
 
-			char aEncoded[4096];
+		std::string Body;
+		char aEncoded[4096];
+		for(const char *pText : vpTexts)
+		{
 			UrlEncode(pText, aEncoded, sizeof(aEncoded));
-			char aTarget[16];
-			UpperCopy(aTarget, sizeof(aTarget), EncodeTarget(g_Config.m_TcTranslateTarget));
-			char aBody[8192];
-			str_format(aBody, sizeof(aBody), "text=%s&target_lang=%s", aEncoded, aTarget);
-			const size_t BodyLen = str_length(aBody);
-			m_pHttpRequest->Post((const unsigned char *)aBody, BodyLen);
-		}
-	};
+			Body.append("text=");
+			Body.append(aEncoded);
+			Body.push_back('&');
+		}
+		char aTarget[16];
+		UpperCopy(aTarget, sizeof(aTarget), EncodeTarget(g_Config.m_TcTranslateTarget));
+		Body.append("target_lang=");
+		Body.append(aTarget);
+		m_pHttpRequest->Post((const unsigned char *)Body.c_str(), Body.size());
+		RunHttpRequest(Http);
+	}
+};
 
 void CTranslate::ConTranslate(IConsole::IResult *pResult, void *pUserData)
 {
@@ -482,6 +548,22 @@ void CTranslate::Translate(const char *pName, bool ShowProgress)
 	Translate(*pLineBest, ShowProgress);
 }
 
+static const char *BackendName(const char *pBackend)
+{
+	if(str_comp_nocase(pBackend, "libretranslate") == 0)
+		return "LibreTranslate";
+	if(str_comp_nocase(pBackend, "ftapi") == 0)
+		return "FreeTranslateAPI";
+	if(str_comp_nocase(pBackend, "deepl") == 0)
+		return "DeepL";
+	return nullptr;
+}
+
+bool CTranslate::IsBatchBackend(const char *pBackend)
+{
+	return str_comp_nocase(pBackend, "libretranslate") == 0 || str_comp_nocase(pBackend, "deepl") == 0;
+}
+
 void CTranslate::Translate(CChat::CLine &Line, bool ShowProgress)
 {
 	if(m_vJobs.size() > 15)
@@ -489,67 +571,156 @@ void CTranslate::Translate(CChat::CLine &Line, bool ShowProgress)
 		return;
 	}
 
-	CTranslateJob Job;
-	Job.m_pLine = &Line;
-	Job.m_pTranslateResponse = std::make_shared<CTranslateResponse>();
-	Job.m_pLine->m_pTranslateResponse = Job.m_pTranslateResponse;
-
-	if(str_comp_nocase(g_Config.m_TcTranslateBackend, "libretranslate") == 0)
-		Job.m_pBackend = std::make_unique<CTranslateBackendLibretranslate>(*Http(), Job.m_pLine->m_aText);
-	else if(str_comp_nocase(g_Config.m_TcTranslateBackend, "ftapi") == 0)
-		Job.m_pBackend = std::make_unique<CTranslateBackendFtapi>(*Http(), Job.m_pLine->m_aText);
-	else if(str_comp_nocase(g_Config.m_TcTranslateBackend, "deepl") == 0)
+	if(const CTranslationCache::CEntry *pCached = GameClient()->m_TranslationCache.Find(g_Config.m_TcTranslateBackend, g_Config.m_TcTranslateTarget, Line.m_aText))
 	{
-		Job.m_pBackend = std::make_unique<CTranslateBackendDeepl>(*Http(), Job.m_pLine->m_aText);
+		auto pResponse = std::make_shared<CTranslateResponse>();
+		if(str_comp_nocase(Line.m_aText, pCached->m_Text.c_str()) != 0) // Check for no translation difference
+		{
+			str_copy(pResponse->m_Text, pCached->m_Text.c_str());
+			str_copy(pResponse->m_Language, pCached->m_Language.c_str());
+		}
+		Line.m_pTranslateResponse = pResponse;
+		Line.m_Time = time();
+		GameClient()->m_Chat.RebuildChat();
+		return;
 	}
-	else
+
+	const char *pBackendName = BackendName(g_Config.m_TcTranslateBackend);
+	if(!pBackendName)
 	{
 		GameClient()->m_Chat.Echo("Invalid translate backend");
 		return;
 	}
 
+	auto pTranslateResponse = std::make_shared<CTranslateResponse>();
+	Line.m_pTranslateResponse = pTranslateResponse;
 	if(ShowProgress)
 	{
-		str_format(Job.m_pTranslateResponse->m_Text, sizeof(Job.m_pTranslateResponse->m_Text), TCLocalize("%s translating to %s", "translate"), Job.m_pBackend->Name(), g_Config.m_TcTranslateTarget);
-		Job.m_pLine->m_Time = time();
+		str_format(pTranslateResponse->m_Text, sizeof(pTranslateResponse->m_Text), TCLocalize("%s translating to %s", "translate"), pBackendName, g_Config.m_TcTranslateTarget);
+		Line.m_Time = time();
 	}
-	else
+
+	const bool Batch = g_Config.m_TcTranslateBatchWindow > 0 && IsBatchBackend(g_Config.m_TcTranslateBackend);
+	if(Batch && !m_PendingBatch.m_vpLines.empty() &&
+		(str_comp(m_PendingBatch.m_aBackend, g_Config.m_TcTranslateBackend) != 0 || str_comp(m_PendingBatch.m_aTarget, g_Config.m_TcTranslateTarget) != 0))
 	{
-		Job.m_pTranslateResponse->m_Text[0] = '\0';
+		FlushBatch();
 	}
 
-	m_vJobs.emplace_back(std::move(Job));
+	CTranslateJob SingleJob;
+	CTranslateJob &Job = Batch ? m_PendingBatch : SingleJob;
+	if(Job.m_vpLines.empty())
+	{
+		str_copy(Job.m_aBackend, g_Config.m_TcTranslateBackend);
+		str_copy(Job.m_aTarget, g_Config.m_TcTranslateTarget);
+		if(Batch)
+			m_PendingBatchStart = time_get();
+	}
+	Job.m_vpLines.push_back(&Line);
+	Job.m_vpTranslateResponses.push_back(pTranslateResponse);
+
+	if(!Batch)
+	{
+		if(StartJob(Job))
+			m_vJobs.emplace_back(std::move(Job));
+	}
+	else if((int)m_PendingBatch.m_vpLines.size() >= MAX_BATCH_SIZE)
+	{
+		FlushBatch();
+	}
 
 	if(ShowProgress)
 		GameClient()->m_Chat.RebuildChat();
 }
 
+bool CTranslate::StartJob(CTranslateJob &Job)
+{
+	std::vector<const char *> vpTexts;
+	vpTexts.reserve(Job.m_vpLines.size());
+	for(const CChat::CLine *pLine : Job.m_vpLines)
+		vpTexts.push_back(pLine->m_aText);
+
+	if(str_comp_nocase(Job.m_aBackend, "libretranslate") == 0)
+		Job.m_pBackend = std::make_unique<CTranslateBackendLibretranslate>(*Http(), vpTexts);
+	else if(str_comp_nocase(Job.m_aBackend, "ftapi") == 0)
+		Job.m_pBackend = std::make_unique<CTranslateBackendFtapi>(*Http(), vpTexts[0]);
+	else if(str_comp_nocase(Job.m_aBackend, "deepl") == 0)
+		Job.m_pBackend = std::make_unique<CTranslateBackendDeepl>(*Http(), vpTexts);
+	else
+		return false;
+
+	Job.m_vResults.resize(Job.m_vpLines.size());
+	return true;
+}
+
+void CTranslate::FlushBatch()
+{
+	// Drop lines which have been overwritten while waiting
+	CTranslateJob Job = std::move(m_PendingBatch);
+	m_PendingBatch = CTranslateJob();
+	for(size_t i = 0; i < Job.m_vpLines.size();)
+	{
+		if(Job.m_vpLines[i]->m_pTranslateResponse != Job.m_vpTranslateResponses[i])
+		{
+			Job.m_vpLines.erase(Job.m_vpLines.begin() + i);
+			Job.m_vpTranslateResponses.erase(Job.m_vpTranslateResponses.begin() + i);
+		}
+		else
+			++i;
+	}
+	if(Job.m_vpLines.empty())
+		return;
+
+	if(StartJob(Job))
+		m_vJobs.emplace_back(std::move(Job));
+}
+
 void CTranslate::OnRender()
 {
+	if(!m_PendingBatch.m_vpLines.empty() && time_get() - m_PendingBatchStart >= (int64_t)g_Config.m_TcTranslateBatchWindow * time_freq() / 1000)
+		FlushBatch();
+
 	const auto Time = time();
+	bool Rebuild = false;
 	auto ForEach = [&](CTranslateJob &Job) {
-		if(Job.m_pLine->m_pTranslateResponse != Job.m_pTranslateResponse)
-			return true; // Not the same line anymore
-		const std::optional<bool> Done = Job.m_pBackend->Update(*Job.m_pTranslateResponse);
+		bool AnyLine = false;
+		for(size_t i = 0; i < Job.m_vpLines.size(); i++)
+			AnyLine |= Job.m_vpLines[i]->m_pTranslateResponse == Job.m_vpTranslateResponses[i];
+		if(!AnyLine)
+			return true; // Not the same lines anymore
+		const std::optional<bool> Done = Job.m_pBackend->Update(Job.m_vResults);
 		if(!Done.has_value())
 			return false; // Keep ongoing tasks
-		if(*Done)
+		for(size_t i = 0; i < Job.m_vpLines.size(); i++)
 		{
-			if(str_comp_nocase(Job.m_pLine->m_aText, Job.m_pTranslateResponse->m_Text) == 0) // Check for no translation difference
-				Job.m_pTranslateResponse->m_Text[0] = '\0';
-		}
-		else
-		{
-			char aBuf[sizeof(Job.m_pTranslateResponse->m_Text)];
-			str_format(aBuf, sizeof(aBuf), TCLocalize("%s to %s failed: %s", "translate"), Job.m_pBackend->Name(), g_Config.m_TcTranslateTarget, Job.m_pTranslateResponse->m_Text);
-			Job.m_pTranslateResponse->m_Error = true;
-			str_copy(Job.m_pTranslateResponse->m_Text, aBuf);
+			CChat::CLine *pLine = Job.m_vpLines[i];
+			CTranslateResponse &Response = *Job.m_vpTranslateResponses[i];
+			const CTranslateResponse &Result = Job.m_vResults[i];
+			if(pLine->m_pTranslateResponse != Job.m_vpTranslateResponses[i])
+				continue;
+			if(*Done && !Result.m_Error)
+			{
+				GameClient()->m_TranslationCache.Add(Job.m_aBackend, Job.m_aTarget, pLine->m_aText, Result.m_Text, Result.m_Language);
+				Response.m_Error = false;
+				str_copy(Response.m_Language, Result.m_Language);
+				if(str_comp_nocase(pLine->m_aText, Result.m_Text) == 0) // Check for no translation difference
+					Response.m_Text[0] = '\0';
+				else
+					str_copy(Response.m_Text, Result.m_Text);
+			}
+			else
+			{
+				str_format(Response.m_Text, sizeof(Response.m_Text), TCLocalize("%s to %s failed: %s", "translate"), Job.m_pBackend->Name(), Job.m_aTarget, Result.m_Text);
+				Response.m_Error = true;
+			}
+			pLine->m_Time = Time;
 		}
-		Job.m_pLine->m_Time = Time;
-		GameClient()->m_Chat.RebuildChat();
+		Rebuild = true;
 		return true;
 	};
 	m_vJobs.erase(std::remove_if(m_vJobs.begin(), m_vJobs.end(), ForEach), m_vJobs.end());
+	if(Rebuild)
+		GameClient()->m_Chat.RebuildChat();
 }
 
 void CTranslate::AutoTranslate(CChat::CLine &Line)
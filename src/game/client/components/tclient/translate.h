@@ -17,7 +17,8 @@ public:
 	virtual const char *EncodeTarget(const char *pTarget) const;
 	virtual bool CompareTargets(const char *pA, const char *pB) const;
 	virtual const char *Name() const = 0;
-	virtual std::optional<bool> Update(CTranslateResponse &Out) = 0;
+	// Fills one response per text the backend was created with
+	virtual std::optional<bool> Update(std::vector<CTranslateResponse> &vOut) = 0;
 };
 
 class CTranslate : public CComponent
@@ -26,12 +27,25 @@ class CTranslate : public CComponent
 	{
 	public:
 		std::unique_ptr<ITranslateBackend> m_pBackend = nullptr;
-		// For chat translations
-		CChat::CLine *m_pLine = nullptr;
-		std::shared_ptr<CTranslateResponse> m_pTranslateResponse = nullptr;
+		// For chat translations, one entry per line of a batch
+		std::vector<CChat::CLine *> m_vpLines;
+		std::vector<std::shared_ptr<CTranslateResponse>> m_vpTranslateResponses;
+		std::vector<CTranslateResponse> m_vResults;
+		// Cache key parts, config may change while the request is running
+		char m_aBackend[32] = "";
+		char m_aTarget[16] = "";
 	};
 	std::vector<CTranslateJob> m_vJobs;
 
+	// Lines collected for backends which accept several texts per request
+	static constexpr int MAX_BATCH_SIZE = 25;
+	CTranslateJob m_PendingBatch;
+	int64_t m_PendingBatchStart = 0;
+
+	static bool IsBatchBackend(const char *pBackend);
+	bool StartJob(CTranslateJob &Job);
+	void FlushBatch();
+
 	static void ConTranslate(IConsole::IResult *pResult, void *pUserData);
 	static void ConTranslateId(IConsole::IResult *pResult, void *pUserData);
 
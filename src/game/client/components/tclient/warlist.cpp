@@ -215,6 +215,7 @@ void CWarList::UpdateWarEntry(int Index, const char *pName, const char *pClan, c
 		str_copy(m_vWarEntries[Index].m_aClan, pClan);
 		str_copy(m_vWarEntries[Index].m_aReason, pReason);
 		m_vWarEntries[Index].m_pWarType = pType;
+		OnWarListChanged();
 	}
 }
 
@@ -227,6 +228,7 @@ void CWarList::UpsertWarType(int Index, const char *pType, ColorRGBA Color)
 	{
 		str_copy(m_WarTypes[Index]->m_aWarName, pType);
 		m_WarTypes[Index]->m_Color = Color;
+		m_Generation++;
 	}
 	else
 	{
@@ -257,6 +259,8 @@ void CWarList::AddWarEntry(const char *pName, const char *pClan, const char *pRe
 	if(!g_Config.m_TcWarListAllowDuplicates)
 		RemoveWarEntryDuplicates(pName, pClan);
 	m_vWarEntries.push_back(Entry);
+	AddToIndex(m_vWarEntries.size() - 1);
+	m_Generation++;
 }
 
 void CWarList::RemoveWarEntryDuplicates(const char *pName, const char *pClan)
@@ -271,7 +275,10 @@ void CWarList::RemoveWarEntryDuplicates(const char *pName, const char *pClan)
 			(str_comp(It->m_aClan, pClan) == 0);
 
 		if(IsDuplicate)
+		{
 			It = m_vWarEntries.erase(It);
+			OnWarListChanged();
+		}
 		else
 			++It;
 	}
@@ -292,6 +299,7 @@ void CWarList::AddWarType(const char *pType, ColorRGBA Color)
 	{
 		Type->m_Color = Color;
 	}
+	m_Generation++;
 }
 
 void CWarList::RemoveWarEntry(const char *pName, const char *pClan, const char *pType)
@@ -300,7 +308,10 @@ void CWarList::RemoveWarEntry(const char *pName, const char *pClan, const char *
 	CWarEntry Entry(pWarType, pName, pClan, "");
 	auto It = std::find(m_vWarEntries.begin(), m_vWarEntries.end(), Entry);
 	if(It != m_vWarEntries.end())
+	{
 		m_vWarEntries.erase(It);
+		OnWarListChanged();
+	}
 }
 
 void CWarList::RemoveWarEntry(CWarEntry *Entry)
@@ -308,7 +319,10 @@ void CWarList::RemoveWarEntry(CWarEntry *Entry)
 	auto It = std::find_if(m_vWarEntries.begin(), m_vWarEntries.end(),
 		[Entry](const CWarEntry &WarEntry) { return &WarEntry == Entry; });
 	if(It != m_vWarEntries.end())
+	{
 		m_vWarEntries.erase(It);
+		OnWarListChanged();
+	}
 }
 
 void CWarList::RemoveWarType(const char *pType)
@@ -332,6 +346,7 @@ void CWarList::RemoveWarType(const char *pType)
 			}
 		}
 		m_WarTypes.erase(It);
+		m_Generation++;
 	}
 }
 
@@ -411,43 +426,112 @@ void CWarList::SortWarEntries()
 	// TODO
 }
 
+void CWarList::OnWarListChanged()
+{
+	m_IndexValid = false;
+	m_Generation++;
+}
+
+void CWarList::RebuildIndex()
+{
+	m_NameIndex.clear();
+	m_ClanIndex.clear();
+	m_IndexValid = true;
+	for(int i = 0; i < (int)m_vWarEntries.size(); ++i)
+		AddToIndex(i);
+}
+
+void CWarList::AddToIndex(int EntryIndex)
+{
+	if(!m_IndexValid)
+		return;
+	const CWarEntry &Entry = m_vWarEntries[EntryIndex];
+	if(Entry.m_aName[0] != '\0')
+		m_NameIndex[Entry.m_aName].push_back(EntryIndex);
+	if(Entry.m_aClan[0] != '\0')
+		m_ClanIndex[Entry.m_aClan].push_back(EntryIndex);
+}
+
 void CWarList::UpdateWarPlayers()
 {
+	if(!m_IndexValid)
+		RebuildIndex();
+
 	for(int i = 0; i < (int)m_WarTypes.size(); ++i)
 		m_WarTypes[i]->m_Index = i;
 
 	for(int i = 0; i < MAX_CLIENTS; ++i)
 	{
-		if(!GameClient()->m_aClients[i].m_Active)
+		const CGameClient::CClientData &Client = GameClient()->m_aClients[i];
+		if(!Client.m_Active)
 			continue;
 
-		m_WarPlayers[i].m_WarName = false;
-		m_WarPlayers[i].m_WarClan = false;
-		memset(m_WarPlayers[i].m_aReason, 0, sizeof(m_WarPlayers[i].m_aReason));
-		m_WarPlayers[i].m_NameColor = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
-		m_WarPlayers[i].m_ClanColor = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
-		m_WarPlayers[i].m_WarGroupMatches.clear();
-		m_WarPlayers[i].m_WarGroupMatches.resize((int)m_WarTypes.size(), false);
+		CWarPlayerKey &Key = m_aWarPlayerKeys[i];
+		if(Key.m_Generation == m_Generation && str_comp(Key.m_aName, Client.m_aName) == 0 && str_comp(Key.m_aClan, Client.m_aClan) == 0)
+			continue;
 
-		for(CWarEntry &Entry : m_vWarEntries)
+		Key.m_Generation = m_Generation;
+		str_copy(Key.m_aName, Client.m_aName);
+		str_copy(Key.m_aClan, Client.m_aClan);
+		UpdateWarPlayer(i);
+	}
+}
+
+void CWarList::UpdateWarPlayer(int ClientId)
+{
+	const CGameClient::CClientData &Client = GameClient()->m_aClients[ClientId];
+	CWarDataCache &WarPlayer = m_WarPlayers[ClientId];
+
+	WarPlayer.m_WarName = false;
+	WarPlayer.m_WarClan = false;
+	memset(WarPlayer.m_aReason, 0, sizeof(WarPlayer.m_aReason));
+	WarPlayer.m_NameColor = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
+	WarPlayer.m_ClanColor = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
+	WarPlayer.m_WarGroupMatches.clear();
+	WarPlayer.m_WarGroupMatches.resize((int)m_WarTypes.size(), false);
+
+	static const std::vector<int> s_vEmpty;
+	const auto FindEntries = [](const std::unordered_map<std::string, std::vector<int>> &Index, const char *pKey) -> const std::vector<int> & {
+		if(pKey[0] == '\0')
+			return s_vEmpty;
+		auto It = Index.find(pKey);
+		return It == Index.end() ? s_vEmpty : It->second;
+	};
+	const std::vector<int> &vNameEntries = FindEntries(m_NameIndex, Client.m_aName);
+	const std::vector<int> &vClanEntries = FindEntries(m_ClanIndex, Client.m_aClan);
+
+	// Walk both matches in list order, later entries override earlier ones
+	size_t NamePos = 0;
+	size_t ClanPos = 0;
+	while(NamePos < vNameEntries.size() || ClanPos < vClanEntries.size())
+	{
+		int EntryIndex;
+		if(ClanPos >= vClanEntries.size() || (NamePos < vNameEntries.size() && vNameEntries[NamePos] <= vClanEntries[ClanPos]))
 		{
-			if(str_comp(GameClient()->m_aClients[i].m_aName, Entry.m_aName) == 0 && str_comp(Entry.m_aName, "") != 0)
-			{
-				str_copy(m_WarPlayers[i].m_aReason, Entry.m_aReason);
-				m_WarPlayers[i].m_WarName = true;
-				m_WarPlayers[i].m_NameColor = Entry.m_pWarType->m_Color;
-				m_WarPlayers[i].m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
-			}
-			else if(str_comp(GameClient()->m_aClients[i].m_aClan, Entry.m_aClan) == 0 && str_comp(Entry.m_aClan, "") != 0)
-			{
-				// Name war reason has priority over clan war reason
-				if(!m_WarPlayers[i].m_WarName)
-					str_copy(m_WarPlayers[i].m_aReason, Entry.m_aReason);
+			EntryIndex = vNameEntries[NamePos++];
+			if(ClanPos < vClanEntries.size() && vClanEntries[ClanPos] == EntryIndex)
+				ClanPos++;
+		}
+		else
+			EntryIndex = vClanEntries[ClanPos++];
 
-				m_WarPlayers[i].m_WarClan = true;
-				m_WarPlayers[i].m_ClanColor = Entry.m_pWarType->m_Color;
-				m_WarPlayers[i].m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
-			}
+		const CWarEntry &Entry = m_vWarEntries[EntryIndex];
+		if(str_comp(Client.m_aName, Entry.m_aName) == 0 && str_comp(Entry.m_aName, "") != 0)
+		{
+			str_copy(WarPlayer.m_aReason, Entry.m_aReason);
+			WarPlayer.m_WarName = true;
+			WarPlayer.m_NameColor = Entry.m_pWarType->m_Color;
+			WarPlayer.m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
+		}
+		else if(str_comp(Client.m_aClan, Entry.m_aClan) == 0 && str_comp(Entry.m_aClan, "") != 0)
+		{
+			// Name war reason has priority over clan war reason
+			if(!WarPlayer.m_WarName)
+				str_copy(WarPlayer.m_aReason, Entry.m_aReason);
+
+			WarPlayer.m_WarClan = true;
+			WarPlayer.m_ClanColor = Entry.m_pWarType->m_Color;
+			WarPlayer.m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
 		}
 	}
 }
@@ -8,6 +8,10 @@
 
 #include <game/client/component.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 enum
 {
 	MAX_WARLIST_TYPE_LENGTH = 16,
@@ -135,6 +139,28 @@ class CWarList : public CComponent
 
 	static void ConfigSaveCallback(IConfigManager *pConfigManager, void *pUserData);
 
+	// Indices into m_vWarEntries by name and clan, in list order. Adding
+	// entries appends to them, anything else rebuilds them on next use
+	std::unordered_map<std::string, std::vector<int>> m_NameIndex;
+	std::unordered_map<std::string, std::vector<int>> m_ClanIndex;
+	bool m_IndexValid = false;
+
+	// Bumped on every change of entries or types, players whose name, clan
+	// and generation did not change keep their cached war data
+	int m_Generation = 0;
+	class CWarPlayerKey
+	{
+	public:
+		char m_aName[MAX_NAME_LENGTH] = "";
+		char m_aClan[MAX_CLAN_LENGTH] = "";
+		int m_Generation = -1;
+	};
+	CWarPlayerKey m_aWarPlayerKeys[MAX_CLIENTS];
+
+	void RebuildIndex();
+	void AddToIndex(int EntryIndex);
+	void UpdateWarPlayer(int ClientId);
+
 public:
 	CWarList();
 	~CWarList() override;
@@ -150,9 +176,8 @@ public:
 	CWarType *m_pWarTypeNone = m_WarTypes[0];
 
 	// Duplicate war entries ARE allowed
+	// Call OnWarListChanged after modifying entries or types directly
 	std::vector<CWarEntry> m_vWarEntries;
-	// TODO: create an unordered map for war clans and war names, to speed up updating the WarPlayers cache
-	// It should be updated when m_WarList changes
 
 	CWarDataCache m_WarPlayers[MAX_CLIENTS];
 
@@ -161,6 +186,7 @@ public:
 	void OnConsoleInit() override;
 
 	void UpdateWarPlayers();
+	void OnWarListChanged();
 
 	void UpdateWarEntry(int Index, const char *pName, const char *pClan, const char *pReason, CWarType *pType);
 
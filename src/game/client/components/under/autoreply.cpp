@@ -7,10 +7,7 @@
 #include <engine/storage.h>
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
-#include <engine/shared/http.h>
-#include <engine/http.h>
 
-#include <memory>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
@@ -123,37 +120,20 @@ void CAutoreply::OnMessage(int Msg, void *pRawMsg)
         return;
 
     std::string dateTime = GetCurrentDateTime();
-    
-    // JSON 이스케이프 함수
-    auto escapeJson = [](const std::string& str) -> std::string {
-        std::string result;
-        for(char c : str) {
-            switch(c) {
-                case '"': result += "\\\""; break;
-                case '\\': result += "\\\\"; break;
-                case '\n': result += "\\n"; break;
-                case '\r': result += "\\r"; break;
-                case '\t': result += "\\t"; break;
-                default: result += c; break;
-            }
-        }
-        return result;
-    };
 
     if(g_Config.m_ClChatDiscordWebHookUrl[0] != '\0')
     {
-        char aJson[1024];
-        std::string escapedText = escapeJson(pText);
-        std::string escapedSender = escapeJson(senderName);
-        
+        char aLine[1024];
+        bool Mention = false;
+
         if(IsWhisperSend)
         {
-            std::string escapedTarget = escapeJson(targetName.empty() ? "?" : targetName);
-            str_format(aJson, sizeof(aJson), "{\"content\":\"`%s` (whisper -> %s) `%s`: %s\"}", dateTime.c_str(), escapedTarget.c_str(), escapedSender.c_str(), escapedText.c_str());
+            str_format(aLine, sizeof(aLine), "`%s` (whisper -> %s) `%s`: %s", dateTime.c_str(), targetName.empty() ? "?" : targetName.c_str(), senderName.c_str(), pText);
         }
         else if(IsWhisperRecv)
         {
-            str_format(aJson, sizeof(aJson), "{\"content\":\"||<@776421522188664843>|| (whisper) `%s` `%s`: %s\"}", dateTime.c_str(), escapedSender.c_str(), escapedText.c_str());
+            str_format(aLine, sizeof(aLine), "(whisper) `%s` `%s`: %s", dateTime.c_str(), senderName.c_str(), pText);
+            Mention = true;
         }
         else
         {
@@ -162,33 +142,12 @@ void CAutoreply::OnMessage(int Msg, void *pRawMsg)
                 if(pMsg->m_ClientId < 0)
                     return;
 
-                if(senderName == pMyName)
-                {
-                    str_format(aJson, sizeof(aJson), "{\"content\":\"`%s` `%s`: %s\"}", dateTime.c_str(), escapedSender.c_str(), escapedText.c_str());
-                }
-                else
-                {
-                    str_format(aJson, sizeof(aJson), "{\"content\":\"||<@776421522188664843>|| `%s` `%s`: %s\"}", dateTime.c_str(), escapedSender.c_str(), escapedText.c_str());
-                }
-            }
-            else
-            {
-                str_format(aJson, sizeof(aJson), "{\"content\":\"`%s` `%s`: %s\"}", dateTime.c_str(), escapedSender.c_str(), escapedText.c_str());
+                Mention = senderName != pMyName;
             }
+            str_format(aLine, sizeof(aLine), "`%s` `%s`: %s", dateTime.c_str(), senderName.c_str(), pText);
         }
 
-        auto pUniqueReq = HttpPostJson(
-            g_Config.m_ClChatDiscordWebHookUrl,
-            aJson
-        );
-
-        std::shared_ptr<IHttpRequest> pReq(
-            pUniqueReq.release(),
-            [](IHttpRequest *p){ delete static_cast <CHttpRequest*>(p); }
-        );
-
-        if (auto pHttp = Kernel()->RequestInterface<IHttp>())
-            pHttp->Run(pReq);
+        GameClient()->m_Webhook.Queue(g_Config.m_ClChatDiscordWebHookUrl, aLine, Mention);
     }
 
     if (g_Config.m_ClTagReply == 1)
@@ -205,31 +164,20 @@ void CAutoreply::OnMessage(int Msg, void *pRawMsg)
 
             if(g_Config.m_ClTagDiscordWebHookUrl[0] != '\0')
             {
-                char bJson[1024];
+                char aLine[1024];
                 if (pMsg->m_Team == TEAM_WHISPER_RECV)
                 {
-                    str_format(bJson, sizeof(bJson), "{\"content\":\"||<@776421522188664843>|| (whisper) `%s` `%s`: %s\"}", dateTime.c_str(), senderName.c_str(), pText);
+                    str_format(aLine, sizeof(aLine), "(whisper) `%s` `%s`: %s", dateTime.c_str(), senderName.c_str(), pText);
                 }
                 else
                 {
                     if(senderName == "언더")
                         return;
 
-                    str_format(bJson, sizeof(bJson), "{\"content\":\"||<@776421522188664843>|| `%s` `%s`: %s\"}", dateTime.c_str(), senderName.c_str(), pText);
+                    str_format(aLine, sizeof(aLine), "`%s` `%s`: %s", dateTime.c_str(), senderName.c_str(), pText);
                 }
 
-                auto pUniqueReq = HttpPostJson(
-                    g_Config.m_ClTagDiscordWebHookUrl,
-                    bJson
-                );
-
-                std::shared_ptr<IHttpRequest> pReq(
-                    pUniqueReq.release(),
-                    [](IHttpRequest *p){ delete static_cast <CHttpRequest*>(p); }
-                );
-
-                if (auto pHttp = Kernel()->RequestInterface<IHttp>())
-                    pHttp->Run(pReq);
+                GameClient()->m_Webhook.Queue(g_Config.m_ClTagDiscordWebHookUrl, aLine, true);
             }
 
             char autoMessage[128];
@@ -0,0 +1,205 @@
+#include "translation_cache.h"
+
+#include <base/log.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/config.h>
+#include <engine/storage.h>
+
+#include <vector>
+
+static const unsigned char TRANSLATION_CACHE_MAGIC[4] = {'U', 'C', 'T', 'C'};
+static constexpr unsigned TRANSLATION_CACHE_VERSION = 1;
+static constexpr char KEY_SEPARATOR = '\x1f';
+
+static char AsciiLower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+void CTranslationCache::OnInit()
+{
+	Load();
+}
+
+void CTranslationCache::OnShutdown()
+{
+	if(m_Dirty)
+		Save();
+}
+
+void CTranslationCache::BuildKey(std::string &Key, const char *pBackend, const char *pTarget, const char *pText)
+{
+	Key.clear();
+	for(const char *p = pBackend; *p; ++p)
+		Key.push_back(AsciiLower(*p));
+	Key.push_back(KEY_SEPARATOR);
+	for(const char *p = pTarget; *p; ++p)
+		Key.push_back(AsciiLower(*p));
+	Key.push_back(KEY_SEPARATOR);
+
+	// case fold and collapse whitespace so "GG", "gg " and "gg" share an entry
+	const char *pStr = str_utf8_skip_whitespaces(pText);
+	bool PendingSpace = false;
+	while(*pStr)
+	{
+		const int Code = str_utf8_decode(&pStr);
+		if(Code <= 0)
+			continue;
+		if(str_utf8_isspace(Code))
+		{
+			PendingSpace = true;
+			continue;
+		}
+		if(PendingSpace)
+		{
+			Key.push_back(' ');
+			PendingSpace = false;
+		}
+		char aEncoded[4];
+		const int Size = str_utf8_encode(aEncoded, str_utf8_tolower_codepoint(Code));
+		Key.append(aEncoded, Size);
+	}
+}
+
+const CTranslationCache::CEntry *CTranslationCache::Find(const char *pBackend, const char *pTarget, const char *pText)
+{
+	if(!g_Config.m_UcTranslateCache)
+		return nullptr;
+
+	std::string Key;
+	BuildKey(Key, pBackend, pTarget, pText);
+	auto It = m_Index.find(Key);
+	if(It == m_Index.end())
+		return nullptr;
+
+	m_Entries.splice(m_Entries.begin(), m_Entries, It->second);
+	return &*It->second;
+}
+
+void CTranslationCache::Add(const char *pBackend, const char *pTarget, const char *pText, const char *pTranslated, const char *pLanguage)
+{
+	if(!g_Config.m_UcTranslateCache)
+		return;
+
+	CEntry Entry;
+	BuildKey(Entry.m_Key, pBackend, pTarget, pText);
+	Entry.m_Text = pTranslated;
+	Entry.m_Language = pLanguage ? pLanguage : "";
+	Insert(std::move(Entry));
+	Trim(g_Config.m_UcTranslateCacheSize);
+	m_Dirty = true;
+}
+
+void CTranslationCache::Insert(CEntry &&Entry)
+{
+	auto It = m_Index.find(Entry.m_Key);
+	if(It != m_Index.end())
+	{
+		It->second->m_Text = std::move(Entry.m_Text);
+		It->second->m_Language = std::move(Entry.m_Language);
+		m_Entries.splice(m_Entries.begin(), m_Entries, It->second);
+		return;
+	}
+	m_Entries.emplace_front(std::move(Entry));
+	m_Index.emplace(m_Entries.front().m_Key, m_Entries.begin());
+}
+
+void CTranslationCache::Trim(size_t MaxEntries)
+{
+	while(m_Entries.size() > MaxEntries)
+	{
+		m_Index.erase(m_Entries.back().m_Key);
+		m_Entries.pop_back();
+	}
+}
+
+// File layout (big endian):
+//   "UCTC" u32 version u32 count
+//   count * (u16 key length, key, u16 text length, text, u8 language length, language)
+// Entries are stored most recently used first.
+void CTranslationCache::Load()
+{
+	void *pData;
+	unsigned DataSize;
+	if(!Storage()->ReadFile(Filename(), IStorage::TYPE_SAVE, &pData, &DataSize))
+		return;
+
+	const unsigned char *pBuf = static_cast<const unsigned char *>(pData);
+	const unsigned char *pEnd = pBuf + DataSize;
+	const auto ReadString = [&](std::string &Out, size_t LengthBytes) -> bool {
+		if((size_t)(pEnd - pBuf) < LengthBytes)
+			return false;
+		size_t Length = 0;
+		for(size_t i = 0; i < LengthBytes; i++)
+			Length = (Length << 8) | *pBuf++;
+		if((size_t)(pEnd - pBuf) < Length)
+			return false;
+		Out.assign(reinterpret_cast<const char *>(pBuf), Length);
+		pBuf += Length;
+		return true;
+	};
+
+	if(DataSize < 12 || mem_comp(pBuf, TRANSLATION_CACHE_MAGIC, sizeof(TRANSLATION_CACHE_MAGIC)) != 0 || bytes_be_to_uint(pBuf + 4) != TRANSLATION_CACHE_VERSION)
+	{
+		log_error("translate", "ignoring invalid translation cache '%s'", Filename());
+		free(pData);
+		return;
+	}
+	const unsigned Count = bytes_be_to_uint(pBuf + 8);
+	pBuf += 12;
+
+	for(unsigned i = 0; i < Count; i++)
+	{
+		CEntry Entry;
+		if(!ReadString(Entry.m_Key, 2) || !ReadString(Entry.m_Text, 2) || !ReadString(Entry.m_Language, 1))
+		{
+			log_error("translate", "translation cache '%s' is truncated", Filename());
+			break;
+		}
+		if(m_Index.count(Entry.m_Key))
+			continue;
+		m_Entries.emplace_back(std::move(Entry));
+		m_Index.emplace(m_Entries.back().m_Key, std::prev(m_Entries.end()));
+	}
+	free(pData);
+
+	Trim(g_Config.m_UcTranslateCacheSize);
+}
+
+void CTranslationCache::Save()
+{
+	std::vector<unsigned char> vBuf;
+	const auto WriteUint = [&](unsigned Value, size_t Bytes) {
+		for(size_t i = Bytes; i-- > 0;)
+			vBuf.push_back((Value >> (i * 8)) & 0xff);
+	};
+	const auto WriteString = [&](const std::string &Str, size_t LengthBytes) {
+		const size_t MaxLength = (size_t(1) << (LengthBytes * 8)) - 1;
+		const size_t Length = minimum(Str.size(), MaxLength);
+		WriteUint(Length, LengthBytes);
+		vBuf.insert(vBuf.end(), Str.begin(), Str.begin() + Length);
+	};
+
+	vBuf.insert(vBuf.end(), std::begin(TRANSLATION_CACHE_MAGIC), std::end(TRANSLATION_CACHE_MAGIC));
+	WriteUint(TRANSLATION_CACHE_VERSION, 4);
+	WriteUint(m_Entries.size(), 4);
+	for(const CEntry &Entry : m_Entries)
+	{
+		WriteString(Entry.m_Key, 2);
+		WriteString(Entry.m_Text, 2);
+		WriteString(Entry.m_Language, 1);
+	}
+
+	IOHANDLE File = Storage()->OpenFile(Filename(), IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		log_error("translate", "failed to open translation cache '%s' for writing", Filename());
+		return;
+	}
+	if(io_write(File, vBuf.data(), vBuf.size()) != vBuf.size())
+		log_error("translate", "failed to write translation cache '%s'", Filename());
+	io_close(File);
+	m_Dirty = false;
+}
@@ -0,0 +1,46 @@
+#ifndef GAME_CLIENT_COMPONENTS_UNDER_TRANSLATION_CACHE_H
+#define GAME_CLIENT_COMPONENTS_UNDER_TRANSLATION_CACHE_H
+
+#include <game/client/component.h>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Translation results shared by CTranslate and CUcTranslator, keyed by
+// (backend, target language, normalized text). Recently used entries are
+// kept in memory and persisted to a compact binary file on shutdown.
+class CTranslationCache : public CComponent
+{
+public:
+	class CEntry
+	{
+	public:
+		std::string m_Key;
+		std::string m_Text;
+		std::string m_Language;
+	};
+
+	int Sizeof() const override { return sizeof(*this); }
+	void OnInit() override;
+	void OnShutdown() override;
+
+	// Returns nullptr on a miss, the entry is marked as most recently used on a hit
+	const CEntry *Find(const char *pBackend, const char *pTarget, const char *pText);
+	void Add(const char *pBackend, const char *pTarget, const char *pText, const char *pTranslated, const char *pLanguage = "");
+
+	static void BuildKey(std::string &Key, const char *pBackend, const char *pTarget, const char *pText);
+
+private:
+	std::list<CEntry> m_Entries; // most recently used first
+	std::unordered_map<std::string, std::list<CEntry>::iterator> m_Index;
+	bool m_Dirty = false;
+
+	void Insert(CEntry &&Entry);
+	void Trim(size_t MaxEntries);
+	const char *Filename() const { return "under_translation_cache.dat"; }
+	void Load();
+	void Save();
+};
+
+#endif // GAME_CLIENT_COMPONENTS_UNDER_TRANSLATION_CACHE_H
@@ -4,14 +4,16 @@
 
 #include <engine/shared/config.h>
 #include <engine/shared/http.h>
-#include <cstring>
+#include <engine/shared/json.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
-#include <thread>
 
 #include <game/client/components/chat.h>
+#include <game/client/gameclient.h>
 
 bool CUcTranslator::IsEnabled() const
 {
@@ -60,64 +62,243 @@ bool CUcTranslator::TranslateAsyncWithPrefix(int Team, const char *pText, CChat
 
 void CUcTranslator::OnRender()
 {
-	std::deque<CResult> Results;
+	if(m_vRunningRequests.empty() && m_vQueuedJobs.empty())
+		return;
+
+	UpdateRunningRequests();
+	StartQueuedJobs();
+}
+
+void CUcTranslator::OnShutdown()
+{
+	for(auto &Request : m_vRunningRequests)
+		Request.m_pHttpRequest->Abort();
+	m_vRunningRequests.clear();
+	m_vQueuedJobs.clear();
+	std::fill(std::begin(m_aNumRunning), std::end(m_aNumRunning), 0);
+}
+
+bool CUcTranslator::TranslateAsyncImpl(const char *pText, const char *pTarget, CChat *pChat, int Team, std::string PrefixArg)
+{
+	if(!pChat || !pText || !*pText)
+		return false;
+
+	const EBackend Backend = SelectBackend();
+	std::string Input(pText);
+	std::string Target = pTarget && *pTarget ? pTarget : "";
+
+	CWaiter Waiter{Team, pChat, std::move(PrefixArg)};
+
+	char aCacheTarget[16];
+	BuildTargetCode(aCacheTarget, sizeof(aCacheTarget), Target.empty() ? nullptr : Target.c_str());
+	if(const CTranslationCache::CEntry *pCached = GameClient()->m_TranslationCache.Find(BackendName(Backend), aCacheTarget, Input.c_str()))
 	{
-		std::lock_guard<std::mutex> Lock(m_ResultLock);
-		if(m_vResults.empty())
-			return;
-		Results.swap(m_vResults);
+		CJob Job;
+		Job.m_vWaiters.emplace_back(std::move(Waiter));
+		FinishJob(Job, pCached->m_Text.c_str());
+		return true;
 	}
 
-	for(auto &Result : Results)
+	if(CJob *pJob = FindJob(Backend, Input, Target))
 	{
-		if(Result.m_pChat)
-		{
-			Result.m_pChat->SendChatTranslated(Result.m_Team, Result.m_Text.c_str());
-		}
+		pJob->m_vWaiters.emplace_back(std::move(Waiter));
+		return true;
 	}
+
+	if((int)m_vQueuedJobs.size() >= MAX_QUEUED_JOBS)
+		return false;
+
+	CJob Job;
+	Job.m_Backend = Backend;
+	Job.m_Input = std::move(Input);
+	Job.m_Target = std::move(Target);
+	Job.m_vWaiters.emplace_back(std::move(Waiter));
+	Job.m_QueuedTime = time_get();
+	m_vQueuedJobs.emplace_back(std::move(Job));
+
+	// start right away if a slot is free, otherwise the next render picks it up
+	StartQueuedJobs();
+	return true;
 }
 
-bool CUcTranslator::TranslateAsyncImpl(const char *pText, const char *pTarget, CChat *pChat, int Team, std::string PrefixArg)
+CUcTranslator::EBackend CUcTranslator::SelectBackend() const
 {
-	if(!pChat || !pText || !*pText)
+	if(str_comp_nocase(g_Config.m_UcTranslateBackend, "deepl") == 0)
+		return BACKEND_DEEPL;
+
+	if(str_comp_nocase(g_Config.m_UcTranslateBackend, "google") == 0)
+		return BACKEND_GOOGLE;
+
+	if(g_Config.m_UcTranslateApi[0])
+		return IsDeepLEndpoint(g_Config.m_UcTranslateApi) ? BACKEND_DEEPL : BACKEND_CUSTOM;
+	return BACKEND_GOOGLE;
+}
+
+const char *CUcTranslator::BackendName(EBackend Backend)
+{
+	switch(Backend)
+	{
+	case BACKEND_DEEPL: return "deepl";
+	case BACKEND_CUSTOM: return "custom";
+	default: return "google";
+	}
+}
+
+CUcTranslator::CJob *CUcTranslator::FindJob(EBackend Backend, const std::string &Input, const std::string &Target)
+{
+	const auto Matches = [&](const CJob &Job) {
+		return Job.m_Backend == Backend && Job.m_Target == Target && Job.m_Input == Input;
+	};
+	for(auto &Request : m_vRunningRequests)
+		for(auto &Job : Request.m_vJobs)
+			if(Matches(Job))
+				return &Job;
+	for(auto &Job : m_vQueuedJobs)
+		if(Matches(Job))
+			return &Job;
+	return nullptr;
+}
+
+bool CUcTranslator::StartRequest(CRequest &Request)
+{
+	IHttp *pHttp = Http();
+	if(!pHttp)
 		return false;
 
-	std::string InputStr(pText);
-	std::string TargetStr = pTarget && *pTarget ? pTarget : "";
-	std::string PrefixStr = std::move(PrefixArg);
-	std::thread([this, Team, Input = std::move(InputStr), pChat, TargetString = std::move(TargetStr), Prefix = std::move(PrefixStr)]() {
-		char aBuffer[TRANSLATE_MAX_LENGTH];
-		const char *pTargetOverride = TargetString.empty() ? nullptr : TargetString.c_str();
-		bool Success = TranslateInternal(Input.c_str(), aBuffer, sizeof(aBuffer), pTargetOverride);
-		CResult Result;
-		Result.m_Team = Team;
-		Result.m_pChat = pChat;
-		if(Success)
-			Result.m_Text = Prefix.empty() ? std::string(aBuffer) : Prefix + aBuffer;
+	std::unique_ptr<CHttpRequest> pHttpRequest = CreateRequest(Request.m_Backend, Request.m_vJobs);
+	if(!pHttpRequest)
+		return false;
+
+	pHttpRequest->Timeout(CTimeout{4000, 10000, 500, 5});
+	pHttpRequest->LogProgress(HTTPLOG::FAILURE);
+	Request.m_pHttpRequest = std::move(pHttpRequest);
+	pHttp->Run(Request.m_pHttpRequest);
+	return true;
+}
+
+void CUcTranslator::FinishJob(CJob &Job, const char *pTranslated)
+{
+	const char *pText = pTranslated ? pTranslated : Job.m_Input.c_str();
+	for(auto &Waiter : Job.m_vWaiters)
+	{
+		if(!Waiter.m_pChat)
+			continue;
+		if(Waiter.m_Prefix.empty())
+			Waiter.m_pChat->SendChatTranslated(Waiter.m_Team, pText);
 		else
-			Result.m_Text = Prefix.empty() ? Input : Prefix + Input;
+			Waiter.m_pChat->SendChatTranslated(Waiter.m_Team, (Waiter.m_Prefix + pText).c_str());
+	}
+}
+
+void CUcTranslator::UpdateRunningRequests()
+{
+	for(auto It = m_vRunningRequests.begin(); It != m_vRunningRequests.end();)
+	{
+		const EHttpState State = It->m_pHttpRequest->State();
+		if(State == EHttpState::QUEUED || State == EHttpState::RUNNING)
 		{
-			std::lock_guard<std::mutex> Lock(m_ResultLock);
-			m_vResults.emplace_back(std::move(Result));
+			++It;
+			continue;
 		}
-	}).detach();
-	return true;
+
+		std::vector<std::string> vTranslated;
+		if(State == EHttpState::DONE && It->m_pHttpRequest->StatusCode() < 400)
+		{
+			if(It->m_Backend == BACKEND_DEEPL)
+			{
+				if(!ParseDeepLResponse(*It->m_pHttpRequest, vTranslated) || vTranslated.size() != It->m_vJobs.size())
+					vTranslated.clear();
+			}
+			else
+			{
+				unsigned char *pResult = nullptr;
+				size_t ResultLength = 0;
+				char aBuffer[TRANSLATE_MAX_LENGTH];
+				It->m_pHttpRequest->Result(&pResult, &ResultLength);
+				if(pResult && ResultLength > 0 && ParseResponse(pResult, ResultLength, aBuffer, sizeof(aBuffer)))
+					vTranslated.emplace_back(aBuffer);
+			}
+		}
+
+		// send after erasing, sending may queue further translations
+		CRequest Request = std::move(*It);
+		It = m_vRunningRequests.erase(It);
+		m_aNumRunning[Request.m_Backend]--;
+		const bool Success = !vTranslated.empty();
+		for(size_t i = 0; i < Request.m_vJobs.size(); i++)
+		{
+			CJob &Job = Request.m_vJobs[i];
+			if(Success)
+			{
+				char aCacheTarget[16];
+				BuildTargetCode(aCacheTarget, sizeof(aCacheTarget), Job.m_Target.empty() ? nullptr : Job.m_Target.c_str());
+				GameClient()->m_TranslationCache.Add(BackendName(Job.m_Backend), aCacheTarget, Job.m_Input.c_str(), vTranslated[i].c_str());
+			}
+			FinishJob(Job, Success ? vTranslated[i].c_str() : nullptr);
+		}
+	}
 }
 
-bool CUcTranslator::TranslateInternal(const char *pText, char *pOut, int OutSize, const char *pTarget)
+void CUcTranslator::StartQueuedJobs()
 {
-	if(str_comp_nocase(g_Config.m_UcTranslateBackend, "deepl") == 0)
-		return TranslateUsingDeepL(pText, pOut, OutSize, pTarget);
+	const int64_t Now = time_get();
+	const int64_t BatchWindow = (int64_t)g_Config.m_UcTranslateBatchWindow * time_freq() / 1000;
+	for(size_t i = 0; i < m_vQueuedJobs.size();)
+	{
+		const EBackend Backend = m_vQueuedJobs[i].m_Backend;
+		const bool Batch = Backend == BACKEND_DEEPL;
+		if(m_aNumRunning[Backend] >= MAX_IN_FLIGHT[Backend] || (Batch && Now - m_vQueuedJobs[i].m_QueuedTime < BatchWindow))
+		{
+			++i;
+			continue;
+		}
 
-	if(str_comp_nocase(g_Config.m_UcTranslateBackend, "google") == 0)
-		return TranslateUsingDefault(pText, pOut, OutSize, pTarget);
+		CRequest Request;
+		Request.m_Backend = Backend;
+		Request.m_vJobs.emplace_back(std::move(m_vQueuedJobs[i]));
+		m_vQueuedJobs.erase(m_vQueuedJobs.begin() + i);
 
-	if(g_Config.m_UcTranslateApi[0])
-		return TranslateUsingCustom(pText, pOut, OutSize, pTarget);
-	return TranslateUsingDefault(pText, pOut, OutSize, pTarget);
+		// DeepL takes several text fields per request, send every
+		// queued job with the same target language along
+		if(Batch)
+		{
+			const std::string Target = Request.m_vJobs.front().m_Target;
+			for(size_t j = i; j < m_vQueuedJobs.size() && (int)Request.m_vJobs.size() < MAX_BATCH_SIZE;)
+			{
+				if(m_vQueuedJobs[j].m_Backend == Backend && m_vQueuedJobs[j].m_Target == Target)
+				{
+					Request.m_vJobs.emplace_back(std::move(m_vQueuedJobs[j]));
+					m_vQueuedJobs.erase(m_vQueuedJobs.begin() + j);
+				}
+				else
+					++j;
+			}
+		}
+
+		if(!StartRequest(Request))
+		{
+			// no request could be built (e.g. missing key), send the original text
+			for(auto &Job : Request.m_vJobs)
+				FinishJob(Job, nullptr);
+			continue;
+		}
+		m_aNumRunning[Backend]++;
+		m_vRunningRequests.emplace_back(std::move(Request));
+	}
 }
 
-bool CUcTranslator::TranslateUsingDefault(const char *pText, char *pOut, int OutSize, const char *pTarget)
+std::unique_ptr<CHttpRequest> CUcTranslator::CreateRequest(EBackend Backend, const std::vector<CJob> &vJobs) const
+{
+	const char *pTarget = vJobs.front().m_Target.empty() ? nullptr : vJobs.front().m_Target.c_str();
+	switch(Backend)
+	{
+	case BACKEND_DEEPL: return CreateDeepLRequest(vJobs, pTarget);
+	case BACKEND_CUSTOM: return CreateCustomRequest(vJobs.front().m_Input.c_str(), pTarget);
+	default: return CreateDefaultRequest(vJobs.front().m_Input.c_str(), pTarget);
+	}
+}
+
+std::unique_ptr<CHttpRequest> CUcTranslator::CreateDefaultRequest(const char *pText, const char *pTarget) const
 {
 	char aEscaped[2048];
 	EscapeUrl(aEscaped, sizeof(aEscaped), pText);
@@ -127,14 +308,11 @@ bool CUcTranslator::TranslateUsingDefault(const char *pText, char *pOut, int Out
 
 	char aUrl[4096];
 	str_format(aUrl, sizeof(aUrl), "https://translate.googleapis.com/translate_a/single?client=gtx&sl=auto&tl=%s&dt=t&q=%s", aTarget, aEscaped);
-	return PerformRequest(aUrl, pOut, OutSize);
+	return HttpGet(aUrl);
 }
 
-bool CUcTranslator::TranslateUsingCustom(const char *pText, char *pOut, int OutSize, const char *pTarget)
+std::unique_ptr<CHttpRequest> CUcTranslator::CreateCustomRequest(const char *pText, const char *pTarget) const
 {
-	if(IsDeepLEndpoint(g_Config.m_UcTranslateApi))
-		return TranslateUsingDeepL(pText, pOut, OutSize, pTarget);
-
 	char aEscaped[2048];
 	EscapeUrl(aEscaped, sizeof(aEscaped), pText);
 
@@ -150,37 +328,7 @@ bool CUcTranslator::TranslateUsingCustom(const char *pText, char *pOut, int OutS
 	else
 		str_format(aUrl, sizeof(aUrl), "%s%sq=%s&target=%s", pBase, pSep, aEscaped, aTarget);
 
-	return PerformRequest(aUrl, pOut, OutSize);
-}
-
-bool CUcTranslator::PerformRequest(const char *pUrl, char *pOut, int OutSize)
-{
-	return PerformRequest(HttpGet(pUrl), pOut, OutSize);
-}
-
-bool CUcTranslator::PerformRequest(std::unique_ptr<CHttpRequest> pRequestUnique, char *pOut, int OutSize)
-{
-	IHttp *pHttp = this->Http();
-	if(!pHttp)
-		return false;
-
-	pRequestUnique->Timeout(CTimeout{4000, 10000, 500, 5});
-	std::shared_ptr<CHttpRequest> pRequest(
-		pRequestUnique.release(),
-		[](CHttpRequest *p) { delete p; });
-	pHttp->Run(std::static_pointer_cast<IHttpRequest>(pRequest));
-	pRequest->Wait();
-
-	if(pRequest->State() != EHttpState::DONE || pRequest->StatusCode() >= 400)
-		return false;
-
-	unsigned char *pResult = nullptr;
-	size_t ResultLength = 0;
-	pRequest->Result(&pResult, &ResultLength);
-	if(!pResult || ResultLength == 0)
-		return false;
-
-	return this->ParseResponse(pResult, ResultLength, pOut, OutSize);
+	return HttpGet(aUrl);
 }
 
 bool CUcTranslator::ParseResponse(const unsigned char *pData, size_t Length, char *pOut, int OutSize) const
@@ -292,30 +440,59 @@ bool CUcTranslator::ParseResponse(const unsigned char *pData, size_t Length, cha
 	return true;
 }
 
-bool CUcTranslator::TranslateUsingDeepL(const char *pText, char *pOut, int OutSize, const char *pTarget)
+std::unique_ptr<CHttpRequest> CUcTranslator::CreateDeepLRequest(const std::vector<CJob> &vJobs, const char *pTarget) const
 {
 	if(!g_Config.m_UcTranslateKey[0])
-		return false;
-
-	char aEscaped[2048];
-	EscapeUrl(aEscaped, sizeof(aEscaped), pText);
+		return nullptr;
 
 	char aTarget[16];
 	BuildTargetCode(aTarget, sizeof(aTarget), pTarget, false);
 
-	char aBody[4096];
-	str_format(aBody, sizeof(aBody), "text=%s&target_lang=%s", aEscaped, aTarget);
-	const size_t BodyLen = str_length(aBody);
+	std::string Body;
+	char aEscaped[2048];
+	for(const CJob &Job : vJobs)
+	{
+		EscapeUrl(aEscaped, sizeof(aEscaped), Job.m_Input.c_str());
+		Body.append("text=");
+		Body.append(aEscaped);
+		Body.push_back('&');
+	}
+	Body.append("target_lang=");
+	Body.append(aTarget);
 
 	const char *pEndpoint = g_Config.m_UcTranslateApi[0] ? g_Config.m_UcTranslateApi : "https://api-free.deepl.com/v2/translate";
 
-	auto pRequest = HttpPost(pEndpoint, reinterpret_cast<const unsigned char *>(aBody), BodyLen);
+	auto pRequest = HttpPost(pEndpoint, reinterpret_cast<const unsigned char *>(Body.c_str()), Body.size());
 	pRequest->HeaderString("Content-Type", "application/x-www-form-urlencoded");
 	char aAuth[512];
 	str_format(aAuth, sizeof(aAuth), "DeepL-Auth-Key %s", g_Config.m_UcTranslateKey);
 	pRequest->HeaderString("Authorization", aAuth);
 
-	return PerformRequest(std::move(pRequest), pOut, OutSize);
+	return pRequest;
+}
+
+bool CUcTranslator::ParseDeepLResponse(const CHttpRequest &Request, std::vector<std::string> &vOut) const
+{
+	json_value *pJson = Request.ResultJson();
+	if(!pJson)
+		return false;
+
+	// translations are returned in the order the text fields were sent
+	const json_value *pTranslations = json_object_get(pJson, "translations");
+	const int Length = json_array_length(pTranslations);
+	for(int i = 0; i < Length; i++)
+	{
+		const json_value *pText = json_object_get(json_array_get(pTranslations, i), "text");
+		const char *pStr = json_string_get(pText);
+		if(!pStr)
+		{
+			vOut.clear();
+			break;
+		}
+		vOut.emplace_back(pStr);
+	}
+	json_value_free(pJson);
+	return !vOut.empty();
 }
 
 bool CUcTranslator::IsDeepLEndpoint(const char *pUrl) const
@@ -6,8 +6,8 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
-#include <mutex>
 #include <string>
+#include <vector>
 
 class CChat;
 class CHttpRequest;
@@ -19,26 +19,68 @@ public:
 	bool TranslateAsync(int Team, const char *pText, CChat *pChat);
 	bool TranslateAsyncWithPrefix(int Team, const char *pText, CChat *pChat, std::string Prefix);
 	void OnRender() override;
+	void OnShutdown() override;
 	int Sizeof() const override { return sizeof(*this); }
 
 private:
-	struct CResult
+	enum EBackend
+	{
+		BACKEND_GOOGLE = 0,
+		BACKEND_CUSTOM,
+		BACKEND_DEEPL,
+		NUM_BACKENDS,
+	};
+
+	// Upper bound of jobs waiting for a free request slot, further
+	// messages are sent untranslated instead of piling up
+	static constexpr int MAX_QUEUED_JOBS = 32;
+	static constexpr int MAX_IN_FLIGHT[NUM_BACKENDS] = {4, 4, 2};
+	static constexpr int MAX_BATCH_SIZE = 25;
+
+	struct CWaiter
 	{
 		int m_Team;
-		std::string m_Text;
 		CChat *m_pChat;
+		std::string m_Prefix;
 	};
 
-	std::mutex m_ResultLock;
-	std::deque<CResult> m_vResults;
+	// One translation of a text to a target language, shared by every
+	// message with the same input (coalesced) until the request finishes
+	struct CJob
+	{
+		EBackend m_Backend;
+		std::string m_Input;
+		std::string m_Target;
+		std::vector<CWaiter> m_vWaiters;
+		int64_t m_QueuedTime = 0;
+	};
+
+	// A running http request, DeepL requests carry several jobs at once
+	struct CRequest
+	{
+		EBackend m_Backend;
+		std::vector<CJob> m_vJobs;
+		std::shared_ptr<CHttpRequest> m_pHttpRequest;
+	};
+
+	std::deque<CJob> m_vQueuedJobs;
+	std::vector<CRequest> m_vRunningRequests;
+	int m_aNumRunning[NUM_BACKENDS] = {};
 
 	bool TranslateAsyncImpl(const char *pText, const char *pTarget, CChat *pChat, int Team, std::string PrefixArg);
-	bool TranslateInternal(const char *pText, char *pOut, int OutSize, const char *pTarget);
-	bool TranslateUsingDefault(const char *pText, char *pOut, int OutSize, const char *pTarget);
-	bool TranslateUsingCustom(const char *pText, char *pOut, int OutSize, const char *pTarget);
-	bool TranslateUsingDeepL(const char *pText, char *pOut, int OutSize, const char *pTarget);
-	bool PerformRequest(const char *pUrl, char *pOut, int OutSize);
-	bool PerformRequest(std::unique_ptr<CHttpRequest> pRequestUnique, char *pOut, int OutSize);
+	EBackend SelectBackend() const;
+	static const char *BackendName(EBackend Backend);
+	CJob *FindJob(EBackend Backend, const std::string &Input, const std::string &Target);
+	bool StartRequest(CRequest &Request);
+	void FinishJob(CJob &Job, const char *pTranslated);
+	void UpdateRunningRequests();
+	void StartQueuedJobs();
+
+	std::unique_ptr<CHttpRequest> CreateRequest(EBackend Backend, const std::vector<CJob> &vJobs) const;
+	std::unique_ptr<CHttpRequest> CreateDefaultRequest(const char *pText, const char *pTarget) const;
+	std::unique_ptr<CHttpRequest> CreateCustomRequest(const char *pText, const char *pTarget) const;
+	std::unique_ptr<CHttpRequest> CreateDeepLRequest(const std::vector<CJob> &vJobs, const char *pTarget) const;
+	bool ParseDeepLResponse(const CHttpRequest &Request, std::vector<std::string> &vOut) const;
 	bool ParseResponse(const unsigned char *pData, size_t Length, char *pOut, int OutSize) const;
 	void BuildTargetCode(char *pTarget, size_t TargetSize, const char *pPreferred, bool Lowercase = true) const;
 	bool IsDeepLEndpoint(const char *pUrl) const;
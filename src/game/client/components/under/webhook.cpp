@@ -0,0 +1,249 @@
+#include "webhook.h"
+
+#include <base/log.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/http.h>
+
+#include <algorithm>
+
+static const char *DISCORD_MENTION = "||<@776421522188664843>||";
+
+static void AppendJsonEscaped(std::string &Out, const char *pStr, size_t Length)
+{
+	for(size_t i = 0; i < Length; i++)
+	{
+		const unsigned char c = pStr[i];
+		switch(c)
+		{
+		case '"': Out += "\\\""; break;
+		case '\\': Out += "\\\\"; break;
+		case '\n': Out += "\\n"; break;
+		case '\r': Out += "\\r"; break;
+		case '\t': Out += "\\t"; break;
+		default:
+			if(c < 0x20)
+			{
+				char aBuf[8];
+				str_format(aBuf, sizeof(aBuf), "\\u%04x", c);
+				Out += aBuf;
+			}
+			else
+				Out.push_back(c);
+			break;
+		}
+	}
+}
+
+void CWebhook::Queue(const char *pUrl, const char *pLine, bool Mention)
+{
+	if(!pUrl || pUrl[0] == '\0' || !pLine)
+		return;
+
+	CTarget &Target = FindOrAddTarget(pUrl);
+	const size_t Length = str_length(pLine);
+	if(Target.m_Pending.size() + Length + 1 > (size_t)MAX_PENDING_LENGTH)
+	{
+		if(Target.m_NumDropped++ == 0)
+			log_warn("webhook", "too many pending lines, dropping chat log lines until the webhook catches up");
+		return;
+	}
+
+	if(Target.m_Pending.empty())
+		Target.m_FirstPendingTime = time_get();
+	const size_t Start = Target.m_Pending.size();
+	Target.m_Pending.append(pLine, Length);
+	std::replace(Target.m_Pending.begin() + Start, Target.m_Pending.end(), '\n', ' ');
+	Target.m_Pending.push_back('\n');
+	Target.m_PendingMention |= Mention;
+}
+
+CWebhook::CTarget &CWebhook::FindOrAddTarget(const char *pUrl)
+{
+	for(auto &Target : m_vTargets)
+		if(str_comp(Target.m_aUrl, pUrl) == 0)
+			return Target;
+
+	CTarget &Target = m_vTargets.emplace_back();
+	str_copy(Target.m_aUrl, pUrl);
+	Target.m_Pending.reserve(2 * MAX_MESSAGE_LENGTH);
+	Target.m_Body.reserve(2 * MAX_MESSAGE_LENGTH + 256);
+	Target.m_LastRefill = time_get();
+	return Target;
+}
+
+void CWebhook::OnRender()
+{
+	if(m_vTargets.empty())
+		return;
+
+	const int64_t Now = time_get();
+	const int64_t Freq = time_freq();
+	for(auto &Target : m_vTargets)
+	{
+		if(Target.m_pRequest)
+		{
+			UpdateRequest(Target, Now);
+			if(Target.m_pRequest)
+				continue;
+		}
+
+		Target.m_Tokens = minimum(BUCKET_SIZE, Target.m_Tokens + (Now - Target.m_LastRefill) / (float)Freq * BUCKET_REFILL_PER_SECOND);
+		Target.m_LastRefill = Now;
+		if(Now < Target.m_BlockedUntil || Target.m_Tokens < 1.0f)
+			continue;
+
+		if(!Target.m_Body.empty())
+		{
+			// retry the batch that failed last time
+			Send(Target);
+		}
+		else if(!Target.m_Pending.empty() &&
+			(Now - Target.m_FirstPendingTime >= (int64_t)(BATCH_DELAY_SECONDS * Freq) || Target.m_Pending.size() >= (size_t)MAX_MESSAGE_LENGTH))
+		{
+			BuildBody(Target);
+			Send(Target);
+		}
+	}
+}
+
+void CWebhook::OnShutdown()
+{
+	// hand the last batch to the http thread, it gets some time to finish on shutdown
+	for(auto &Target : m_vTargets)
+	{
+		if(Target.m_pRequest || (Target.m_Body.empty() && Target.m_Pending.empty()))
+			continue;
+		if(Target.m_Body.empty())
+			BuildBody(Target);
+		Send(Target);
+	}
+	m_vTargets.clear();
+}
+
+void CWebhook::UpdateRequest(CTarget &Target, int64_t Now)
+{
+	const EHttpState State = Target.m_pRequest->State();
+	if(State == EHttpState::QUEUED || State == EHttpState::RUNNING)
+		return;
+
+	const int64_t Freq = time_freq();
+	const int Status = State == EHttpState::DONE ? Target.m_pRequest->StatusCode() : 0;
+	std::optional<float> RetryAfter;
+	if(State == EHttpState::DONE)
+	{
+		const std::optional<int> Remaining = Target.m_pRequest->ResultRateLimitRemaining();
+		const std::optional<float> ResetAfter = Target.m_pRequest->ResultRateLimitResetAfter();
+		if(Remaining && ResetAfter)
+		{
+			Target.m_Tokens = minimum(Target.m_Tokens, (float)*Remaining);
+			if(*Remaining <= 0)
+				Target.m_BlockedUntil = maximum(Target.m_BlockedUntil, Now + (int64_t)(*ResetAfter * Freq));
+		}
+		RetryAfter = Target.m_pRequest->ResultRetryAfter();
+	}
+	Target.m_pRequest = nullptr;
+
+	if(Status >= 200 && Status < 300)
+	{
+		Target.m_Body.clear();
+		Target.m_Retries = 0;
+		return;
+	}
+
+	if(Status >= 400 && Status < 500 && Status != 429)
+	{
+		// the request itself is bad, retrying will not help
+		log_error("webhook", "discord webhook rejected chat log batch with http code %d", Status);
+		Target.m_Body.clear();
+		Target.m_Retries = 0;
+		return;
+	}
+
+	if(++Target.m_Retries > MAX_RETRIES)
+	{
+		log_error("webhook", "giving up on chat log batch after %d retries", MAX_RETRIES);
+		Target.m_Body.clear();
+		Target.m_Retries = 0;
+		return;
+	}
+
+	const float Delay = (Status == 429 && RetryAfter) ? *RetryAfter : (float)(1 << Target.m_Retries);
+	Target.m_BlockedUntil = maximum(Target.m_BlockedUntil, Now + (int64_t)(Delay * Freq));
+}
+
+void CWebhook::BuildBody(CTarget &Target)
+{
+	std::string &Body = Target.m_Body;
+	const std::string &Pending = Target.m_Pending;
+	Body.clear();
+	Body += "{";
+	if(Target.m_PendingMention)
+	{
+		Body += "\"content\":\"";
+		Body += DISCORD_MENTION;
+		Body += "\",";
+	}
+	Body += "\"embeds\":[";
+
+	// every line ends with a newline, split at line boundaries and leave
+	// whatever doesn't fit into the message for the next one
+	size_t Pos = 0;
+	int NumEmbeds = 0;
+	size_t Length = 0;
+	while(Pos < Pending.size() && NumEmbeds < MAX_EMBEDS && Length < (size_t)MAX_MESSAGE_LENGTH)
+	{
+		const size_t Limit = minimum((size_t)MAX_EMBED_LENGTH, MAX_MESSAGE_LENGTH - Length);
+		size_t End = Pos;
+		while(End < Pending.size())
+		{
+			const size_t LineEnd = Pending.find('\n', End) + 1;
+			if(LineEnd - Pos - 1 > Limit)
+				break;
+			End = LineEnd;
+		}
+
+		size_t DescriptionLength;
+		if(End != Pos)
+		{
+			DescriptionLength = End - Pos - 1;
+		}
+		else if(NumEmbeds == 0)
+		{
+			// a single overlong line, send its beginning now and the rest with the next message
+			End = Pos + Limit;
+			while(End > Pos && (Pending[End] & 0xc0) == 0x80)
+				End--;
+			DescriptionLength = End - Pos;
+		}
+		else
+		{
+			break;
+		}
+
+		if(NumEmbeds > 0)
+			Body += ",";
+		Body += "{\"description\":\"";
+		AppendJsonEscaped(Body, Pending.data() + Pos, DescriptionLength);
+		Body += "\"}";
+		Pos = End;
+		Length += DescriptionLength;
+		NumEmbeds++;
+	}
+	Body += "]}";
+
+	Target.m_Pending.erase(0, Pos);
+	Target.m_PendingMention = false;
+	Target.m_NumDropped = 0;
+}
+
+void CWebhook::Send(CTarget &Target)
+{
+	auto pRequest = HttpPostJson(Target.m_aUrl, Target.m_Body.c_str());
+	pRequest->FailOnErrorStatus(false);
+	pRequest->LogProgress(HTTPLOG::FAILURE);
+	Target.m_pRequest = std::move(pRequest);
+	Http()->Run(Target.m_pRequest);
+	Target.m_Tokens -= 1.0f;
+}
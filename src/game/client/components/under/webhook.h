@@ -0,0 +1,66 @@
+#ifndef GAME_CLIENT_COMPONENTS_UNDER_WEBHOOK_H
+#define GAME_CLIENT_COMPONENTS_UNDER_WEBHOOK_H
+
+#include <game/client/component.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CHttpRequest;
+
+// Collects chat log lines per Discord webhook and posts them as batched
+// embeds, limited by a token bucket and the rate limit headers Discord sends.
+class CWebhook : public CComponent
+{
+public:
+	int Sizeof() const override { return sizeof(*this); }
+	void OnRender() override;
+	void OnShutdown() override;
+
+	// `Mention` pings the configured user with the batch containing the line
+	void Queue(const char *pUrl, const char *pLine, bool Mention = false);
+
+private:
+	// Discord allows 4096 characters per embed description, 10 embeds per message
+	// and 6000 characters in all embeds of a message, longer messages are rejected.
+	// Counting bytes instead of characters stays below these limits.
+	static constexpr int MAX_EMBED_LENGTH = 4000;
+	static constexpr int MAX_EMBEDS = 10;
+	static constexpr int MAX_MESSAGE_LENGTH = 5900;
+	static constexpr int MAX_PENDING_LENGTH = 4 * MAX_EMBEDS * MAX_EMBED_LENGTH;
+	// Discord webhooks allow about 5 requests per 2 seconds
+	static constexpr float BUCKET_SIZE = 5.0f;
+	static constexpr float BUCKET_REFILL_PER_SECOND = 2.5f;
+	static constexpr float BATCH_DELAY_SECONDS = 1.0f;
+	static constexpr int MAX_RETRIES = 4;
+
+	class CTarget
+	{
+	public:
+		char m_aUrl[256];
+		// newline separated lines waiting for the next batch
+		std::string m_Pending;
+		bool m_PendingMention = false;
+		int m_NumDropped = 0;
+		int64_t m_FirstPendingTime = 0;
+
+		float m_Tokens = BUCKET_SIZE;
+		int64_t m_LastRefill = 0;
+		int64_t m_BlockedUntil = 0;
+
+		// the body of the request in flight, kept for retries
+		std::string m_Body;
+		int m_Retries = 0;
+		std::shared_ptr<CHttpRequest> m_pRequest;
+	};
+	std::vector<CTarget> m_vTargets;
+
+	CTarget &FindOrAddTarget(const char *pUrl);
+	void UpdateRequest(CTarget &Target, int64_t Now);
+	void BuildBody(CTarget &Target);
+	void Send(CTarget &Target);
+};
+
+#endif // GAME_CLIENT_COMPONENTS_UNDER_WEBHOOK_H
@@ -181,7 +181,9 @@ void CGameClient::OnConsoleInit()
 						  &m_AutoReply,
 						  &m_ChatSkin,
 						  &m_SkinSwitch,
-						  &m_UcTranslator
+						  &m_UcTranslator,
+						  &m_TranslationCache,
+						  &m_Webhook
 						});
 
 	// build the input stack
@@ -86,7 +86,9 @@
 #include "components/under/autoreply.h"
 #include "components/under/chatskin.h"
 #include "components/under/skinswitch.h"
+#include "components/under/translation_cache.h"
 #include "components/under/translator.h"
+#include "components/under/webhook.h"
 #include "components/voting.h"
 
 #include <vector>
@@ -234,6 +236,8 @@ public:
 	CChatskin m_ChatSkin;
 	CSkinswitch m_SkinSwitch;
 	CUcTranslator m_UcTranslator;
+	CTranslationCache m_TranslationCache;
+	CWebhook m_Webhook;
 
 private:
 	std::vector<class CComponent *> m_vpAll;
@@ -620,6 +620,43 @@ void CGameWorld::NetObjEnd()
 	}
 }
 
+void CGameWorld::RecycleEntities()
+{
+	for(int Type = 0; Type < NUM_ENTTYPES; Type++)
+	{
+		while(CEntity *pEnt = m_apFirstEntityTypes[Type])
+		{
+			RemoveEntity(pEnt);
+			// detached from the world, so destroying unused ones won't touch the new entities
+			pEnt->m_pGameWorld = nullptr;
+			m_apRecycledEntities[Type].push_back(pEnt);
+		}
+	}
+}
+
+void CGameWorld::ClearRecycledEntities()
+{
+	for(auto &vpRecycled : m_apRecycledEntities)
+	{
+		for(CEntity *pEnt : vpRecycled)
+			delete pEnt;
+		vpRecycled.clear();
+	}
+}
+
+template<typename T>
+CEntity *CGameWorld::CopyEntity(CEntity *pFrom)
+{
+	std::vector<CEntity *> &vpRecycled = m_apRecycledEntities[pFrom->m_ObjType];
+	if(vpRecycled.empty())
+		return new T(*((T *)pFrom));
+	// all entities of one type share the same class
+	T *pCopy = (T *)vpRecycled.back();
+	vpRecycled.pop_back();
+	*pCopy = *((T *)pFrom);
+	return pCopy;
+}
+
 void CGameWorld::CopyWorldClean(CGameWorld *pFrom)
 {
 	if(pFrom == this || !pFrom)
@@ -632,8 +669,8 @@ void CGameWorld::CopyWorldClean(CGameWorld *pFrom)
 	m_pTuningList = pFrom->m_pTuningList;
 	m_Teams = pFrom->m_Teams;
 	m_Core.m_vSwitchers = pFrom->m_Core.m_vSwitchers;
-	// delete the previous entities
-	Clear();
+	// take the previous entities out of the world
+	RecycleEntities();
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		m_apCharacters[i] = 0;
@@ -646,15 +683,15 @@ void CGameWorld::CopyWorldClean(CGameWorld *pFrom)
 		{
 			CEntity *pCopy = 0;
 			if(Type == ENTTYPE_PROJECTILE)
-				pCopy = new CProjectile(*((CProjectile *)pEnt));
+				pCopy = CopyEntity<CProjectile>(pEnt);
 			else if(Type == ENTTYPE_LASER)
-				pCopy = new CLaser(*((CLaser *)pEnt));
+				pCopy = CopyEntity<CLaser>(pEnt);
 			else if(Type == ENTTYPE_DRAGGER)
-				pCopy = new CDragger(*((CDragger *)pEnt));
+				pCopy = CopyEntity<CDragger>(pEnt);
 			else if(Type == ENTTYPE_CHARACTER)
-				pCopy = new CCharacter(*((CCharacter *)pEnt));
+				pCopy = CopyEntity<CCharacter>(pEnt);
 			else if(Type == ENTTYPE_PICKUP)
-				pCopy = new CPickup(*((CPickup *)pEnt));
+				pCopy = CopyEntity<CPickup>(pEnt);
 			if(pCopy)
 			{
 				pCopy->m_pParent = nullptr;
@@ -663,6 +700,8 @@ void CGameWorld::CopyWorldClean(CGameWorld *pFrom)
 			}
 		}
 	}
+	// delete the previous entities which were not reused
+	ClearRecycledEntities();
 }
 
 void CGameWorld::CopyWorld(CGameWorld *pFrom)
@@ -682,8 +721,8 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 	m_pMapBugs = pFrom->m_pMapBugs;
 	m_Teams = pFrom->m_Teams;
 	m_Core.m_vSwitchers = pFrom->m_Core.m_vSwitchers;
-	// delete the previous entities
-	Clear();
+	// take the previous entities out of the world
+	RecycleEntities();
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		m_apCharacters[i] = nullptr;
@@ -696,17 +735,17 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 		{
 			CEntity *pCopy = nullptr;
 			if(Type == ENTTYPE_PROJECTILE)
-				pCopy = new CProjectile(*((CProjectile *)pEnt));
+				pCopy = CopyEntity<CProjectile>(pEnt);
 			else if(Type == ENTTYPE_LASER)
-				pCopy = new CLaser(*((CLaser *)pEnt));
+				pCopy = CopyEntity<CLaser>(pEnt);
 			else if(Type == ENTTYPE_DRAGGER)
-				pCopy = new CDragger(*((CDragger *)pEnt));
+				pCopy = CopyEntity<CDragger>(pEnt);
 			else if(Type == ENTTYPE_CHARACTER)
-				pCopy = new CCharacter(*((CCharacter *)pEnt));
+				pCopy = CopyEntity<CCharacter>(pEnt);
 			else if(Type == ENTTYPE_PICKUP)
-				pCopy = new CPickup(*((CPickup *)pEnt));
+				pCopy = CopyEntity<CPickup>(pEnt);
 			else if(Type == ENTTYPE_PLASMA)
-				pCopy = new CPlasma(*((CPlasma *)pEnt));
+				pCopy = CopyEntity<CPlasma>(pEnt);
 			if(pCopy)
 			{
 				pCopy->m_pParent = pEnt;
@@ -715,6 +754,8 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 			}
 		}
 	}
+	// delete the previous entities which were not reused
+	ClearRecycledEntities();
 	m_IsValidCopy = true;
 }
 
@@ -114,6 +114,13 @@ public:
 private:
 	void RemoveEntities();
 
+	// Entities of the previous copy are reused for the next one instead of being reallocated
+	std::vector<CEntity *> m_apRecycledEntities[NUM_ENTTYPES];
+	void RecycleEntities();
+	void ClearRecycledEntities();
+	template<typename T>
+	CEntity *CopyEntity(CEntity *pFrom);
+
 	CEntity *m_pNextTraverseEntity = nullptr;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
 
@@ -2,10 +2,34 @@
 
 #include <base/log.h>
 
+#include <engine/engine.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
+#include <engine/storage.h>
+
+#include <game/localization.h>
 #include <game/map/envelope_manager.h>
 
+#include <algorithm>
+
 const int LAYER_DEFAULT_TILESET = -1;
 
+class CRenderLayerBuildJob : public IJob
+{
+	CRenderLayer *m_pRenderLayer;
+
+	void Run() override
+	{
+		m_pRenderLayer->Build();
+	}
+
+public:
+	CRenderLayerBuildJob(CRenderLayer *pRenderLayer) :
+		m_pRenderLayer(pRenderLayer)
+	{
+	}
+};
+
 void CMapRenderer::Clear()
 {
 	for(auto &pLayer : m_vpRenderLayers)
@@ -13,9 +37,124 @@ void CMapRenderer::Clear()
 	m_vpRenderLayers.clear();
 }
 
-void CMapRenderer::Load(ERenderType Type, CLayers *pLayers, IMapImages *pMapImages, IEnvelopeEval *pEnvelopeEval, std::optional<FRenderUploadCallback> RenderCallbackOptional)
+void CMapRenderer::Load(ERenderType Type, CLayers *pLayers, IMapImages *pMapImages, IEnvelopeEval *pEnvelopeEval, std::optional<FRenderUploadCallback> RenderCallbackOptional, IEngine *pEngine, IStorage *pStorage, std::optional<SHA256_DIGEST> MapSha256)
 {
 	Clear();
+	CreateLayers(Type, pLayers, pMapImages, pEnvelopeEval, RenderCallbackOptional);
+
+	const bool UseCache = g_Config.m_GfxMapRenderCache && pStorage && MapSha256.has_value();
+	if(!UseCache || !LoadCache(Type, pStorage, *MapSha256))
+	{
+		BuildLayers(RenderCallbackOptional, pEngine);
+		if(UseCache && pEngine)
+			SaveCache(Type, pStorage, *MapSha256, pEngine);
+	}
+
+	// only the buffer creation has to happen on this thread
+	for(auto &pRenderLayer : m_vpRenderLayers)
+		pRenderLayer->Init();
+}
+
+bool CMapRenderer::LoadCache(ERenderType Type, IStorage *pStorage, const SHA256_DIGEST &MapSha256)
+{
+	char aFilename[IO_MAX_PATH_LENGTH];
+	CMapRenderCache::Filename(MapSha256, Type, aFilename, sizeof(aFilename));
+
+	void *pData;
+	unsigned DataSize;
+	if(!pStorage->ReadFile(aFilename, IStorage::TYPE_SAVE, &pData, &DataSize))
+		return false;
+
+	bool Success = false;
+	const int Size = CMapRenderCache::CheckedSize((const unsigned char *)pData, DataSize);
+	if(Size >= 0)
+	{
+		CMapRenderCache::CReader Reader((const unsigned char *)pData, Size);
+		int32_t NumLayers;
+		Success = CMapRenderCache::ReadHeader(Reader, MapSha256, Type) && Reader.ReadValue(NumLayers);
+		int NumBuildLayers = 0;
+		for(auto &pRenderLayer : m_vpRenderLayers)
+		{
+			if(!Success)
+				break;
+			if(pRenderLayer->HasBuild())
+			{
+				Success = pRenderLayer->LoadBuild(Reader);
+				NumBuildLayers++;
+			}
+		}
+		Success = Success && NumBuildLayers == NumLayers && Reader.AtEnd();
+	}
+	free(pData);
+
+	if(!Success)
+		log_warn("map_renderer", "discarding outdated or damaged map render cache '%s'", aFilename);
+	return Success;
+}
+
+void CMapRenderer::SaveCache(ERenderType Type, IStorage *pStorage, const SHA256_DIGEST &MapSha256, IEngine *pEngine)
+{
+	CMapRenderCache::CWriter Writer;
+	CMapRenderCache::WriteHeader(Writer, MapSha256, Type);
+	const int32_t NumLayers = std::count_if(m_vpRenderLayers.begin(), m_vpRenderLayers.end(), [](const std::unique_ptr<CRenderLayer> &pRenderLayer) { return pRenderLayer->HasBuild(); });
+	if(NumLayers == 0)
+		return;
+	Writer.AddValue(NumLayers);
+	for(const auto &pRenderLayer : m_vpRenderLayers)
+	{
+		if(pRenderLayer->HasBuild())
+			pRenderLayer->SaveBuild(Writer);
+	}
+	Writer.Finish();
+
+	char aFilename[IO_MAX_PATH_LENGTH];
+	CMapRenderCache::Filename(MapSha256, Type, aFilename, sizeof(aFilename));
+	pEngine->AddJob(std::make_shared<CMapRenderCacheSaveJob>(pStorage, aFilename, std::move(Writer.m_vData)));
+}
+
+void CMapRenderer::BuildLayers(std::optional<FRenderUploadCallback> &RenderCallbackOptional, IEngine *pEngine)
+{
+	std::vector<CRenderLayer *> vpBuildLayers;
+	for(auto &pRenderLayer : m_vpRenderLayers)
+	{
+		if(pRenderLayer->HasBuild())
+			vpBuildLayers.push_back(pRenderLayer.get());
+	}
+
+	if(!pEngine || vpBuildLayers.size() <= 1)
+	{
+		for(CRenderLayer *pRenderLayer : vpBuildLayers)
+			pRenderLayer->Build();
+		return;
+	}
+
+	// the layers only read the map data and write their own build results, so they can be built in parallel
+	std::vector<std::shared_ptr<CRenderLayerBuildJob>> vpJobs;
+	vpJobs.reserve(vpBuildLayers.size());
+	for(CRenderLayer *pRenderLayer : vpBuildLayers)
+	{
+		vpJobs.push_back(std::make_shared<CRenderLayerBuildJob>(pRenderLayer));
+		pEngine->AddJob(vpJobs.back());
+	}
+
+	const char *pLoadingTitle = Localize("Loading map");
+	int NumDone = 0;
+	while(NumDone < (int)vpJobs.size())
+	{
+		NumDone = std::count_if(vpJobs.begin(), vpJobs.end(), [](const std::shared_ptr<CRenderLayerBuildJob> &pJob) { return pJob->Done(); });
+		if(RenderCallbackOptional.has_value())
+		{
+			char aLoadingMessage[128];
+			str_format(aLoadingMessage, sizeof(aLoadingMessage), Localize("Preparing map layers (%d/%d)"), NumDone, (int)vpJobs.size());
+			(*RenderCallbackOptional)(pLoadingTitle, aLoadingMessage, 0);
+		}
+		if(NumDone < (int)vpJobs.size())
+			thread_yield();
+	}
+}
+
+void CMapRenderer::CreateLayers(ERenderType Type, CLayers *pLayers, IMapImages *pMapImages, IEnvelopeEval *pEnvelopeEval, std::optional<FRenderUploadCallback> &RenderCallbackOptional)
+{
 
 	std::shared_ptr<CEnvelopeManager> pEnvelopeManager = std::make_shared<CEnvelopeManager>(pEnvelopeEval, pLayers->Map());
 	bool PassedGameLayer = false;
@@ -130,10 +269,7 @@ void CMapRenderer::Load(ERenderType Type, CLayers *pLayers, IMapImages *pMapImag
 			{
 				pRenderLayer->OnInit(Graphics(), TextRender(), RenderMap(), pEnvelopeManager, pLayers->Map(), pMapImages, RenderCallbackOptional);
 				if(pRenderLayer->IsValid())
-				{
-					pRenderLayer->Init();
 					m_vpRenderLayers.push_back(std::move(pRenderLayer));
-				}
 			}
 		}
 	}
@@ -7,17 +7,26 @@
 #include <game/map/render_component.h>
 #include <game/map/render_layer.h>
 
+class IEngine;
+class IStorage;
+
 class CMapRenderer : public CRenderComponent
 {
 public:
 	CMapRenderer() = default;
 
 	void Clear();
-	void Load(ERenderType Type, CLayers *pLayers, IMapImages *pMapImages, IEnvelopeEval *pEnvelopeEval, std::optional<FRenderUploadCallback> RenderCallbackOptional);
+	// builds the tile layer data on the job pool of pEngine if given, else on the calling thread
+	// with pStorage and the map hash given, the built data is cached on disk
+	void Load(ERenderType Type, CLayers *pLayers, IMapImages *pMapImages, IEnvelopeEval *pEnvelopeEval, std::optional<FRenderUploadCallback> RenderCallbackOptional, IEngine *pEngine = nullptr, IStorage *pStorage = nullptr, std::optional<SHA256_DIGEST> MapSha256 = std::nullopt);
 	void Render(const CRenderLayerParams &Params);
 
 private:
 	int GetLayerType(const CMapItemLayer *pLayer, const CLayers *pLayers) const;
+	void CreateLayers(ERenderType Type, CLayers *pLayers, IMapImages *pMapImages, IEnvelopeEval *pEnvelopeEval, std::optional<FRenderUploadCallback> &RenderCallbackOptional);
+	void BuildLayers(std::optional<FRenderUploadCallback> &RenderCallbackOptional, IEngine *pEngine);
+	bool LoadCache(ERenderType Type, IStorage *pStorage, const SHA256_DIGEST &MapSha256);
+	void SaveCache(ERenderType Type, IStorage *pStorage, const SHA256_DIGEST &MapSha256, IEngine *pEngine);
 
 	std::vector<std::unique_ptr<CRenderLayer>> m_vpRenderLayers;
 };
@@ -0,0 +1,135 @@
+#include "render_cache.h"
+
+#include <base/log.h>
+#include <base/system.h>
+
+#include <engine/storage.h>
+
+#include <algorithm>
+
+#include <zlib.h>
+
+static const char RENDER_CACHE_MAGIC[8] = {'D', 'D', 'R', 'C', 'A', 'C', 'H', 'E'};
+static const char *RENDER_CACHE_FOLDER = "cache/maprender";
+
+void CMapRenderCache::CWriter::Add(const void *pData, size_t Size)
+{
+	const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+	m_vData.insert(m_vData.end(), pBytes, pBytes + Size);
+}
+
+void CMapRenderCache::CWriter::Finish()
+{
+	const uint32_t Crc = crc32(0L, m_vData.data(), m_vData.size());
+	AddValue(Crc);
+}
+
+const unsigned char *CMapRenderCache::CReader::Read(size_t Size)
+{
+	if(m_Error || Size > m_Size - m_Offset)
+	{
+		m_Error = true;
+		return nullptr;
+	}
+	const unsigned char *pData = m_pData + m_Offset;
+	m_Offset += Size;
+	return pData;
+}
+
+int CMapRenderCache::CheckedSize(const unsigned char *pData, unsigned Size)
+{
+	uint32_t Crc;
+	if(Size < sizeof(Crc))
+		return -1;
+	Size -= sizeof(Crc);
+	mem_copy(&Crc, pData + Size, sizeof(Crc));
+	return crc32(0L, pData, Size) == Crc ? (int)Size : -1;
+}
+
+void CMapRenderCache::Filename(const SHA256_DIGEST &MapSha256, int RenderType, char *pBuf, size_t BufSize)
+{
+	char aSha256[SHA256_MAXSTRSIZE];
+	sha256_str(MapSha256, aSha256, sizeof(aSha256));
+	str_format(pBuf, BufSize, "%s/%s_%d.bin", RENDER_CACHE_FOLDER, aSha256, RenderType);
+}
+
+void CMapRenderCache::WriteHeader(CWriter &Writer, const SHA256_DIGEST &MapSha256, int RenderType)
+{
+	Writer.Add(RENDER_CACHE_MAGIC, sizeof(RENDER_CACHE_MAGIC));
+	Writer.AddValue<int32_t>(VERSION);
+	Writer.AddValue<int32_t>(RenderType);
+	Writer.Add(MapSha256.data, sizeof(MapSha256.data));
+}
+
+bool CMapRenderCache::ReadHeader(CReader &Reader, const SHA256_DIGEST &MapSha256, int RenderType)
+{
+	const unsigned char *pMagic = Reader.Read(sizeof(RENDER_CACHE_MAGIC));
+	int32_t Version;
+	int32_t CachedRenderType;
+	if(!pMagic || !Reader.ReadValue(Version) || !Reader.ReadValue(CachedRenderType))
+		return false;
+	const unsigned char *pSha256 = Reader.Read(sizeof(MapSha256.data));
+	if(!pSha256)
+		return false;
+	return mem_comp(pMagic, RENDER_CACHE_MAGIC, sizeof(RENDER_CACHE_MAGIC)) == 0 &&
+	       Version == VERSION &&
+	       CachedRenderType == RenderType &&
+	       mem_comp(pSha256, MapSha256.data, sizeof(MapSha256.data)) == 0;
+}
+
+CMapRenderCacheSaveJob::CMapRenderCacheSaveJob(IStorage *pStorage, const char *pFilename, std::vector<unsigned char> &&vData) :
+	m_pStorage(pStorage), m_Filename(pFilename), m_vData(std::move(vData))
+{
+}
+
+void CMapRenderCacheSaveJob::Run()
+{
+	if(!m_pStorage->CreateFolder("cache", IStorage::TYPE_SAVE) || !m_pStorage->CreateFolder(RENDER_CACHE_FOLDER, IStorage::TYPE_SAVE))
+	{
+		log_error("map_renderer", "failed to create folder for the map render cache");
+		return;
+	}
+
+	// write to a temporary file first, so a crash never leaves a truncated cache behind
+	char aTmpFilename[IO_MAX_PATH_LENGTH];
+	IStorage::FormatTmpPath(aTmpFilename, sizeof(aTmpFilename), m_Filename.c_str());
+	IOHANDLE File = m_pStorage->OpenFile(aTmpFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		log_error("map_renderer", "failed to open '%s' for writing", aTmpFilename);
+		return;
+	}
+	const bool Written = io_write(File, m_vData.data(), m_vData.size()) == m_vData.size();
+	io_close(File);
+	if(!Written || !m_pStorage->RenameFile(aTmpFilename, m_Filename.c_str(), IStorage::TYPE_SAVE))
+	{
+		log_error("map_renderer", "failed to write map render cache '%s'", m_Filename.c_str());
+		m_pStorage->RemoveFile(aTmpFilename, IStorage::TYPE_SAVE);
+		return;
+	}
+
+	// evict the least recently written files
+	struct SCacheFile
+	{
+		std::string m_Name;
+		time_t m_TimeModified;
+	};
+	std::vector<SCacheFile> vFiles;
+	m_pStorage->ListDirectoryInfo(
+		IStorage::TYPE_SAVE, RENDER_CACHE_FOLDER, [](const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser) {
+			if(!IsDir && str_endswith(pInfo->m_pName, ".bin"))
+				static_cast<std::vector<SCacheFile> *>(pUser)->push_back({pInfo->m_pName, pInfo->m_TimeModified});
+			return 0;
+		},
+		&vFiles);
+	if(vFiles.size() <= (size_t)CMapRenderCache::MAX_FILES)
+		return;
+
+	std::sort(vFiles.begin(), vFiles.end(), [](const SCacheFile &Left, const SCacheFile &Right) { return Left.m_TimeModified < Right.m_TimeModified; });
+	for(size_t i = 0; i < vFiles.size() - CMapRenderCache::MAX_FILES; i++)
+	{
+		char aPath[IO_MAX_PATH_LENGTH];
+		str_format(aPath, sizeof(aPath), "%s/%s", RENDER_CACHE_FOLDER, vFiles[i].m_Name.c_str());
+		m_pStorage->RemoveFile(aPath, IStorage::TYPE_SAVE);
+	}
+}
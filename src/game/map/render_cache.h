@@ -0,0 +1,88 @@
+#ifndef GAME_MAP_RENDER_CACHE_H
+#define GAME_MAP_RENDER_CACHE_H
+
+#include <base/hash.h>
+#include <base/system.h>
+
+#include <engine/shared/jobs.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class IStorage;
+
+// on-disk cache of the baked tile layer buffers, keyed by map hash and render type
+class CMapRenderCache
+{
+public:
+	enum
+	{
+		VERSION = 1,
+		MAX_FILES = 64,
+	};
+
+	class CWriter
+	{
+	public:
+		void Add(const void *pData, size_t Size);
+		template<class T>
+		void AddValue(const T &Value)
+		{
+			Add(&Value, sizeof(Value));
+		}
+		// appends the checksum, nothing may be added afterwards
+		void Finish();
+
+		std::vector<unsigned char> m_vData;
+	};
+
+	class CReader
+	{
+	public:
+		CReader(const unsigned char *pData, size_t Size) :
+			m_pData(pData), m_Size(Size) {}
+
+		// returns nullptr and marks the reader as failed if not enough data is left
+		const unsigned char *Read(size_t Size);
+		template<class T>
+		bool ReadValue(T &Value)
+		{
+			const unsigned char *pData = Read(sizeof(Value));
+			if(!pData)
+				return false;
+			mem_copy(&Value, pData, sizeof(Value));
+			return true;
+		}
+		bool Error() const { return m_Error; }
+		bool AtEnd() const { return m_Offset == m_Size; }
+
+	private:
+		const unsigned char *m_pData;
+		size_t m_Size;
+		size_t m_Offset = 0;
+		bool m_Error = false;
+	};
+
+	// checks the trailing checksum, returns the size of the data in front of it or -1 on mismatch
+	static int CheckedSize(const unsigned char *pData, unsigned Size);
+	static void Filename(const SHA256_DIGEST &MapSha256, int RenderType, char *pBuf, size_t BufSize);
+	static void WriteHeader(CWriter &Writer, const SHA256_DIGEST &MapSha256, int RenderType);
+	static bool ReadHeader(CReader &Reader, const SHA256_DIGEST &MapSha256, int RenderType);
+};
+
+// writes a finished cache file and evicts the oldest ones if there are too many
+class CMapRenderCacheSaveJob : public IJob
+{
+	IStorage *m_pStorage;
+	std::string m_Filename;
+	std::vector<unsigned char> m_vData;
+
+	void Run() override;
+
+public:
+	CMapRenderCacheSaveJob(IStorage *pStorage, const char *pFilename, std::vector<unsigned char> &&vData);
+};
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <array>
 #include <chrono>
+#include <type_traits>
 
 /************************
  * Render Buffer Helper *
@@ -580,19 +581,135 @@ void CRenderLayerTile::RenderTileLayerNoTileBuffer(const ColorRGBA &Color, const
 	RenderMap()->RenderTilemap(m_pTiles, m_pLayerTilemap->m_Width, m_pLayerTilemap->m_Height, 32.0f, Color, (Params.m_RenderTileBorder ? TILERENDERFLAG_EXTEND : 0) | LAYERRENDERFLAG_TRANSPARENT);
 }
 
+bool CRenderLayerTile::HasBuild()
+{
+	return Graphics()->IsTileBufferingEnabled();
+}
+
+void CRenderLayerTile::Build()
+{
+	BuildTileData(0, false);
+}
+
 void CRenderLayerTile::Init()
 {
-	if(m_pLayerTilemap->m_Image >= 0 && m_pLayerTilemap->m_Image < m_pMapImages->Num())
-		m_TextureHandle = m_pMapImages->Get(m_pLayerTilemap->m_Image);
-	else
-		m_TextureHandle.Invalidate();
-	UploadTileData(m_VisualTiles, 0, false);
+	UploadTileData(m_VisualTiles, 0);
 }
 
-void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay, bool AddAsSpeedup, bool IsGameLayer)
+void CRenderLayerTile::CTileLayerBuild::Reset()
 {
-	if(!Graphics()->IsTileBufferingEnabled())
-		return;
+	m_Built = false;
+	m_VisualsValid = false;
+	m_Visuals = CTileLayerVisuals();
+	free(m_pUploadData);
+	m_pUploadData = nullptr;
+	m_UploadDataSize = 0;
+	m_NumTiles = 0;
+}
+
+void CRenderLayerTile::SaveBuild(CMapRenderCache::CWriter &Writer) const
+{
+	static_assert(std::is_trivially_copyable_v<CTileLayerVisuals::CTileVisual>);
+
+	Writer.AddValue<int32_t>(m_GroupId);
+	Writer.AddValue<int32_t>(m_LayerId);
+	Writer.AddValue<int32_t>(m_pLayerTilemap->m_Width);
+	Writer.AddValue<int32_t>(m_pLayerTilemap->m_Height);
+	Writer.AddValue<uint8_t>(m_BuildTextured);
+
+	for(const CTileLayerBuild &Build : m_aTileBuilds)
+	{
+		Writer.AddValue<uint8_t>(Build.m_Built);
+		Writer.AddValue<uint8_t>(Build.m_VisualsValid);
+		if(!Build.m_VisualsValid)
+			continue;
+
+		const CTileLayerVisuals &Visuals = Build.m_Visuals;
+		Writer.Add(Visuals.m_vTilesOfLayer.data(), Visuals.m_vTilesOfLayer.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		Writer.Add(Visuals.m_vBorderTop.data(), Visuals.m_vBorderTop.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		Writer.Add(Visuals.m_vBorderBottom.data(), Visuals.m_vBorderBottom.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		Writer.Add(Visuals.m_vBorderLeft.data(), Visuals.m_vBorderLeft.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		Writer.Add(Visuals.m_vBorderRight.data(), Visuals.m_vBorderRight.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		Writer.AddValue(Visuals.m_BorderTopLeft);
+		Writer.AddValue(Visuals.m_BorderTopRight);
+		Writer.AddValue(Visuals.m_BorderBottomRight);
+		Writer.AddValue(Visuals.m_BorderBottomLeft);
+		Writer.AddValue(Visuals.m_BorderKillTile);
+
+		Writer.AddValue<uint64_t>(Build.m_NumTiles);
+		Writer.AddValue<uint64_t>(Build.m_UploadDataSize);
+		Writer.Add(Build.m_pUploadData, Build.m_UploadDataSize);
+	}
+
+	Writer.AddValue(*m_LayerClip);
+}
+
+bool CRenderLayerTile::LoadBuild(CMapRenderCache::CReader &Reader)
+{
+	int32_t GroupId, LayerId, Width, Height;
+	uint8_t Textured;
+	if(!Reader.ReadValue(GroupId) || !Reader.ReadValue(LayerId) || !Reader.ReadValue(Width) || !Reader.ReadValue(Height) || !Reader.ReadValue(Textured))
+		return false;
+	if(GroupId != m_GroupId || LayerId != m_LayerId || Width != m_pLayerTilemap->m_Width || Height != m_pLayerTilemap->m_Height || (bool)Textured != m_BuildTextured)
+		return false;
+
+	auto ReadVisuals = [&](std::vector<CTileLayerVisuals::CTileVisual> &vVisuals) {
+		const unsigned char *pData = Reader.Read(vVisuals.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		if(pData)
+			mem_copy(vVisuals.data(), pData, vVisuals.size() * sizeof(CTileLayerVisuals::CTileVisual));
+		return pData != nullptr;
+	};
+
+	const size_t TileDataSize = 4 * (sizeof(vec2) + (m_BuildTextured ? sizeof(ubvec4) : 0));
+	for(CTileLayerBuild &Build : m_aTileBuilds)
+	{
+		Build.Reset();
+
+		uint8_t Built, VisualsValid;
+		if(!Reader.ReadValue(Built) || !Reader.ReadValue(VisualsValid))
+			return false;
+		Build.m_Built = Built;
+		if(!VisualsValid)
+			continue;
+
+		CTileLayerVisuals &Visuals = Build.m_Visuals;
+		if(!Visuals.Init(Width, Height))
+			return false;
+		Build.m_VisualsValid = true;
+		Visuals.m_IsTextured = m_BuildTextured;
+		if(!ReadVisuals(Visuals.m_vTilesOfLayer) || !ReadVisuals(Visuals.m_vBorderTop) || !ReadVisuals(Visuals.m_vBorderBottom) || !ReadVisuals(Visuals.m_vBorderLeft) || !ReadVisuals(Visuals.m_vBorderRight))
+			return false;
+		if(!Reader.ReadValue(Visuals.m_BorderTopLeft) || !Reader.ReadValue(Visuals.m_BorderTopRight) || !Reader.ReadValue(Visuals.m_BorderBottomRight) || !Reader.ReadValue(Visuals.m_BorderBottomLeft) || !Reader.ReadValue(Visuals.m_BorderKillTile))
+			return false;
+
+		uint64_t NumTiles, UploadDataSize;
+		if(!Reader.ReadValue(NumTiles) || !Reader.ReadValue(UploadDataSize) || UploadDataSize != NumTiles * TileDataSize)
+			return false;
+		const unsigned char *pUploadData = Reader.Read(UploadDataSize);
+		if(!pUploadData)
+			return false;
+		if(UploadDataSize > 0)
+		{
+			Build.m_pUploadData = (char *)malloc(UploadDataSize);
+			mem_copy(Build.m_pUploadData, pUploadData, UploadDataSize);
+		}
+		Build.m_UploadDataSize = UploadDataSize;
+		Build.m_NumTiles = NumTiles;
+	}
+
+	CClipRegion LayerClip;
+	if(!Reader.ReadValue(LayerClip))
+		return false;
+	m_LayerClip = LayerClip;
+	return true;
+}
+
+void CRenderLayerTile::BuildTileData(int CurOverlay, bool AddAsSpeedup, bool IsGameLayer)
+{
+	dbg_assert(CurOverlay >= 0 && CurOverlay < MAX_TILE_OVERLAYS, "Invalid tile overlay %d", CurOverlay);
+	CTileLayerBuild &Build = m_aTileBuilds[CurOverlay];
+	Build.Reset();
+	Build.m_Built = true;
 
 	// prepare all visuals for all tile layers
 	std::vector<CGraphicTile> vTmpTiles;
@@ -608,16 +725,12 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 	std::vector<CGraphicTile> vTmpBorderCorners;
 	std::vector<CGraphicTileTextureCoords> vTmpBorderCornersTexCoords;
 
-	const bool DoTextureCoords = GetTexture().IsValid();
-
-	// create the visual and set it in the optional, afterwards get it
-	CTileLayerVisuals v;
-	v.OnInit(this);
-	VisualsOptional = v;
-	CTileLayerVisuals &Visuals = VisualsOptional.value();
+	const bool DoTextureCoords = m_BuildTextured;
 
+	CTileLayerVisuals &Visuals = Build.m_Visuals;
 	if(!Visuals.Init(m_pLayerTilemap->m_Width, m_pLayerTilemap->m_Height))
 		return;
+	Build.m_VisualsValid = true;
 
 	Visuals.m_IsTextured = DoTextureCoords;
 
@@ -801,7 +914,6 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 	float *pTmpTiles = vTmpTiles.empty() ? nullptr : (float *)vTmpTiles.data();
 	unsigned char *pTmpTileTexCoords = vTmpTileTexCoords.empty() ? nullptr : (unsigned char *)vTmpTileTexCoords.data();
 
-	Visuals.m_BufferContainerIndex = -1;
 	size_t UploadDataSize = vTmpTileTexCoords.size() * sizeof(CGraphicTileTextureCoords) + vTmpTiles.size() * sizeof(CGraphicTile);
 	if(UploadDataSize > 0)
 	{
@@ -813,8 +925,34 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 			mem_copy_special(pUploadData + sizeof(vec2), pTmpTileTexCoords, sizeof(ubvec4), vTmpTiles.size() * 4, sizeof(vec2));
 		}
 
-		// first create the buffer object
-		int BufferObjectIndex = Graphics()->CreateBufferObject(UploadDataSize, pUploadData, 0, true);
+		Build.m_pUploadData = pUploadData;
+		Build.m_UploadDataSize = UploadDataSize;
+		Build.m_NumTiles = vTmpTiles.size();
+	}
+}
+
+void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay)
+{
+	CTileLayerBuild &Build = m_aTileBuilds[CurOverlay];
+	if(!Build.m_Built)
+		return;
+
+	Build.m_Built = false;
+
+	// move the visual into the optional, afterwards get it
+	VisualsOptional = std::move(Build.m_Visuals);
+	CTileLayerVisuals &Visuals = VisualsOptional.value();
+	Visuals.OnInit(this);
+	Visuals.m_BufferContainerIndex = -1;
+	if(!Build.m_VisualsValid)
+		return;
+
+	const bool DoTextureCoords = Visuals.m_IsTextured;
+	if(Build.m_UploadDataSize > 0)
+	{
+		// first create the buffer object, the backend takes ownership of the data
+		int BufferObjectIndex = Graphics()->CreateBufferObject(Build.m_UploadDataSize, Build.m_pUploadData, 0, true);
+		Build.m_pUploadData = nullptr;
 
 		// then create the buffer container
 		SBufferContainerInfo ContainerInfo;
@@ -840,7 +978,7 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 
 		Visuals.m_BufferContainerIndex = Graphics()->CreateBufferContainer(&ContainerInfo);
 		// and finally inform the backend how many indices are required
-		Graphics()->IndicesNumRequiredNotify(vTmpTiles.size() * 6);
+		Graphics()->IndicesNumRequiredNotify(Build.m_NumTiles * 6);
 	}
 	RenderLoading();
 }
@@ -883,6 +1021,15 @@ void CRenderLayerTile::OnInit(IGraphics *pGraphics, ITextRender *pTextRender, CR
 	CRenderLayer::OnInit(pGraphics, pTextRender, pRenderMap, pEnvelopeManager, pMap, pMapImages, FRenderUploadCallbackOptional);
 	InitTileData();
 	m_LayerClip = CClipRegion(0.0f, 0.0f, m_pLayerTilemap->m_Width * 32.0f, m_pLayerTilemap->m_Height * 32.0f);
+
+	if(m_pLayerTilemap->m_Image >= 0 && m_pLayerTilemap->m_Image < m_pMapImages->Num())
+		m_TextureHandle = m_pMapImages->Get(m_pLayerTilemap->m_Image);
+	else
+		m_TextureHandle.Invalidate();
+
+	// the texture lookup may load images, so resolve it here and not in the build job
+	if(IsValid() && HasBuild())
+		m_BuildTextured = GetTexture().IsValid();
 }
 
 void CRenderLayerTile::InitTileData()
@@ -1396,9 +1543,14 @@ IGraphics::CTextureHandle CRenderLayerEntityBase::GetTexture() const
 CRenderLayerEntityGame::CRenderLayerEntityGame(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap) :
 	CRenderLayerEntityBase(GroupId, LayerId, Flags, pLayerTilemap) {}
 
+void CRenderLayerEntityGame::Build()
+{
+	BuildTileData(0, false, true);
+}
+
 void CRenderLayerEntityGame::Init()
 {
-	UploadTileData(m_VisualTiles, 0, false, true);
+	UploadTileData(m_VisualTiles, 0);
 }
 
 void CRenderLayerEntityGame::RenderTileLayerWithTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params)
@@ -1454,10 +1606,16 @@ int CRenderLayerEntityTele::GetDataIndex(unsigned int &TileSize) const
 	return m_pLayerTilemap->m_Tele;
 }
 
+void CRenderLayerEntityTele::Build()
+{
+	BuildTileData(0, false);
+	BuildTileData(1, false);
+}
+
 void CRenderLayerEntityTele::Init()
 {
-	UploadTileData(m_VisualTiles, 0, false);
-	UploadTileData(m_VisualTeleNumbers, 1, false);
+	UploadTileData(m_VisualTiles, 0);
+	UploadTileData(m_VisualTeleNumbers, 1);
 }
 
 void CRenderLayerEntityTele::InitTileData()
@@ -1524,11 +1682,18 @@ int CRenderLayerEntitySpeedup::GetDataIndex(unsigned int &TileSize) const
 	return m_pLayerTilemap->m_Speedup;
 }
 
+void CRenderLayerEntitySpeedup::Build()
+{
+	BuildTileData(0, true);
+	BuildTileData(1, false);
+	BuildTileData(2, false);
+}
+
 void CRenderLayerEntitySpeedup::Init()
 {
-	UploadTileData(m_VisualTiles, 0, true);
-	UploadTileData(m_VisualForce, 1, false);
-	UploadTileData(m_VisualMaxSpeed, 2, false);
+	UploadTileData(m_VisualTiles, 0);
+	UploadTileData(m_VisualForce, 1);
+	UploadTileData(m_VisualMaxSpeed, 2);
 }
 
 void CRenderLayerEntitySpeedup::InitTileData()
@@ -1604,11 +1769,18 @@ int CRenderLayerEntitySwitch::GetDataIndex(unsigned int &TileSize) const
 	return m_pLayerTilemap->m_Switch;
 }
 
+void CRenderLayerEntitySwitch::Build()
+{
+	BuildTileData(0, false);
+	BuildTileData(1, false);
+	BuildTileData(2, false);
+}
+
 void CRenderLayerEntitySwitch::Init()
 {
-	UploadTileData(m_VisualTiles, 0, false);
-	UploadTileData(m_VisualSwitchNumberTop, 1, false);
-	UploadTileData(m_VisualSwitchNumberBottom, 2, false);
+	UploadTileData(m_VisualTiles, 0);
+	UploadTileData(m_VisualSwitchNumberTop, 1);
+	UploadTileData(m_VisualSwitchNumberBottom, 2);
 }
 
 void CRenderLayerEntitySwitch::InitTileData()
@@ -2,6 +2,7 @@
 #define GAME_MAP_RENDER_LAYER_H
 
 #include <cstdint>
+#include <cstdlib>
 
 using offset_ptr_size = char *;
 using offset_ptr = uintptr_t;
@@ -12,6 +13,7 @@ using offset_ptr32 = unsigned int;
 #include <engine/graphics.h>
 
 #include <game/map/envelope_manager.h>
+#include <game/map/render_cache.h>
 #include <game/map/render_component.h>
 #include <game/map/render_map.h>
 #include <game/mapitems.h>
@@ -67,6 +69,11 @@ public:
 	CRenderLayer(int GroupId, int LayerId, int Flags);
 	virtual void OnInit(IGraphics *pGraphics, ITextRender *pTextRender, CRenderMap *pRenderMap, std::shared_ptr<CEnvelopeManager> &pEnvelopeManager, IMap *pMap, IMapImages *pMapImages, std::optional<FRenderUploadCallback> &FRenderUploadCallbackOptional);
 
+	// CPU side preparation of the render data, must not use the graphics backend, runs on a job thread before Init
+	virtual void Build() {}
+	virtual bool HasBuild() { return false; }
+	virtual void SaveBuild(CMapRenderCache::CWriter &Writer) const {}
+	virtual bool LoadBuild(CMapRenderCache::CReader &Reader) { return false; }
 	virtual void Init() = 0;
 	virtual void Render(const CRenderLayerParams &Params) = 0;
 	virtual bool DoRender(const CRenderLayerParams &Params) = 0;
@@ -118,6 +125,10 @@ public:
 	~CRenderLayerTile() override = default;
 	void Render(const CRenderLayerParams &Params) override;
 	bool DoRender(const CRenderLayerParams &Params) override;
+	void Build() override;
+	bool HasBuild() override;
+	void SaveBuild(CMapRenderCache::CWriter &Writer) const override;
+	bool LoadBuild(CMapRenderCache::CReader &Reader) override;
 	void Init() override;
 	void OnInit(IGraphics *pGraphics, ITextRender *pTextRender, CRenderMap *pRenderMap, std::shared_ptr<CEnvelopeManager> &pEnvelopeManager, IMap *pMap, IMapImages *pMapImages, std::optional<FRenderUploadCallback> &FRenderUploadCallbackOptional) override;
 
@@ -210,7 +221,31 @@ protected:
 		bool m_IsTextured;
 	};
 
-	void UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay, bool AddAsSpeedup, bool IsGameLayer = false);
+	enum
+	{
+		MAX_TILE_OVERLAYS = 3,
+	};
+
+	// vertex data of one overlay, built off the render thread and consumed by UploadTileData
+	class CTileLayerBuild
+	{
+	public:
+		CTileLayerBuild() = default;
+		CTileLayerBuild(const CTileLayerBuild &) = delete;
+		CTileLayerBuild &operator=(const CTileLayerBuild &) = delete;
+		~CTileLayerBuild() { free(m_pUploadData); }
+		void Reset();
+
+		bool m_Built = false;
+		bool m_VisualsValid = false;
+		CTileLayerVisuals m_Visuals;
+		char *m_pUploadData = nullptr;
+		size_t m_UploadDataSize = 0;
+		size_t m_NumTiles = 0;
+	};
+
+	void BuildTileData(int CurOverlay, bool AddAsSpeedup, bool IsGameLayer = false);
+	void UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay);
 
 	virtual void RenderTileLayerWithTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params);
 	virtual void RenderTileLayerNoTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params);
@@ -220,6 +255,8 @@ protected:
 	void RenderKillTileBorder(const ColorRGBA &Color);
 
 	std::optional<CRenderLayerTile::CTileLayerVisuals> m_VisualTiles;
+	CTileLayerBuild m_aTileBuilds[MAX_TILE_OVERLAYS];
+	bool m_BuildTextured = false;
 	CMapItemLayerTilemap *m_pLayerTilemap;
 	ColorRGBA m_Color;
 };
@@ -295,6 +332,7 @@ class CRenderLayerEntityGame final : public CRenderLayerEntityBase
 {
 public:
 	CRenderLayerEntityGame(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
+	void Build() override;
 	void Init() override;
 
 protected:
@@ -317,6 +355,7 @@ class CRenderLayerEntityTele final : public CRenderLayerEntityBase
 public:
 	CRenderLayerEntityTele(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
 	int GetDataIndex(unsigned int &TileSize) const override;
+	void Build() override;
 	void Init() override;
 	void InitTileData() override;
 	void Unload() override;
@@ -336,6 +375,7 @@ class CRenderLayerEntitySpeedup final : public CRenderLayerEntityBase
 public:
 	CRenderLayerEntitySpeedup(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
 	int GetDataIndex(unsigned int &TileSize) const override;
+	void Build() override;
 	void Init() override;
 	void InitTileData() override;
 	void Unload() override;
@@ -357,6 +397,7 @@ class CRenderLayerEntitySwitch final : public CRenderLayerEntityBase
 public:
 	CRenderLayerEntitySwitch(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
 	int GetDataIndex(unsigned int &TileSize) const override;
+	void Build() override;
 	void Init() override;
 	void InitTileData() override;
 	void Unload() override;
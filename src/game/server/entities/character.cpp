@@ -817,10 +817,10 @@ void CCharacter::Tick()
 		PreTick();
 	}
 
+	if(m_pPlayer)
+		m_pPlayer->OnCharacterInput(m_PrevInput, m_Input);
 	if(!m_PrevInput.m_Hook && m_Input.m_Hook)
 	{
-		if(m_pPlayer)
-			m_pPlayer->OnHookFired();
 		if(!(m_Core.m_TriggeredEvents & COREEVENT_HOOK_ATTACH_PLAYER))
 		{
 			Antibot()->OnHookAttach(m_pPlayer->GetCid(), false);
@@ -1378,6 +1378,15 @@ void CCharacter::FillAntibot(CAntibotCharacterData *pData)
 	pData->m_SpawnTick = m_SpawnTick;
 	pData->m_WeaponChangeTick = m_WeaponChangeTick;
 
+	const CInputAnalytics &InputAnalytics = m_pPlayer->InputAnalytics();
+	for(int i = 0; i < CInputAnalytics::NUM_EVENTS; i++)
+	{
+		const CInputAnalytics::EEvent Event = (CInputAnalytics::EEvent)i;
+		pData->m_InputStats.m_aRate[i] = InputAnalytics.Rate(Event);
+		pData->m_InputStats.m_aIntervalJitter[i] = InputAnalytics.IntervalJitter(Event);
+	}
+	pData->m_InputStats.m_AimSpeed = InputAnalytics.AimSpeed();
+
 	// 0
 	pData->m_aLatestInputs[0].m_Direction = m_LatestInput.m_Direction;
 	pData->m_aLatestInputs[0].m_TargetX = m_LatestInput.m_TargetX;
@@ -0,0 +1,118 @@
+#include "input_analytics.h"
+
+#include <base/math.h>
+#include <base/system.h>
+#include <base/vmath.h>
+
+#include <game/gamecore.h>
+
+#include <generated/protocol.h>
+
+#include <bit>
+#include <cmath>
+
+static int BurstBucket(int Interval)
+{
+	return minimum((int)std::bit_width((unsigned)(Interval - 1)), (int)CInputAnalytics::NUM_BURST_BUCKETS - 1);
+}
+
+void CInputAnalytics::CEventWindow::Reset()
+{
+	m_First = 0;
+	m_Count = 0;
+	m_IntervalSum = 0;
+	m_IntervalSquareSum = 0;
+	mem_zero(m_aBursts, sizeof(m_aBursts));
+}
+
+void CInputAnalytics::CEventWindow::Add(int Tick)
+{
+	if(m_Count > 0)
+	{
+		const int Interval = Tick - m_aTicks[(m_First + m_Count - 1) % WINDOW_TICKS];
+		m_IntervalSum += Interval;
+		m_IntervalSquareSum += Interval * Interval;
+		m_aBursts[BurstBucket(Interval)]++;
+	}
+	m_aTicks[(m_First + m_Count) % WINDOW_TICKS] = Tick;
+	m_Count++;
+}
+
+void CInputAnalytics::CEventWindow::Expire(int Tick)
+{
+	while(m_Count > 0 && m_aTicks[m_First] <= Tick - WINDOW_TICKS)
+	{
+		if(m_Count > 1)
+		{
+			const int Interval = m_aTicks[(m_First + 1) % WINDOW_TICKS] - m_aTicks[m_First];
+			m_IntervalSum -= Interval;
+			m_IntervalSquareSum -= Interval * Interval;
+			m_aBursts[BurstBucket(Interval)]--;
+		}
+		m_First = (m_First + 1) % WINDOW_TICKS;
+		m_Count--;
+	}
+}
+
+void CInputAnalytics::Reset()
+{
+	for(CEventWindow &Events : m_aEvents)
+		Events.Reset();
+	mem_zero(m_aAimDeltas, sizeof(m_aAimDeltas));
+	m_AimDeltaSum = 0;
+	m_LastAngle = 0.0f;
+	m_LastTick = -1;
+}
+
+void CInputAnalytics::Tick(int Tick, const CNetObj_PlayerInput &PrevInput, const CNetObj_PlayerInput &Input)
+{
+	// the windows only move forward
+	if(Tick <= m_LastTick)
+		Reset();
+
+	const float Angle = angle(vec2(Input.m_TargetX, Input.m_TargetY));
+	int AimDelta = 0;
+	if(m_LastTick < 0 || Tick - m_LastTick >= WINDOW_TICKS)
+	{
+		mem_zero(m_aAimDeltas, sizeof(m_aAimDeltas));
+		m_AimDeltaSum = 0;
+	}
+	else
+	{
+		// forget the aim of the ticks that were skipped
+		for(int Skipped = m_LastTick + 1; Skipped < Tick; Skipped++)
+		{
+			m_AimDeltaSum -= m_aAimDeltas[Skipped % WINDOW_TICKS];
+			m_aAimDeltas[Skipped % WINDOW_TICKS] = 0;
+		}
+		float Delta = absolute(Angle - m_LastAngle);
+		if(Delta > pi)
+			Delta = 2 * pi - Delta;
+		AimDelta = round_to_int(Delta * AIM_DELTA_SCALE);
+	}
+	int &Slot = m_aAimDeltas[Tick % WINDOW_TICKS];
+	m_AimDeltaSum += AimDelta - Slot;
+	Slot = AimDelta;
+	m_LastAngle = Angle;
+	m_LastTick = Tick;
+
+	for(CEventWindow &Events : m_aEvents)
+		Events.Expire(Tick);
+	if(!PrevInput.m_Hook && Input.m_Hook)
+		m_aEvents[EVENT_HOOK].Add(Tick);
+	if(CountInput(PrevInput.m_Fire, Input.m_Fire).m_Presses)
+		m_aEvents[EVENT_FIRE].Add(Tick);
+	if(!PrevInput.m_Jump && Input.m_Jump)
+		m_aEvents[EVENT_JUMP].Add(Tick);
+}
+
+float CInputAnalytics::IntervalJitter(EEvent Event) const
+{
+	const CEventWindow &Events = m_aEvents[Event];
+	const int NumIntervals = Events.m_Count - 1;
+	if(NumIntervals < 2)
+		return 0.0f;
+	const float Mean = Events.m_IntervalSum / (float)NumIntervals;
+	const float Variance = Events.m_IntervalSquareSum / (float)NumIntervals - Mean * Mean;
+	return Variance > 0.0f ? std::sqrt(Variance) : 0.0f;
+}
@@ -0,0 +1,75 @@
+#ifndef GAME_SERVER_INPUT_ANALYTICS_H
+#define GAME_SERVER_INPUT_ANALYTICS_H
+
+#include <engine/shared/protocol.h>
+
+struct CNetObj_PlayerInput;
+
+// Keeps the input events of a player over the last second and derives
+// statistics from them incrementally, so every tick costs the same.
+class CInputAnalytics
+{
+public:
+	enum EEvent
+	{
+		EVENT_HOOK,
+		EVENT_FIRE,
+		EVENT_JUMP,
+		NUM_EVENTS,
+	};
+
+	enum
+	{
+		WINDOW_TICKS = SERVER_TICK_SPEED,
+		// intervals of 1, 2, 3-4, 5-8, 9-16, 17-32 and more ticks
+		NUM_BURST_BUCKETS = 7,
+	};
+
+	CInputAnalytics() { Reset(); }
+
+	void Reset();
+	// call once per tick with the input of the previous and the current tick
+	void Tick(int Tick, const CNetObj_PlayerInput &PrevInput, const CNetObj_PlayerInput &Input);
+
+	// number of ticks in the window with a press
+	int Count(EEvent Event) const { return m_aEvents[Event].m_Count; }
+	// events per second over the window
+	float Rate(EEvent Event) const { return m_aEvents[Event].m_Count * (float)SERVER_TICK_SPEED / WINDOW_TICKS; }
+	// standard deviation of the ticks between the events in the window
+	float IntervalJitter(EEvent Event) const;
+	// number of intervals in the window that fall into the bucket
+	int Bursts(EEvent Event, int Bucket) const { return m_aEvents[Event].m_aBursts[Bucket]; }
+	// mean change of the aim angle per tick over the window, in radians
+	float AimSpeed() const { return m_AimDeltaSum / (AIM_DELTA_SCALE * (float)WINDOW_TICKS); }
+
+private:
+	enum
+	{
+		AIM_DELTA_SCALE = 1000,
+	};
+
+	// ring of the ticks with an event, there is at most one per tick
+	class CEventWindow
+	{
+	public:
+		int m_aTicks[WINDOW_TICKS];
+		int m_First;
+		int m_Count;
+		int m_IntervalSum;
+		int m_IntervalSquareSum;
+		int m_aBursts[NUM_BURST_BUCKETS];
+
+		void Reset();
+		void Add(int Tick);
+		void Expire(int Tick);
+	};
+
+	CEventWindow m_aEvents[NUM_EVENTS];
+	// aim changes in milliradians, indexed by tick
+	int m_aAimDeltas[WINDOW_TICKS];
+	int m_AimDeltaSum;
+	float m_LastAngle;
+	int m_LastTick;
+};
+
+#endif
@@ -163,8 +163,7 @@ void CPlayer::Reset()
 
 	m_CameraInfo.Reset();
 
-	m_HookSpamWindowStartTick = 0;
-	m_HookSpamCount = 0;
+	m_InputAnalytics.Reset();
 	m_HookSpamWarned = false;
 }
 
@@ -999,32 +998,23 @@ void CPlayer::SpectatePlayerName(const char *pName)
 	}
 }
 
-void CPlayer::OnHookFired()
+void CPlayer::OnCharacterInput(const CNetObj_PlayerInput &PrevInput, const CNetObj_PlayerInput &Input)
 {
+	// always kept up to date, the antibot reads it as well
+	m_InputAnalytics.Tick(Server()->Tick(), PrevInput, Input);
+
 	if(!g_Config.m_SvAntiHookMonitor)
 		return;
 
-	const int64_t Now = Server()->Tick();
-	const int64_t TickSpeed = Server()->TickSpeed();
-
-	if(m_HookSpamWindowStartTick == 0 || Now > m_HookSpamWindowStartTick + TickSpeed)
-	{
-		m_HookSpamWindowStartTick = Now;
-		m_HookSpamCount = 0;
-		m_HookSpamWarned = false;
-	}
-
-	++m_HookSpamCount;
-
+	// warn again once the hook rate went back below the threshold
 	const int HookSpamThreshold = g_Config.m_SvAntiHookClick > 0 ? g_Config.m_SvAntiHookClick : 20;
-	if(!m_HookSpamWarned && m_HookSpamCount >= HookSpamThreshold)
+	const int NumHooks = m_InputAnalytics.Count(CInputAnalytics::EVENT_HOOK);
+	if(NumHooks < HookSpamThreshold)
+		m_HookSpamWarned = false;
+	else if(!m_HookSpamWarned)
 	{
 		m_HookSpamWarned = true;
-		float Duration = (Now - m_HookSpamWindowStartTick) / static_cast<float>(TickSpeed);
-		if(Duration <= 0.0f)
-			Duration = 1.0f;
-		const float HooksPerSecond = m_HookSpamCount / Duration;
-		GameServer()->OnHookSpamDetected(this, HooksPerSecond);
+		GameServer()->OnHookSpamDetected(this, m_InputAnalytics.Rate(CInputAnalytics::EVENT_HOOK));
 	}
 }
 
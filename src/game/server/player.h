@@ -3,6 +3,7 @@
 #ifndef GAME_SERVER_PLAYER_H
 #define GAME_SERVER_PLAYER_H
 
+#include "input_analytics.h"
 #include "teeinfo.h"
 
 #include <base/vmath.h>
@@ -61,7 +62,8 @@ public:
 	const CCharacter *GetCharacter() const;
 
 	void SpectatePlayerName(const char *pName);
-	void OnHookFired();
+	void OnCharacterInput(const CNetObj_PlayerInput &PrevInput, const CNetObj_PlayerInput &Input);
+	const CInputAnalytics &InputAnalytics() const { return m_InputAnalytics; }
 
 	//---------------------------------------------------------
 	// this is used for snapping so we know how we can clip the view for the player
@@ -257,8 +259,7 @@ public:
 	bool m_EyeEmoteEnabled;
 	int m_TimerType;
 
-	int64_t m_HookSpamWindowStartTick = 0;
-	int m_HookSpamCount = 0;
+	CInputAnalytics m_InputAnalytics;
 	bool m_HookSpamWarned = false;
 	int64_t m_NextHookDemoRecordTick = 0;
 
@@ -0,0 +1,81 @@
+#include <base/system.h>
+
+#include <game/client/components/tclient/bg_draw_file.h>
+
+#include <gtest/gtest.h>
+
+static std::vector<CBgDrawItemData> TestItems()
+{
+	std::vector<CBgDrawItemData> vItems;
+	CBgDrawItemData Line;
+	for(int i = 0; i < 100; i++)
+		Line.emplace_back(1000.0f + i * 12.5f, -300.0f - i * 3.0f, 5.0f, 1.0f, 0.5f, 0.0f, 1.0f);
+	vItems.push_back(Line);
+	CBgDrawItemData Dot;
+	Dot.emplace_back(-42.0625f, 17.5f, 10.0f, 0.0f, 0.0f, 1.0f, 0.25f);
+	vItems.push_back(Dot);
+	return vItems;
+}
+
+static void ExpectRoundTrip(bool Compress)
+{
+	const std::vector<CBgDrawItemData> vItems = TestItems();
+	std::vector<unsigned char> vData;
+	BgDrawFile::WriteBinary(vData, vItems, Compress);
+	ASSERT_TRUE(BgDrawFile::IsBinary(vData.data(), vData.size()));
+
+	std::vector<CBgDrawItemData> vRead;
+	ASSERT_TRUE(BgDrawFile::ReadBinary(vData.data(), vData.size(), vRead, 100));
+	ASSERT_EQ(vRead.size(), vItems.size());
+	for(size_t i = 0; i < vItems.size(); i++)
+	{
+		ASSERT_EQ(vRead[i].size(), vItems[i].size());
+		for(size_t j = 0; j < vItems[i].size(); j++)
+		{
+			const CBgDrawItemDataPoint &Expected = vItems[i][j];
+			const CBgDrawItemDataPoint &Actual = vRead[i][j];
+			EXPECT_NEAR(Actual.x, Expected.x, 1.0f / 16.0f);
+			EXPECT_NEAR(Actual.y, Expected.y, 1.0f / 16.0f);
+			EXPECT_NEAR(Actual.w, Expected.w, 1.0f / 16.0f);
+			EXPECT_NEAR(Actual.r, Expected.r, 1.0f / 255.0f);
+			EXPECT_NEAR(Actual.g, Expected.g, 1.0f / 255.0f);
+			EXPECT_NEAR(Actual.b, Expected.b, 1.0f / 255.0f);
+			EXPECT_NEAR(Actual.a, Expected.a, 1.0f / 255.0f);
+		}
+	}
+}
+
+TEST(BgDrawFile, BinaryRoundTrip)
+{
+	ExpectRoundTrip(false);
+}
+
+TEST(BgDrawFile, BinaryRoundTripCompressed)
+{
+	ExpectRoundTrip(true);
+}
+
+TEST(BgDrawFile, BinaryKeepsNewestItems)
+{
+	std::vector<unsigned char> vData;
+	BgDrawFile::WriteBinary(vData, TestItems(), true);
+	std::vector<CBgDrawItemData> vRead;
+	ASSERT_TRUE(BgDrawFile::ReadBinary(vData.data(), vData.size(), vRead, 1));
+	ASSERT_EQ(vRead.size(), 1u);
+	EXPECT_EQ(vRead[0].size(), 1u);
+}
+
+TEST(BgDrawFile, BinaryRejectsTruncated)
+{
+	std::vector<unsigned char> vData;
+	BgDrawFile::WriteBinary(vData, TestItems(), false);
+	vData.resize(vData.size() - 5);
+	std::vector<CBgDrawItemData> vRead;
+	EXPECT_FALSE(BgDrawFile::ReadBinary(vData.data(), vData.size(), vRead, 100));
+}
+
+TEST(BgDrawFile, TextIsNotBinary)
+{
+	const char *pText = "1.0,2.0,5.0,1.0,1.0,1.0,1.0\n,\n";
+	EXPECT_FALSE(BgDrawFile::IsBinary((const unsigned char *)pText, str_length(pText)));
+}
@@ -0,0 +1,174 @@
+#include "test.h"
+
+#include <base/system.h>
+
+#include <engine/engine.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/jobs.h>
+#include <engine/shared/network.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+
+#include <generated/protocol.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+class CSnapshotTickListener : public CDemoPlayer::IListener
+{
+public:
+	int m_LastTick = -1;
+	int m_NumSnapshots = 0;
+	std::vector<int> m_vMessageTicks;
+
+	void OnDemoPlayerSnapshot(void *pData, int Size) override
+	{
+		const CNetObj_Flag *pFlag = (const CNetObj_Flag *)((CSnapshot *)pData)->FindItem(NETOBJTYPE_FLAG, 0);
+		m_LastTick = pFlag ? pFlag->m_X : -1;
+		m_NumSnapshots++;
+	}
+
+	void OnDemoPlayerMessage(void *pData, int Size) override
+	{
+		if(Size == sizeof(int32_t))
+			m_vMessageTicks.push_back(*(const int32_t *)pData);
+	}
+};
+
+class Demo : public ::testing::Test
+{
+protected:
+	CTestInfo m_Info;
+	std::unique_ptr<IStorage> m_pStorage;
+	CSnapshotDelta m_SnapshotDelta;
+
+	void SetUp() override
+	{
+		CNetBase::Init();
+		m_Info.m_DeleteTestStorageFilesOnSuccess = true;
+		m_pStorage = m_Info.CreateTestStorage();
+		ASSERT_NE(m_pStorage, nullptr);
+	}
+
+	// the flag carries the tick for CSnapshotTickListener
+	int CreateSnapshot(int Tick, char *pData)
+	{
+		CSnapshotBuilder Builder;
+		Builder.Init();
+		CNetObj_Flag *pFlag = (CNetObj_Flag *)Builder.NewItem(NETOBJTYPE_FLAG, 0, sizeof(CNetObj_Flag));
+		EXPECT_NE(pFlag, nullptr);
+		if(pFlag)
+		{
+			pFlag->m_X = Tick;
+			pFlag->m_Y = Tick / 7;
+			pFlag->m_Team = 0;
+		}
+		return Builder.Finish(pData);
+	}
+};
+
+TEST_F(Demo, SeekPlaysWantedSnapshot)
+{
+	const char *pFilename = "test.demo";
+
+	const int NumTicks = 60 * SERVER_TICK_SPEED;
+	{
+		CDemoRecorder Recorder(&m_SnapshotDelta, true);
+		ASSERT_EQ(Recorder.Start(m_pStorage.get(), nullptr, pFilename, "0.6 626fce9a778df4d4", "coverage", SHA256_ZEROED, 0, "client", 0, nullptr, nullptr, nullptr, nullptr), 0);
+		for(int Tick = 1; Tick <= NumTicks; Tick++)
+		{
+			char aData[CSnapshot::MAX_SIZE];
+			Recorder.RecordSnapshot(Tick, aData, CreateSnapshot(Tick, aData));
+			const int32_t MessageTick = Tick;
+			Recorder.RecordMessage(&MessageTick, sizeof(MessageTick));
+		}
+		ASSERT_EQ(Recorder.Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+	}
+
+	// seeking must give the same result whether it starts from a key frame or a checkpoint
+	std::unique_ptr<IEngine> pEngine(CreateTestEngine("testrunner"));
+	CDemoPlayer Player(&m_SnapshotDelta, false);
+	CSnapshotTickListener Listener;
+	Player.SetListener(&Listener);
+	ASSERT_EQ(Player.Load(m_pStorage.get(), nullptr, pFilename, IStorage::TYPE_SAVE, pEngine.get()), 0);
+	std::shared_ptr<const IJob> pCheckpointJob = Player.CheckpointJob();
+	ASSERT_NE(pCheckpointJob, nullptr);
+	while(!pCheckpointJob->Done())
+		thread_yield();
+	Player.Play();
+
+	// without an engine there are no checkpoints
+	CDemoPlayer KeyFramePlayer(&m_SnapshotDelta, false);
+	CSnapshotTickListener KeyFrameListener;
+	KeyFramePlayer.SetListener(&KeyFrameListener);
+	ASSERT_EQ(KeyFramePlayer.Load(m_pStorage.get(), nullptr, pFilename, IStorage::TYPE_SAVE, nullptr), 0);
+	KeyFramePlayer.Play();
+
+	for(int i = 0; i < 500; i++)
+	{
+		const int WantedTick = 10 + (i * 7919) % (NumTicks - 10);
+		Listener.m_NumSnapshots = 0;
+		Listener.m_vMessageTicks.clear();
+		ASSERT_EQ(Player.SetPos(WantedTick), 0) << Player.ErrorMessage();
+		EXPECT_EQ(Player.Info()->m_Info.m_CurrentTick, WantedTick - 1);
+		EXPECT_EQ(Player.Info()->m_PreviousTick, WantedTick - 2);
+		EXPECT_EQ(Listener.m_LastTick, WantedTick - 1);
+		// only the snapshots of the last few ticks are passed on
+		EXPECT_LE(Listener.m_NumSnapshots, 5);
+
+		// all messages since the key frame are passed on
+		KeyFrameListener.m_vMessageTicks.clear();
+		ASSERT_EQ(KeyFramePlayer.SetPos(WantedTick), 0) << KeyFramePlayer.ErrorMessage();
+		EXPECT_EQ(Listener.m_vMessageTicks, KeyFrameListener.m_vMessageTicks);
+		ASSERT_FALSE(Listener.m_vMessageTicks.empty());
+		EXPECT_EQ(Listener.m_vMessageTicks.back(), WantedTick - 1);
+	}
+	EXPECT_GT(Player.NumCheckpoints(), 0);
+	EXPECT_EQ(KeyFramePlayer.NumCheckpoints(), 0);
+	Player.Stop();
+	KeyFramePlayer.Stop();
+}
+
+TEST_F(Demo, RingBufferIncludesTicksBeforeStart)
+{
+	const char *pFilename = "test_ring.demo";
+
+	const int MinTicks = 3 * SERVER_TICK_SPEED;
+	const int StartTick = 20 * SERVER_TICK_SPEED;
+	const int EndTick = StartTick + 4 * SERVER_TICK_SPEED;
+	CDemoRingBuffer RingBuffer(&m_SnapshotDelta);
+	CDemoRecorder Recorder(&m_SnapshotDelta, true);
+	for(int Tick = 1; Tick <= EndTick; Tick++)
+	{
+		char aData[CSnapshot::MAX_SIZE];
+		RingBuffer.RecordSnapshot(Tick, aData, CreateSnapshot(Tick, aData), MinTicks);
+		if(Tick == StartTick)
+		{
+			ASSERT_EQ(Recorder.Start(m_pStorage.get(), nullptr, pFilename, "0.6 626fce9a778df4d4", "coverage", SHA256_ZEROED, 0, "server", 0, nullptr, nullptr, nullptr, nullptr), 0);
+			EXPECT_LE(RingBuffer.FirstTick(), StartTick - MinTicks);
+			RingBuffer.Write(Recorder);
+		}
+		else if(Recorder.IsRecording())
+		{
+			RingBuffer.WriteLast(Recorder);
+		}
+	}
+	ASSERT_EQ(Recorder.Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+
+	std::unique_ptr<IEngine> pEngine(CreateTestEngine("testrunner"));
+	CDemoPlayer Player(&m_SnapshotDelta, false);
+	CSnapshotTickListener Listener;
+	Player.SetListener(&Listener);
+	ASSERT_EQ(Player.Load(m_pStorage.get(), nullptr, pFilename, IStorage::TYPE_SAVE, pEngine.get()), 0);
+	EXPECT_LE(Player.BaseInfo()->m_FirstTick, StartTick - MinTicks);
+	EXPECT_EQ(Player.BaseInfo()->m_LastTick, EndTick);
+	Player.Play();
+	for(int WantedTick = StartTick - MinTicks + 1; WantedTick <= EndTick; WantedTick += 13)
+	{
+		ASSERT_EQ(Player.SetPos(WantedTick), 0) << Player.ErrorMessage();
+		EXPECT_EQ(Listener.m_LastTick, WantedTick - 1);
+	}
+	Player.Stop();
+}
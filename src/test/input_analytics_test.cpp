@@ -0,0 +1,113 @@
+#include <base/log.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/protocol.h>
+
+#include <game/server/input_analytics.h>
+
+#include <generated/protocol.h>
+
+#include <gtest/gtest.h>
+
+static CNetObj_PlayerInput Input(bool Hook, int TargetX = 100, int TargetY = 0)
+{
+	CNetObj_PlayerInput Result = {};
+	Result.m_Hook = Hook;
+	Result.m_TargetX = TargetX;
+	Result.m_TargetY = TargetY;
+	return Result;
+}
+
+TEST(InputAnalytics, RegularHooks)
+{
+	CInputAnalytics Analytics;
+	CNetObj_PlayerInput Prev = Input(false);
+	// press the hook every 5 ticks for two seconds
+	for(int Tick = 1; Tick <= 2 * SERVER_TICK_SPEED; Tick++)
+	{
+		const CNetObj_PlayerInput Cur = Input(Tick % 5 == 0);
+		Analytics.Tick(Tick, Prev, Cur);
+		Prev = Cur;
+	}
+	EXPECT_EQ(Analytics.Count(CInputAnalytics::EVENT_HOOK), CInputAnalytics::WINDOW_TICKS / 5);
+	EXPECT_FLOAT_EQ(Analytics.Rate(CInputAnalytics::EVENT_HOOK), SERVER_TICK_SPEED / 5.0f);
+	EXPECT_FLOAT_EQ(Analytics.IntervalJitter(CInputAnalytics::EVENT_HOOK), 0.0f);
+	// all intervals are 5 ticks long
+	EXPECT_EQ(Analytics.Bursts(CInputAnalytics::EVENT_HOOK, 3), CInputAnalytics::WINDOW_TICKS / 5 - 1);
+	EXPECT_EQ(Analytics.Count(CInputAnalytics::EVENT_FIRE), 0);
+	EXPECT_FLOAT_EQ(Analytics.AimSpeed(), 0.0f);
+}
+
+TEST(InputAnalytics, WindowSlides)
+{
+	CInputAnalytics Analytics;
+	CNetObj_PlayerInput Prev = Input(false);
+	for(int Tick = 1; Tick <= SERVER_TICK_SPEED; Tick++)
+	{
+		const CNetObj_PlayerInput Cur = Input(Tick % 2 == 0, Tick % 2 == 0 ? 100 : -100, 0);
+		Analytics.Tick(Tick, Prev, Cur);
+		Prev = Cur;
+	}
+	EXPECT_EQ(Analytics.Count(CInputAnalytics::EVENT_HOOK), SERVER_TICK_SPEED / 2);
+	EXPECT_NEAR(Analytics.AimSpeed(), pi * (CInputAnalytics::WINDOW_TICKS - 1) / CInputAnalytics::WINDOW_TICKS, 0.01f);
+
+	// the presses leave the window one by one
+	for(int Tick = SERVER_TICK_SPEED + 1; Tick <= 2 * SERVER_TICK_SPEED; Tick++)
+	{
+		Analytics.Tick(Tick, Prev, Input(false));
+		Prev = Input(false);
+		EXPECT_EQ(Analytics.Count(CInputAnalytics::EVENT_HOOK), (2 * SERVER_TICK_SPEED + 1 - Tick) / 2);
+	}
+	EXPECT_FLOAT_EQ(Analytics.AimSpeed(), 0.0f);
+}
+
+TEST(InputAnalytics, Jitter)
+{
+	CInputAnalytics Analytics;
+	CNetObj_PlayerInput Prev = Input(false);
+	// intervals of 2 and 6 ticks alternating
+	int NextPress = 2;
+	bool Short = true;
+	for(int Tick = 1; Tick <= SERVER_TICK_SPEED; Tick++)
+	{
+		const bool Press = Tick == NextPress;
+		if(Press)
+		{
+			Short = !Short;
+			NextPress += Short ? 2 : 6;
+		}
+		const CNetObj_PlayerInput Cur = Input(Press);
+		Analytics.Tick(Tick, Prev, Cur);
+		Prev = Cur;
+	}
+	EXPECT_NEAR(Analytics.IntervalJitter(CInputAnalytics::EVENT_HOOK), 2.0f, 0.1f);
+	EXPECT_GT(Analytics.Bursts(CInputAnalytics::EVENT_HOOK, 1), 0);
+	EXPECT_GT(Analytics.Bursts(CInputAnalytics::EVENT_HOOK, 3), 0);
+}
+
+TEST(InputAnalytics, Benchmark)
+{
+	const int NumPlayers = 64;
+	const int NumTicks = 60 * SERVER_TICK_SPEED;
+	std::vector<CInputAnalytics> vAnalytics(NumPlayers);
+	std::vector<CNetObj_PlayerInput> vPrev(NumPlayers, Input(false));
+
+	const int64_t Start = time_get_nanoseconds().count();
+	for(int Tick = 1; Tick <= NumTicks; Tick++)
+	{
+		for(int i = 0; i < NumPlayers; i++)
+		{
+			CNetObj_PlayerInput Cur = Input((Tick + i) % 3 == 0, 100 + Tick % 50, i - Tick % 20);
+			Cur.m_Fire = (Tick / 2 + i) & INPUT_STATE_MASK;
+			Cur.m_Jump = (Tick + i) % 7 == 0;
+			vAnalytics[i].Tick(Tick, vPrev[i], Cur);
+			vPrev[i] = Cur;
+		}
+	}
+	const int64_t Duration = time_get_nanoseconds().count() - Start;
+	log_info("input_analytics", "updating %d players took %.1fns per player and tick on average",
+		NumPlayers, Duration / (double)NumPlayers / NumTicks);
+	for(const CInputAnalytics &Analytics : vAnalytics)
+		EXPECT_GT(Analytics.Count(CInputAnalytics::EVENT_HOOK), 0);
+}
@@ -0,0 +1,197 @@
+#include <test/test.h>
+
+#include <base/logger.h>
+#include <base/system.h>
+
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+
+#include <game/client/prediction/entities/character.h>
+#include <game/client/prediction/entities/projectile.h>
+#include <game/client/prediction/gameworld.h>
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/mapbugs.h>
+#include <game/mapitems.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+static const int NUM_PROJECTILES = 512;
+
+class CTestPrediction : public ::testing::Test
+{
+public:
+	CTestInfo m_TestInfo;
+	std::unique_ptr<IStorage> m_pStorage;
+	std::unique_ptr<IKernel> m_pKernel;
+	IEngineMap *m_pMap;
+	CLayers m_Layers;
+	CCollision m_Collision;
+	CTuningParams m_aTuningList[TuneZone::NUM];
+	CMapBugs m_MapBugs;
+	CGameWorld m_GameWorld;
+
+	CTestPrediction()
+	{
+		m_TestInfo.m_DeleteTestStorageFilesOnSuccess = true;
+		m_pStorage = m_TestInfo.CreateTestStorage();
+		EXPECT_NE(m_pStorage, nullptr);
+
+		m_pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+		m_pKernel->RegisterInterface(m_pStorage.get(), false);
+		m_pMap = CreateEngineMap();
+		m_pKernel->RegisterInterface(m_pMap);
+
+		EXPECT_TRUE(m_pMap->Load("maps/coverage.map"));
+		m_Layers.Init(m_pMap, false);
+		m_Collision.Init(&m_Layers);
+		m_MapBugs = CMapBugs::Create("coverage", m_pMap->MapSize(), m_pMap->Sha256());
+
+		m_GameWorld.Init(&m_Collision, m_aTuningList, &m_MapBugs);
+		m_GameWorld.m_WorldConfig.m_IsDDRace = true;
+		m_GameWorld.m_WorldConfig.m_PredictTiles = true;
+		m_GameWorld.m_WorldConfig.m_PredictWeapons = true;
+		m_GameWorld.m_WorldConfig.m_PredictDDRace = true;
+		m_GameWorld.m_WorldConfig.m_PredictFreeze = 1;
+	}
+
+	~CTestPrediction() override
+	{
+		m_GameWorld.Clear();
+		m_Collision.Unload();
+	}
+
+	// positions with two tiles of empty space around them, so that nothing collides during a tick
+	std::vector<vec2> FreePositions()
+	{
+		std::vector<vec2> vPositions;
+		for(int y = 2; y < m_Collision.GetHeight() - 2; y += 5)
+		{
+			for(int x = 2; x < m_Collision.GetWidth() - 2; x += 5)
+			{
+				bool Free = true;
+				for(int dy = -2; dy <= 2 && Free; dy++)
+				{
+					for(int dx = -2; dx <= 2 && Free; dx++)
+					{
+						const int Index = (y + dy) * m_Collision.GetWidth() + x + dx;
+						Free = m_Collision.GetTileIndex(Index) == TILE_AIR && m_Collision.GetFrontTileIndex(Index) == TILE_AIR;
+					}
+				}
+				if(Free)
+					vPositions.emplace_back(x * 32.0f + 16.0f, y * 32.0f + 16.0f);
+			}
+		}
+		return vPositions;
+	}
+
+	void Populate()
+	{
+		// characters and projectiles don't share positions, so the projectiles don't explode
+		std::vector<vec2> vPositions = FreePositions();
+		ASSERT_GE(vPositions.size(), 2u);
+		const size_t NumCharacterPositions = vPositions.size() / 2;
+		const size_t NumProjectilePositions = vPositions.size() - NumCharacterPositions;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			CNetObj_Character CharObj = {};
+			const vec2 Pos = vPositions[i % NumCharacterPositions];
+			CharObj.m_X = round_to_int(Pos.x);
+			CharObj.m_Y = round_to_int(Pos.y);
+			CharObj.m_Weapon = WEAPON_GUN;
+			CharObj.m_AmmoCount = 10;
+			CCharacter *pChar = new CCharacter(&m_GameWorld, i, &CharObj);
+			m_GameWorld.InsertEntity(pChar);
+		}
+		for(int i = 0; i < NUM_PROJECTILES; i++)
+		{
+			const vec2 Dir = direction(i * 2.0f * pi / NUM_PROJECTILES);
+			const vec2 Pos = vPositions[NumCharacterPositions + i % NumProjectilePositions];
+			new CProjectile(&m_GameWorld, WEAPON_GRENADE, i % MAX_CLIENTS, Pos, Dir, 10 * SERVER_TICK_SPEED, false, true, -1);
+		}
+	}
+
+	static std::set<CEntity *> Entities(CGameWorld *pWorld)
+	{
+		std::set<CEntity *> Result;
+		for(int Type = 0; Type < CGameWorld::NUM_ENTTYPES; Type++)
+			for(CEntity *pEnt = pWorld->FindFirst(Type); pEnt; pEnt = pEnt->TypeNext())
+				Result.insert(pEnt);
+		return Result;
+	}
+};
+
+TEST_F(CTestPrediction, CopyWorld)
+{
+	Populate();
+
+	CGameWorld Copy;
+	Copy.CopyWorld(&m_GameWorld);
+	EXPECT_TRUE(Copy.m_IsValidCopy);
+	for(int Type = 0; Type < CGameWorld::NUM_ENTTYPES; Type++)
+	{
+		CEntity *pFrom = m_GameWorld.FindFirst(Type);
+		CEntity *pTo = Copy.FindFirst(Type);
+		for(; pFrom && pTo; pFrom = pFrom->TypeNext(), pTo = pTo->TypeNext())
+		{
+			EXPECT_NE(pFrom, pTo);
+			EXPECT_EQ(pTo->GameWorld(), &Copy);
+			EXPECT_EQ(pTo->m_pParent, pFrom);
+			EXPECT_EQ(pFrom->m_pChild, pTo);
+			EXPECT_EQ(pTo->GetId(), pFrom->GetId());
+			EXPECT_EQ(pTo->m_Pos, pFrom->m_Pos);
+		}
+		EXPECT_EQ(pFrom, nullptr);
+		EXPECT_EQ(pTo, nullptr);
+	}
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		ASSERT_NE(Copy.GetCharacterById(i), nullptr);
+		EXPECT_EQ(Copy.GetCharacterById(i)->m_pParent, m_GameWorld.GetCharacterById(i));
+	}
+
+	// copying again reuses the entities of the previous copy
+	std::set<CEntity *> PrevEntities = Entities(&Copy);
+	EXPECT_EQ(PrevEntities.size(), MAX_CLIENTS + NUM_PROJECTILES);
+	Copy.CopyWorld(&m_GameWorld);
+	EXPECT_EQ(Entities(&Copy), PrevEntities);
+
+	// state changed by ticking the copy is overwritten by the next copy
+	for(int i = 0; i < 10; i++)
+		Copy.Tick();
+	Copy.CopyWorld(&m_GameWorld);
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		EXPECT_EQ(Copy.GetCharacterById(i)->m_Pos, m_GameWorld.GetCharacterById(i)->m_Pos);
+
+	// entities removed from the source are not kept alive in the copy
+	CCharacter *pRemoved = m_GameWorld.GetCharacterById(0);
+	m_GameWorld.RemoveEntity(pRemoved);
+	delete pRemoved;
+	Copy.CopyWorld(&m_GameWorld);
+	EXPECT_EQ(Copy.GetCharacterById(0), nullptr);
+	EXPECT_EQ(Entities(&Copy).size(), MAX_CLIENTS - 1 + NUM_PROJECTILES);
+}
+
+TEST_F(CTestPrediction, CopyWorldBenchmark)
+{
+	Populate();
+
+	const int Iterations = 200;
+	CGameWorld PredictedWorld;
+	const int64_t Start = time_get_nanoseconds().count();
+	for(int i = 0; i < Iterations; i++)
+	{
+		PredictedWorld.CopyWorld(&m_GameWorld);
+		PredictedWorld.Tick();
+	}
+	const int64_t Duration = time_get_nanoseconds().count() - Start;
+	log_info("prediction", "copying and ticking %d characters and %d projectiles took %.3fus on average",
+		MAX_CLIENTS, NUM_PROJECTILES, Duration / 1000.0 / Iterations);
+	// nothing was destroyed during the tick, so every copy could reuse all entities
+	EXPECT_EQ(Entities(&PredictedWorld).size(), (size_t)MAX_CLIENTS + NUM_PROJECTILES);
+}